@@ -0,0 +1,98 @@
+#ifndef APP_GROUPS_H
+#define APP_GROUPS_H
+
+#include <vector>
+#include <string>
+#include <array>
+#include <unordered_map>
+#include <chrono>
+#include "system_info.h"
+
+// Finds which of many substrings occur in a text in one pass (Aho-Corasick).
+// Patterns are compiled once into a full transition table, so matching costs
+// one table lookup per byte however many patterns there are.
+class PatternMatcher {
+public:
+    PatternMatcher() { clear(); }
+
+    void clear();
+    void add(const std::string& pattern, int id);
+    // Compile the added patterns; call before match()
+    void build();
+    bool empty() const { return pattern_count == 0; }
+
+    // Smallest id of the patterns occurring in the text, or -1
+    int match(const char* text, size_t length) const;
+
+private:
+    struct State {
+        std::array<int, 256> next;
+        int fail = 0;
+        int best = -1;      // Smallest id ending here, including via fail links
+    };
+    std::vector<State> states;
+    size_t pattern_count = 0;
+};
+
+// An application group from --group: processes whose name or command line
+// contains one of the patterns
+struct AppGroupRule {
+    std::string name;
+    std::vector<std::string> comm_patterns;
+    std::vector<std::string> cmdline_patterns;   // Written "cmd:TEXT"
+};
+
+// Aggregated metrics of one group
+struct AppGroupStats {
+    std::string name;
+    bool configured = false;    // From --group, rather than one process name
+    int processes = 0;
+    float cpu_percent = 0.0f;
+    float mem_percent = 0.0f;
+    unsigned long rss_kb = 0;
+    double read_bytes_per_s = 0.0;
+    double write_bytes_per_s = 0.0;
+};
+
+// Sorts processes into application groups and sums their metrics. The
+// group of each process is decided once per (PID, start time) and cached;
+// processes matching no group are grouped by their name.
+class AppGrouper {
+public:
+    // Parse "NAME=PATTERN|cmd:PATTERN|..."; false with a message on error
+    static bool parse(const std::string& spec, std::vector<AppGroupRule>& rules, std::string& error);
+
+    void configure(const std::vector<AppGroupRule>& rules);
+
+    // Regroup a fresh process table
+    void update(const std::vector<Process>& processes);
+
+    // Measure I/O rates afresh at the next update (the counters were not kept up to date)
+    void restartRates() { have_previous = false; }
+
+    const std::vector<AppGroupStats>& groups() const { return current; }
+    size_t cachedProcesses() const { return members.size(); }
+    size_t lastClassified() const { return classified; }
+
+private:
+    struct Member {
+        unsigned long long start_time;
+        int group;                        // Index of a configured group, -1 for none
+        unsigned long long read_bytes;    // I/O counters at the previous update
+        unsigned long long write_bytes;
+        bool seen;
+    };
+
+    std::vector<std::string> group_names;
+    PatternMatcher comm_matcher;
+    PatternMatcher cmdline_matcher;
+    std::unordered_map<int, Member> members;
+    std::vector<AppGroupStats> current;
+    size_t classified = 0;                // Cache misses in the last update
+    std::chrono::steady_clock::time_point last_update;
+    bool have_previous = false;
+
+    int classify(const Process& proc) const;
+};
+
+#endif // APP_GROUPS_H
@@ -0,0 +1,111 @@
+#ifndef ASRMT_H
+#define ASRMT_H
+
+/*
+ * libasrmt: the activity monitor's collection core as a C library.
+ *
+ *     asrmt_sampler* sampler = asrmt_sampler_create();
+ *     asrmt_snapshot* snap = asrmt_snapshot_take(sampler);
+ *     for (size_t i = 0; i < asrmt_snapshot_process_count(snap); i++) {
+ *         asrmt_process proc;
+ *         asrmt_snapshot_process(snap, i, &proc);
+ *         printf("%d %s %lu\n", proc.pid, proc.name, proc.rss_kb);
+ *     }
+ *     asrmt_snapshot_free(snap);
+ *     asrmt_sampler_destroy(sampler);
+ *
+ * A sampler keeps the state needed for rates between snapshots (CPU times);
+ * use each sampler from one thread at a time. Snapshots are independent
+ * copies: they stay valid after the sampler is destroyed, and strings they
+ * return live until the snapshot is freed. The structs below are fixed for
+ * ASRMT_API_VERSION 1; later versions add functions rather than fields.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ASRMT_API_VERSION 1
+
+#if defined(__GNUC__)
+#define ASRMT_API __attribute__((visibility("default")))
+#else
+#define ASRMT_API
+#endif
+
+typedef struct asrmt_sampler asrmt_sampler;
+typedef struct asrmt_snapshot asrmt_snapshot;
+
+typedef struct asrmt_cpu {
+    double total_percent;      /* Since the previous snapshot (or sampler creation) */
+    int num_cores;
+} asrmt_cpu;
+
+typedef struct asrmt_memory {
+    unsigned long total_kb;
+    unsigned long free_kb;
+    unsigned long available_kb;
+    unsigned long used_kb;     /* total - available */
+    unsigned long cached_kb;
+    unsigned long buffers_kb;
+    unsigned long swap_total_kb;
+    unsigned long swap_used_kb;
+    double percent_used;
+    double swap_percent_used;
+} asrmt_memory;
+
+typedef struct asrmt_disk {
+    const char* device;
+    const char* mount_point;
+    unsigned long total_kb;
+    unsigned long used_kb;
+    unsigned long free_kb;
+    double percent_used;
+} asrmt_disk;
+
+typedef struct asrmt_process {
+    int pid;
+    const char* name;
+    double cpu_percent;
+    double mem_percent;
+    unsigned long rss_kb;
+    unsigned long long start_time;      /* Clock ticks since boot; tells reused PIDs apart */
+    unsigned long long io_read_bytes;   /* 0 if /proc/[pid]/io is not readable */
+    unsigned long long io_write_bytes;
+} asrmt_process;
+
+/* ASRMT_API_VERSION of the library actually loaded */
+ASRMT_API int asrmt_api_version(void);
+
+/* NULL if /proc cannot be read */
+ASRMT_API asrmt_sampler* asrmt_sampler_create(void);
+ASRMT_API void asrmt_sampler_destroy(asrmt_sampler* sampler);
+
+/* Why the last call on this sampler failed ("" if it did not) */
+ASRMT_API const char* asrmt_sampler_error(const asrmt_sampler* sampler);
+
+/* Read everything once; NULL on failure (see asrmt_sampler_error) */
+ASRMT_API asrmt_snapshot* asrmt_snapshot_take(asrmt_sampler* sampler);
+ASRMT_API void asrmt_snapshot_free(asrmt_snapshot* snapshot);
+
+/* Seconds since the epoch when the snapshot was taken */
+ASRMT_API long long asrmt_snapshot_time(const asrmt_snapshot* snapshot);
+
+ASRMT_API void asrmt_snapshot_cpu(const asrmt_snapshot* snapshot, asrmt_cpu* out);
+/* Usage of one core, or -1 if there is no such core */
+ASRMT_API double asrmt_snapshot_core_percent(const asrmt_snapshot* snapshot, int core);
+ASRMT_API void asrmt_snapshot_memory(const asrmt_snapshot* snapshot, asrmt_memory* out);
+
+/* Indexed access; these return 0 on success and -1 if index is out of range */
+ASRMT_API size_t asrmt_snapshot_disk_count(const asrmt_snapshot* snapshot);
+ASRMT_API int asrmt_snapshot_disk(const asrmt_snapshot* snapshot, size_t index, asrmt_disk* out);
+ASRMT_API size_t asrmt_snapshot_process_count(const asrmt_snapshot* snapshot);
+ASRMT_API int asrmt_snapshot_process(const asrmt_snapshot* snapshot, size_t index, asrmt_process* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASRMT_H */
@@ -0,0 +1,157 @@
+#ifndef COLLECTOR_H
+#define COLLECTOR_H
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <type_traits>
+#include <unistd.h>
+#include "system_info.h"
+#include "metric_features.h"
+
+typedef std::function<void(const std::string&)> CollectorLogger;
+
+// The /proc readers behind the collectors. Each fills its output and keeps
+// no state of its own; the logger (if set) receives per-collector detail.
+void readCPUInfo(CPUInfo& cpu_info, std::vector<CPUTimeInfo>& prev_cpu_times,
+                 std::vector<CPUTimeInfo>& curr_cpu_times);
+void bootCPUBaseline(std::vector<CPUTimeInfo>& curr_cpu_times);
+void readMemoryInfo(MemoryInfo& memory_info);
+void readDiskInfo(std::vector<DiskInfo>& disk_info);
+void readProcessInfo(std::vector<Process>& process_list, int num_cores, unsigned long total_memory,
+                     bool detail, const CollectorLogger& logger);
+void readMemoryStats(MemoryInfo& memory_info, const CollectorLogger& logger);
+void readDiskLatency(std::vector<DiskInfo>& disk_info, const CollectorLogger& logger);
+
+// AnonHugePages of one process from /proc/[pid]/smaps_rollup, in KB (0 if
+// unreadable). The kernel walks every mapping for this, so it is only meant
+// for a handful of processes.
+unsigned long readAnonHugePages(int pid);
+
+// Per-group storage of the collector; the disabled specialisations are empty
+// bases, so a compiled-out group takes no space in the collector
+template <bool Enabled> struct CpuState {};
+template <> struct CpuState<true> {
+    CPUInfo cpu_info = CPUInfo();
+    std::vector<CPUTimeInfo> prev_cpu_times;   // For calculating CPU usage
+    std::vector<CPUTimeInfo> curr_cpu_times;
+};
+
+template <bool Enabled> struct MemoryState {};
+template <> struct MemoryState<true> {
+    MemoryInfo memory_info = MemoryInfo();
+};
+
+template <bool Enabled> struct DiskState {};
+template <> struct DiskState<true> {
+    std::vector<DiskInfo> disk_info;
+};
+
+template <bool Enabled> struct ProcessState {};
+template <> struct ProcessState<true> {
+    std::vector<Process> process_list;
+};
+
+// Reads CPU, memory, disk and process information from /proc. This is the
+// collection core shared by the monitor, the daemon and the libasrmt C API;
+// it has no terminal dependencies. CPU percentages are computed against the
+// previous update, so the first one only establishes a baseline.
+//
+// Features selects the metric groups at compile time. Collectors of groups
+// left out are no-ops that the compiler removes, and their accessors return
+// an empty value, so callers compile unchanged against any feature set.
+template <unsigned Features>
+class BasicCollector : private CpuState<hasFeature(Features, FEATURE_CPU)>,
+                       private MemoryState<hasFeature(Features, FEATURE_MEMORY)>,
+                       private DiskState<hasFeature(Features, FEATURE_DISKS)>,
+                       private ProcessState<hasFeature(Features, FEATURE_PROCESSES)> {
+public:
+    static constexpr bool has(unsigned feature) { return hasFeature(Features, feature); }
+
+    // Run every collector once; throws std::runtime_error if /proc is unreadable.
+    // Without scan_processes the process table of the last scan is kept.
+    void collect(bool scan_processes = true) {
+        updateCPUInfo();
+        updateMemoryInfo();
+        updateDiskInfo();
+        if (scan_processes) {
+            updateProcessInfo();
+        }
+        updateMemoryStats();
+        updateDiskLatency();
+    }
+
+    // Individual collectors, in the order collect() runs them
+    void updateCPUInfo() { updateCPU(Has<FEATURE_CPU>()); }
+    void updateMemoryInfo() { updateMemory(Has<FEATURE_MEMORY>()); }
+    void updateDiskInfo() { updateDisks(Has<FEATURE_DISKS>()); }
+    void updateProcessInfo() { updateProcesses(Has<FEATURE_PROCESSES>()); }  // Uses the last CPU and memory updates
+    void updateMemoryStats() { updateMemoryDetail(Has<FEATURE_MEMORY>()); }
+    void updateDiskLatency() { updateDiskDetail(Has<FEATURE_DISKS>()); }
+
+    // Make the next updateCPUInfo() report usage averaged since boot
+    void useBootBaseline() { bootBaseline(Has<FEATURE_CPU>()); }
+
+    const CPUInfo& cpu() const { return cpuInfo(Has<FEATURE_CPU>()); }
+    const MemoryInfo& memory() const { return memoryInfo(Has<FEATURE_MEMORY>()); }
+    const std::vector<DiskInfo>& disks() const { return diskInfo(Has<FEATURE_DISKS>()); }
+    const std::vector<Process>& processes() const { return processList(Has<FEATURE_PROCESSES>()); }
+
+    // Copy the last collected data, stamped with the current time
+    void snapshot(Snapshot& out) const {
+        out.taken_at = time(nullptr);
+        out.cpu = cpu();
+        out.memory = memory();
+        out.disks = disks();
+        out.processes = processes();
+    }
+
+    // Receives per-collector detail; unset means no detail is formatted
+    void setLogger(CollectorLogger log) { logger = log; }
+
+    // Read the tier-2 process fields (/proc/[pid]/io and schedstat). While
+    // off, each process keeps the counters of its last detailed scan.
+    void setProcessDetail(bool on) { process_detail = on; }
+
+private:
+    template <unsigned Feature>
+    using Has = std::integral_constant<bool, hasFeature(Features, Feature)>;
+
+    CollectorLogger logger;
+    bool process_detail = true;
+
+    void updateCPU(std::true_type) { readCPUInfo(this->cpu_info, this->prev_cpu_times, this->curr_cpu_times); }
+    void updateCPU(std::false_type) {}
+    void bootBaseline(std::true_type) { bootCPUBaseline(this->curr_cpu_times); }
+    void bootBaseline(std::false_type) {}
+    void updateMemory(std::true_type) { readMemoryInfo(this->memory_info); }
+    void updateMemory(std::false_type) {}
+    void updateMemoryDetail(std::true_type) { readMemoryStats(this->memory_info, logger); }
+    void updateMemoryDetail(std::false_type) {}
+    void updateDisks(std::true_type) { readDiskInfo(this->disk_info); }
+    void updateDisks(std::false_type) {}
+    void updateDiskDetail(std::true_type) { readDiskLatency(this->disk_info, logger); }
+    void updateDiskDetail(std::false_type) {}
+
+    // Without the CPU group the per-process share uses the online core count
+    void updateProcesses(std::true_type) {
+        int cores = has(FEATURE_CPU) ? cpu().num_cores : static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+        readProcessInfo(this->process_list, cores, memory().total, process_detail, logger);
+    }
+    void updateProcesses(std::false_type) {}
+
+    const CPUInfo& cpuInfo(std::true_type) const { return this->cpu_info; }
+    const MemoryInfo& memoryInfo(std::true_type) const { return this->memory_info; }
+    const std::vector<DiskInfo>& diskInfo(std::true_type) const { return this->disk_info; }
+    const std::vector<Process>& processList(std::true_type) const { return this->process_list; }
+
+    const CPUInfo& cpuInfo(std::false_type) const { static const CPUInfo none = CPUInfo(); return none; }
+    const MemoryInfo& memoryInfo(std::false_type) const { static const MemoryInfo none = MemoryInfo(); return none; }
+    const std::vector<DiskInfo>& diskInfo(std::false_type) const { static const std::vector<DiskInfo> none; return none; }
+    const std::vector<Process>& processList(std::false_type) const { static const std::vector<Process> none; return none; }
+};
+
+// The full collector used by the TUI and libasrmt
+typedef BasicCollector<FEATURE_ALL> SystemCollector;
+
+#endif // COLLECTOR_H
@@ -0,0 +1,75 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <string>
+#include <chrono>
+#include "collector.h"
+#include "history.h"
+#include "kernel_log.h"
+#include "flight_recorder.h"
+#include "process_log.h"
+#include "tick_watchdog.h"
+#include "overhead_budget.h"
+
+// Configuration of the headless activity_monitord
+struct DaemonConfig {
+    int refresh_rate_ms = 1000;  // Collection interval in milliseconds
+    float cpu_threshold = 80.0f; // CPU threshold for alerts (%)
+    double cpu_budget_percent = 0.0; // Own CPU use allowed, % of one core (0 = no budget)
+    bool kernel_log = true;      // Watch /dev/kmsg for OOM kills, I/O errors, lockups, ...
+    bool desktop_notifications = false; // Also send alerts to notify-send
+    std::string flight_dir;      // Flight recorder dumps go here on alerts (empty = off)
+    int flight_max_per_hour = 4; // Cap on flight recorder dumps
+    int history_size = 300;      // Snapshots kept for flight recorder dumps
+    std::string process_log_path; // Record every process seen to this log (empty = off)
+    int bench_seconds = 0;       // Exit after this long and print resource usage (0 = off)
+};
+
+// The daemon's collector has only the metric groups of this build (make FEATURES=...)
+typedef BasicCollector<BUILD_FEATURES> DaemonCollector;
+
+// The collectors, alert rules and sinks of the monitor without any display
+// code. Alerts are written as log lines to stdout (for journald or a log
+// file), and optionally to the desktop notifier and the flight recorder.
+// Between refreshes the daemon sleeps in poll() on the kernel log, so it
+// wakes only to collect or to handle a kernel event.
+class MonitorDaemon {
+public:
+    MonitorDaemon();
+
+    void setConfig(const DaemonConfig& new_config);
+
+    // Run until SIGINT/SIGTERM or the --bench duration
+    void run();
+
+    // Startup time, resident memory, CPU use, refresh overruns and budget of this process
+    std::string resourceReport() const;
+
+private:
+    DaemonConfig config;
+    DaemonCollector collector;
+    SnapshotHistory history;
+    KernelLogTap kernel_log;
+    FlightRecorder flight_recorder;
+    ProcessLog process_log;
+    TickWatchdog watchdog;         // Sheds load while collections overrun the refresh interval
+    OverheadBudget overhead;       // Keeps the daemon's own CPU use under --cpu-budget
+
+    bool warning_state = false;
+    bool pre_warning_state = false;
+    std::chrono::steady_clock::time_point last_notification;
+    time_t kernel_notified_at[KEV_TYPE_COUNT] = {}; // Desktop notification throttling
+    std::chrono::steady_clock::time_point started;
+    double first_collection_ms = 0.0;   // Since the process was started
+
+    void collect();
+    void checkCpuAlerts();
+    void pollKernelLog();
+    void alert(const std::string& level, const std::string& title, const std::string& message,
+               bool critical, int pid);
+    void log(const std::string& level, const std::string& message);
+    const Process* topCpuProcess() const;
+    std::string monitorState() const;
+};
+
+#endif // DAEMON_H
@@ -0,0 +1,107 @@
+#ifndef DELAY_ACCOUNTING_H
+#define DELAY_ACCOUNTING_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <chrono>
+#include <cstdint>
+
+struct mmsghdr;
+
+// Share of wall time a process spent waiting, from taskstats delay accounting.
+// Summed over threads, so a busy multi-threaded process can exceed 100%.
+struct DelaySample {
+    double cpu_percent = 0.0;      // Runnable but waiting for a CPU
+    double blkio_percent = 0.0;    // Waiting for block I/O
+    double swapin_percent = 0.0;   // Waiting for pages to be swapped in
+    double reclaim_percent = 0.0;  // Direct reclaim, thrashing and compaction
+    bool valid = false;            // False until measured over one interval
+};
+
+// Processes that exited during the last update, from the exit notifications
+struct DelayExitSummary {
+    size_t processes = 0;
+    double cpu_ms = 0.0;           // Lifetime delays, summed over the processes
+    double blkio_ms = 0.0;
+    double swapin_ms = 0.0;
+    double reclaim_ms = 0.0;
+    std::string worst_name;        // Longest total delay among them
+    int worst_pid = -1;
+    double worst_ms = 0.0;
+    size_t lost = 0;               // Notifications dropped by the kernel (socket full)
+};
+
+// Netlink TASKSTATS client. Per-process queries go out in batches: up to
+// BATCH requests share one send(), and the kernel answers them before
+// send() returns, so one recvmmsg() collects the replies. A second socket
+// is registered for the exit notifications of a CPU mask. Needs
+// CAP_NET_ADMIN; without delay accounting enabled in the kernel
+// (kernel.task_delayacct) every delay reads as zero.
+class DelayAccounting {
+public:
+    static const size_t BATCH = 32;   // Requests per send()
+
+    DelayAccounting() {}
+    ~DelayAccounting();
+
+    // Resolve the TASKSTATS family and subscribe to the exits on 'exit_cpus'
+    // (a CPU list such as "0-3,8", empty for all); false (with a reason) if
+    // the queries cannot be used. A failed subscription only disables exits.
+    bool probe(const std::string& exit_cpus);
+    bool available() const { return query_fd >= 0; }
+    const std::string& unavailableReason() const { return reason; }
+    bool exitsSubscribed() const { return exit_fd >= 0; }
+    bool kernelAccountingOff() const { return accounting_off; }
+
+    // Query exactly these processes from now on
+    void track(const std::vector<int>& pids);
+
+    // Query the tracked processes and read the exit notifications
+    void update();
+
+    // Latest sample for a tracked process, or nullptr
+    const DelaySample* sample(int pid) const;
+
+    const DelayExitSummary& exits() const { return exit_summary; }
+
+    // send() and recvmmsg() calls of the last update
+    size_t syscallsLastUpdate() const { return syscalls; }
+
+private:
+    struct Totals {
+        uint64_t cpu = 0;
+        uint64_t blkio = 0;
+        uint64_t swapin = 0;
+        uint64_t reclaim = 0;
+    };
+
+    struct TrackedProcess {
+        Totals last;
+        std::chrono::steady_clock::time_point last_time;
+        bool have_last = false;
+        DelaySample current;
+    };
+
+    int query_fd = -1;
+    int exit_fd = -1;
+    uint16_t family = 0;
+    uint32_t seq = 0;
+    bool probed = false;
+    bool accounting_off = false;
+    std::string reason;
+    std::string exit_mask;
+
+    std::map<int, TrackedProcess> tracked;
+    DelayExitSummary exit_summary;
+    size_t syscalls = 0;
+    std::vector<char> receive_buffer;  // BATCH datagram slots for recvmmsg()
+
+    void queryBatch(const std::vector<int>& pids, size_t begin, size_t end,
+                    std::chrono::steady_clock::time_point now);
+    int receive(int fd, struct mmsghdr* messages, size_t slots);
+    void readExits();
+    bool subscribeExits(const std::string& cpus);
+};
+
+#endif // DELAY_ACCOUNTING_H
@@ -0,0 +1,110 @@
+#ifndef DISK_USAGE_H
+#define DISK_USAGE_H
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <set>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <sys/types.h>
+
+// One row of a directory listing in the analyzer
+struct DiskUsageEntry {
+    std::string name;        // Directory name, or "" for the files directly inside
+    uint64_t bytes = 0;      // Allocated bytes below (st_blocks * 512)
+    uint64_t files = 0;      // Regular files below
+    bool complete = false;   // Whole subtree has been scanned
+    bool is_dir = true;
+};
+
+// Parallel du for one filesystem. Worker threads walk directories with
+// getdents64 and fstatat(AT_NO_AUTOMOUNT), each taking work from its own
+// deque and stealing from the others when it runs dry. Directory sizes are
+// added to all ancestors as soon as they are known, so the tree can be
+// browsed while the scan runs. A rescan reuses the file totals of every
+// directory whose mtime has not changed instead of listing it again.
+class DiskUsageScanner {
+public:
+    DiskUsageScanner() {}
+    ~DiskUsageScanner();
+
+    // Scan 'root'; 'incremental' reuses unchanged directories of the previous scan
+    bool start(const std::string& root, bool incremental);
+    void stop();
+    bool active() const { return workers_running.load() > 0; }
+    const std::string& root() const { return scan_root; }
+
+    // Directory at 'path' (names below the root): its own totals and its children,
+    // largest first, with the files directly inside as one extra entry
+    bool list(const std::vector<std::string>& path, DiskUsageEntry& self,
+              std::vector<DiskUsageEntry>& children) const;
+
+    struct Stats {
+        uint64_t directories = 0;   // Directories listed
+        uint64_t reused = 0;        // Directories skipped because their mtime was unchanged
+        uint64_t files = 0;         // Regular files counted
+        uint64_t errors = 0;        // Directories that could not be opened
+        uint64_t steals = 0;        // Directories taken from another worker's queue
+        double seconds = 0.0;       // Elapsed (or total, once finished)
+        int threads = 0;
+    };
+    Stats stats() const;
+
+private:
+    struct Node {
+        std::string name;
+        Node* parent = nullptr;
+        const Node* previous = nullptr;      // Same directory in the previous scan
+        std::vector<std::unique_ptr<Node>> children;  // Guarded by tree_lock
+        std::atomic<uint64_t> bytes{0};      // Subtree total, grows during the scan
+        std::atomic<uint64_t> files{0};
+        std::atomic<int> pending{1};         // This directory plus unfinished subdirectories
+        std::atomic<uint64_t> own_bytes{0};  // Files directly inside (for reuse by rescans)
+        std::atomic<uint64_t> own_files{0};
+        int64_t mtime_ns = 0;                // Set before any child is queued
+    };
+
+    // Per-worker deque: the owner pushes and pops at the back, thieves take from the front
+    struct WorkQueue {
+        std::mutex lock;
+        std::deque<Node*> items;
+    };
+
+    std::string scan_root;
+    dev_t root_dev = 0;
+    std::unique_ptr<Node> tree;
+    std::unique_ptr<Node> previous_tree;
+    mutable std::mutex tree_lock;
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::atomic<int> workers_running{0};
+    std::atomic<long> outstanding{0};        // Directories queued or being scanned
+    std::atomic<bool> stop_requested{false};
+
+    // Hard links are counted once
+    std::mutex inode_lock;
+    std::set<ino_t> linked_inodes;
+
+    std::atomic<uint64_t> stat_directories{0};
+    std::atomic<uint64_t> stat_reused{0};
+    std::atomic<uint64_t> stat_files{0};
+    std::atomic<uint64_t> stat_errors{0};
+    std::atomic<uint64_t> stat_steals{0};
+    std::chrono::steady_clock::time_point started;
+    std::atomic<double> finished_seconds{0.0};
+
+    void workerLoop(size_t index);
+    Node* takeWork(size_t index);
+    void scanDirectory(size_t index, Node* node);
+    void finishDirectory(Node* node);
+    std::string pathOf(const Node* node) const;
+    static void fillEntry(const Node* node, DiskUsageEntry& entry);
+};
+
+#endif // DISK_USAGE_H
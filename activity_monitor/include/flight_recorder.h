@@ -0,0 +1,73 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <ctime>
+#include "history.h"
+
+// Writes the snapshot history to disk when an alert fires, together with a
+// one-time deep capture of the offending processes (status, smaps_rollup,
+// stack, wchan, open files, cgroup). The caller hands over a copy of the
+// history ring; decoding, /proc reads and file writes all happen on a
+// background thread at idle I/O priority, so the monitor loop never waits
+// on disk. One dump runs at a time and dumps per hour are capped.
+class FlightRecorder {
+public:
+    FlightRecorder() {}
+    ~FlightRecorder();
+
+    // Dumps go below 'dir'; an empty dir disables the recorder
+    void configure(const std::string& dir, int max_per_hour);
+    bool enabled() const { return !output_dir.empty(); }
+
+    // The top CPU and memory users, plus 'pid' (if > 0) first
+    static std::vector<int> capturePids(const std::vector<Process>& processes, int pid);
+
+    // Queue a dump; false if one is still being written or the hourly cap is reached.
+    // 'monitor_state' (the monitor's own overhead and settings) goes into reason.txt.
+    bool trigger(const std::string& reason, const SnapshotHistory& history, const std::vector<int>& pids,
+                 const std::string& monitor_state = "");
+
+    struct Stats {
+        int written = 0;           // Dumps completed
+        int skipped_busy = 0;      // Alerts while a dump was being written
+        int skipped_capped = 0;    // Alerts over the hourly cap
+        std::string last_path;     // Directory of the latest complete dump
+        std::string last_error;
+    };
+    Stats stats() const;
+
+private:
+    struct Job {
+        std::string reason;
+        std::string monitor_state;
+        time_t triggered_at;
+        std::unique_ptr<SnapshotHistory> history;
+        std::vector<int> pids;
+    };
+
+    std::string output_dir;
+    int dumps_per_hour = 4;
+    std::deque<time_t> recent_dumps;     // Trigger times within the last hour
+
+    std::thread worker;
+    mutable std::mutex lock;             // Guards the job and stats
+    std::condition_variable wake;
+    std::unique_ptr<Job> pending;
+    bool writing = false;
+    bool stop_requested = false;
+    Stats current;
+
+    void workerLoop();
+    bool writeDump(const Job& job, std::string& path, std::string& error);
+    static void writeTimeline(const SnapshotHistory& history, const std::string& dir);
+    static void captureProcess(int pid, const std::string& dir);
+};
+
+#endif // FLIGHT_RECORDER_H
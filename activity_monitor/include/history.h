@@ -0,0 +1,89 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <ctime>
+#include "system_info.h"
+
+// Fixed-capacity ring of past snapshots used for pausing and scrubbing.
+// Strings (process names, devices, mount points) are interned so a stored
+// process is a fixed-size row instead of a full Process with its std::string.
+class SnapshotHistory {
+public:
+    explicit SnapshotHistory(size_t capacity = 300);
+
+    // Change the number of retained snapshots (drops the history)
+    void setCapacity(size_t capacity);
+
+    // Store a new snapshot, overwriting the oldest one when full
+    void push(const CPUInfo& cpu, const MemoryInfo& memory,
+              const std::vector<DiskInfo>& disks, const std::vector<Process>& procs);
+
+    // Decode snapshot 'seq' into the given structures; processes come back sorted by PID
+    bool load(uint64_t seq, CPUInfo& cpu, MemoryInfo& memory,
+              std::vector<DiskInfo>& disks, std::vector<Process>& procs) const;
+    bool load(uint64_t seq, Snapshot& snapshot) const;
+
+    // Sequence numbers of the stored range (valid only when !empty())
+    uint64_t oldestSeq() const { return next_seq - count; }
+    uint64_t newestSeq() const { return next_seq - 1; }
+    bool contains(uint64_t seq) const { return count > 0 && seq >= oldestSeq() && seq <= newestSeq(); }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    size_t capacity() const { return slots.size(); }
+
+    // Wall-clock time a snapshot was taken
+    time_t timestamp(uint64_t seq) const;
+
+    // Approximate heap usage of the stored snapshots (bytes)
+    size_t memoryUsage() const;
+
+private:
+    struct CompactProcess {
+        int32_t pid;
+        uint32_t name_id;
+        float cpu_percent;
+        float mem_percent;
+        uint32_t rss_kb;
+        uint64_t start_time;
+        uint64_t io_read_bytes;
+        uint64_t io_write_bytes;
+    };
+
+    struct CompactDisk {
+        uint32_t device_id;
+        uint32_t mount_id;
+        unsigned long total_space;
+        unsigned long free_space;
+        float read_latency_ms;
+        unsigned long io_operations;
+    };
+
+    struct CompactSnapshot {
+        time_t taken_at;
+        float total_usage;
+        std::vector<float> core_usage;
+        MemoryInfo memory;
+        std::vector<CompactDisk> disks;
+        std::vector<CompactProcess> processes;  // Sorted by PID
+    };
+
+    // Slots are reused in place so steady-state pushes do not allocate
+    std::vector<CompactSnapshot> slots;
+    size_t count = 0;
+    uint64_t next_seq = 0;
+
+    // Interned string table shared by all snapshots
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, uint32_t> string_ids;
+
+    uint32_t intern(const std::string& s);
+    void compactStrings();
+    const CompactSnapshot& slot(uint64_t seq) const { return slots[seq % slots.size()]; }
+};
+
+#endif // HISTORY_H
@@ -0,0 +1,89 @@
+#ifndef KERNEL_LOG_H
+#define KERNEL_LOG_H
+
+#include <cstdint>
+#include <cstddef>
+#include <ctime>
+#include <string>
+
+// Kinds of kernel log records we recognise
+enum KernelEventType {
+    KEV_OOM_KILL,       // OOM killer (global or cgroup) killed a process
+    KEV_HUNG_TASK,      // Task stuck in D state past hung_task_timeout
+    KEV_LOCKUP,         // Soft or hard lockup detected by the watchdog
+    KEV_RCU_STALL,      // RCU grace period stall
+    KEV_IO_ERROR,       // Block layer or buffer I/O error
+    KEV_FS_ERROR,       // Filesystem reported corruption or an error
+    KEV_FS_READONLY,    // Filesystem remounted read-only after an error
+    KEV_SEGFAULT,       // User process crashed
+    KEV_MACHINE_CHECK,  // Hardware error
+    KEV_TYPE_COUNT
+};
+
+// A classified kernel log record; fixed size so the tap never allocates
+struct KernelEvent {
+    KernelEventType type;
+    int level;              // Syslog level (0 = emerg ... 7 = debug)
+    uint64_t seq;           // Kernel log sequence number
+    uint64_t timestamp_us;  // Microseconds since boot
+    time_t wall_time;       // Approximate wall-clock time of the record
+    bool historical;        // Logged before the monitor started
+    int pid;                // Affected process, or -1
+    char subject[64];       // Process name or block device ("" if none)
+    char message[192];      // Record text (truncated)
+};
+
+// Non-blocking reader of /dev/kmsg. Each poll() drains the records that
+// arrived since the last call into a fixed buffer, classifies them with a
+// matcher built once at startup and keeps the recognised ones in a ring.
+class KernelLogTap {
+public:
+    static const size_t MAX_EVENTS = 128;     // Ring of recent events
+    static const size_t RECORD_SIZE = 8192;   // Longest /dev/kmsg record
+
+    KernelLogTap();
+    ~KernelLogTap();
+
+    // Open /dev/kmsg; records already in the log are marked historical
+    bool open();
+    void close();
+    bool isOpen() const { return fd >= 0; }
+    // Readable when new records arrive, for waiting with poll() (-1 when closed)
+    int fileDescriptor() const { return fd; }
+    const std::string& error() const { return open_error; }
+
+    // Read at most 'max_records'; returns how many new events were added
+    size_t poll(size_t max_records = 256);
+
+    // Recent events, 0 = newest
+    size_t eventCount() const { return count; }
+    const KernelEvent& event(size_t index) const;
+
+    // Counters since open()
+    uint64_t recordsRead() const { return records; }
+    uint64_t recordsLost() const { return lost; }
+
+    static const char* typeName(KernelEventType type);
+    static bool isCritical(KernelEventType type);
+
+private:
+    int fd = -1;
+    std::string open_error;
+    bool in_backlog = false;   // Still reading records logged before open()
+    char record[RECORD_SIZE];
+
+    KernelEvent events[MAX_EVENTS];
+    size_t head = 0;           // Next slot to write
+    size_t count = 0;
+    uint64_t records = 0;
+    uint64_t lost = 0;
+
+    // Patterns indexed by their first byte, so a record is scanned once
+    static const int MAX_CANDIDATES = 4;
+    signed char candidates[256][MAX_CANDIDATES];
+
+    bool parseRecord(size_t length, KernelEvent& event);
+    int classify(const char* message, const char** match) const;
+};
+
+#endif // KERNEL_LOG_H
@@ -0,0 +1,26 @@
+#ifndef METRIC_FEATURES_H
+#define METRIC_FEATURES_H
+
+// Metric groups the collectors can be compiled with. A build selects its set
+// at compile time (make FEATURES="CPU MEMORY"); code and storage for the
+// groups left out are not generated at all.
+enum MetricFeature {
+    FEATURE_CPU       = 1u << 0,   // /proc/stat totals and per-core usage
+    FEATURE_MEMORY    = 1u << 1,   // /proc/meminfo, cache and latency estimates
+    FEATURE_DISKS     = 1u << 2,   // Mounted filesystems and /proc/diskstats
+    FEATURE_PROCESSES = 1u << 3,   // The /proc/[pid] scan
+    FEATURE_ALL       = (1u << 4) - 1
+};
+
+// Feature set of this build; the TUI and libasrmt always use FEATURE_ALL
+#ifndef ASRMT_FEATURES
+#define ASRMT_FEATURES FEATURE_ALL
+#endif
+
+constexpr unsigned BUILD_FEATURES = ASRMT_FEATURES;
+
+constexpr bool hasFeature(unsigned features, unsigned feature) {
+    return (features & feature) != 0;
+}
+
+#endif // METRIC_FEATURES_H
@@ -8,99 +8,77 @@
 #include <chrono>
 #include <signal.h>
 #include <fstream>
+#include <memory>
+#include "system_info.h"
+#include "collector.h"
+#include "history.h"
+#include "snapshot_diff.h"
+#include "render_backend.h"
+#include "wait_profiler.h"
+#include "kernel_log.h"
+#include "perf_counters.h"
+#include "delay_accounting.h"
+#include "page_cache.h"
+#include "disk_usage.h"
+#include "write_tracker.h"
+#include "stress.h"
+#include "flight_recorder.h"
+#include "trace.h"
+#include "watch_list.h"
+#include "app_groups.h"
+#include "notify.h"
+#include "process_log.h"
+#include "pressure.h"
+#include "tick_watchdog.h"
+#include "overhead_budget.h"
 
 // Configuration structure for the activity monitor
 struct MonitorConfig {
     int refresh_rate_ms = 1000;  // Update interval in milliseconds
+    double cpu_budget_percent = 0.0; // Own CPU use allowed, % of one core (0 = no budget)
     float cpu_threshold = 80.0f; // CPU threshold for alerts (%)
     bool show_alert = true;      // Whether to show CPU threshold alerts
     bool system_notifications = true; // Whether to show system desktop notifications
     bool debug_mode = false;     // Enable debug output
     bool debug_only_mode = false; // Run in debug-only mode (no UI)
+    int history_size = 300;      // Number of snapshots kept for pause/scrub
+    std::string renderer = "auto"; // Output backend: "ansi", "ncurses" or "auto"
+    int render_benchmark_frames = 0; // Frames per backend for --bench-render (0 = off)
+    int profile_hz = 100;        // Wait-channel profiler sampling frequency
+    int profile_budget = 2000;   // Max thread samples per second for the profiler
+    bool kernel_log = true;      // Watch /dev/kmsg for OOM kills, I/O errors, lockups, ...
+    int perf_top_n = 0;          // Exact perf_event accounting for the top N CPU processes (0 = off)
+    int delay_top_n = 0;         // Taskstats delay accounting for the top N CPU processes (0 = off)
+    std::string delay_exit_cpus; // CPUs whose exits are reported with --delays (empty = all)
+    PressureWeights pressure_weights; // Signal weights of the composite pressure score
+    std::string cache_scan_path; // Page-cache explorer: scan this tree instead of open files
+    int cache_rescan_s = 30;     // Seconds between page-cache explorer passes
+    int cache_cpu_percent = 5;   // CPU share the page-cache explorer may use
+    int cache_files_per_sec = 200; // Files the page-cache explorer may open per second
+    std::string write_track_path = "/"; // Filesystem watched by the write hotspot tracker
+    std::vector<StressLoad> stress_loads; // Synthetic load to generate (--stress)
+    int stress_duration_s = 0;   // Stop the load after this many seconds (0 = run until exit)
+    bool stress_report = false;  // No UI: print injected vs. measured values each refresh
+    std::string flight_dir;      // Flight recorder dumps go here on alerts (empty = off)
+    int flight_max_per_hour = 4; // Cap on flight recorder dumps
+    std::vector<WatchRule> watch_rules; // Processes sampled at the fast watch cadence (--watch)
+    int watch_interval_ms = 100; // Watch list sampling interval
+    std::vector<AppGroupRule> app_groups; // Application groups for the app view (--group)
+    std::string process_log_path; // Record every process seen to this log (empty = off)
 };
 
-// Represents a single process
-struct Process {
-    int pid;                  // Process ID
-    std::string name;         // Process name
-    float cpu_percent;        // CPU usage (%)
-    float mem_percent;        // Memory usage (%)
-    
-    // For sorting processes
-    bool operator<(const Process& other) const {
-        return cpu_percent > other.cpu_percent; // Default sort by CPU usage (descending)
-    }
-};
-
-// Represents CPU information
-struct CPUInfo {
-    std::vector<float> core_usage;  // Usage per core (%)
-    float total_usage;              // Total CPU usage (%)
-    int num_cores;                  // Number of cores
-};
-
-// Store CPU time data for accurate calculations
-struct CPUTimeInfo {
-    unsigned long user;
-    unsigned long nice;
-    unsigned long system;
-    unsigned long idle;
-    unsigned long iowait;
-    unsigned long irq;
-    unsigned long softirq;
-    unsigned long steal;
-    
-    // Calculate total time
-    unsigned long total() const {
-        return user + nice + system + idle + iowait + irq + softirq + steal;
-    }
-    
-    // Calculate idle time
-    unsigned long idle_time() const {
-        return idle + iowait;
-    }
-    
-    // Calculate active time
-    unsigned long active_time() const {
-        return user + nice + system + irq + softirq + steal;
-    }
-};
-
-// Represents memory information
-struct MemoryInfo {
-    unsigned long total;      // Total memory (KB)
-    unsigned long free;       // Free memory (KB)
-    unsigned long available;  // Available memory (KB)
-    unsigned long used;       // Used memory (KB)
-    float percent_used;       // Percentage of memory used
-    
-    // Swap information
-    unsigned long swap_total;
-    unsigned long swap_free;
-    unsigned long swap_used;
-    float swap_percent_used;
-    
-    // Cache information
-    unsigned long cached;     // Cached memory (KB)
-    unsigned long buffers;    // Buffer memory (KB)
-    float cache_hit_rate;     // Cache hit rate (%)
-    
-    // Latency information
-    float latency_ns;         // Memory access latency in nanoseconds
-};
-
-// Represents disk information for each partition
-struct DiskInfo {
-    std::string device;           // Device name (e.g., /dev/sda1)
-    std::string mount_point;      // Mount point (e.g., /)
-    unsigned long total_space;    // Total space (KB)
-    unsigned long free_space;     // Free space (KB)
-    unsigned long used_space;     // Used space (KB)
-    float percent_used;           // Percentage of space used
-    
-    // I/O and latency metrics
-    float read_latency_ms;        // Read latency in milliseconds
-    unsigned long io_operations;  // Number of I/O operations since boot
+// What the process panel is showing
+enum ProcessView {
+    VIEW_PROCESSES,      // Sorted process list
+    VIEW_DIFF,           // Snapshot diff
+    VIEW_WAIT_PROFILE,   // Wait-channel profile of the selected process
+    VIEW_KERNEL_EVENTS,  // Recent classified kernel log events
+    VIEW_PAGE_CACHE,     // Files occupying the page cache
+    VIEW_DISK_USAGE,     // Directory space analyzer for a mount
+    VIEW_WRITE_HOTSPOTS, // Processes and files writing the most
+    VIEW_WATCH,          // Fast-sampled history of the watch list
+    VIEW_APPS,           // Processes aggregated into application groups
+    VIEW_PROCESS_HISTORY // Search of the process log
 };
 
 // Main activity monitor class
@@ -108,30 +86,116 @@ class ActivityMonitor {
 private:
     MonitorConfig config;
     
+    // Reads /proc; the fields below hold its results, or a snapshot while paused
+    SystemCollector collector;
+    
     // Data structures for system information
     CPUInfo cpu_info;
     MemoryInfo memory_info;
     std::vector<DiskInfo> disk_info;
-    std::vector<Process> processes;
+    std::vector<Process> processes;       // As shown: sorted, or a snapshot while paused
+    std::vector<Process> live_processes;  // Newest process scan with pressure scores; collection works from it
+    
+    // Measures each refresh against the refresh interval and sheds load on overruns
+    TickWatchdog watchdog;
+    TickPlan tick_plan;           // What the refresh being collected reads
+    
+    // Keeps the monitor's own CPU use under --cpu-budget
+    OverheadBudget overhead;
+    
+    // Recent snapshots for pausing and scrubbing
+    SnapshotHistory history;
+    bool paused = false;          // True while the view is frozen on a snapshot
+    uint64_t history_cursor = 0;  // Sequence number of the snapshot being viewed
+    
+    // Dumps the history and process details to disk when an alert fires
+    FlightRecorder flight_recorder;
+    bool flight_cpu_over = false;  // CPU was over the threshold at the last refresh
+    
+    // Alternative process panel views share one scroll position
+    ProcessView process_view = VIEW_PROCESSES;
+    int view_offset = 0;
+    
+    // Diff view between a marked snapshot and the one being viewed
+    bool diff_mark_set = false;
+    uint64_t diff_mark_seq = 0;
+    Snapshot diff_before;
+    Snapshot diff_after;
+    SnapshotDiff current_diff;
+    
+    // Sampling profiler for the selected process
+    WaitProfiler wait_profiler;
+    
+    // Which files are in the page cache
+    PageCacheExplorer page_cache;
+    
+    // Directory space analyzer: mount chooser, then a browsable size tree
+    DiskUsageScanner disk_usage;
+    bool du_choosing = true;            // Picking a mount rather than browsing
+    int du_mount_index = 0;             // Highlighted mount in the chooser
+    std::vector<std::string> du_path;   // Directory being browsed, below the scan root
+    int du_selected = 0;                // Highlighted row in the listing
+    
+    // fanotify write hotspots on one filesystem
+    WriteTracker write_tracker;
+    
+    // Watch list: a few processes sampled much faster than the full scan
+    WatchSampler watch;
+    std::vector<int> watch_pinned;  // PIDs pinned from the UI
+    std::vector<int> watch_pids;    // Sorted PIDs currently watched, for the list marker
+    
+    // Processes grouped into applications, membership cached per process
+    AppGrouper app_grouper;
+    
+    // Every process seen, appended to the process log when it exits
+    ProcessLog process_log;
+    std::string history_query;            // Text typed into the process history search
+    std::vector<size_t> history_matches;  // Newest matching records first
+    std::string history_searched;         // Query of history_matches
+    size_t history_searched_records = 0;  // Log size when history_matches was computed
+    double history_search_ms = 0.0;
+    
+    // Exact per-process counters for the top CPU processes and the selection
+    PerfCounterCollector perf;
     
-    // Ncurses windows for different sections
-    WINDOW *cpu_win;
-    WINDOW *mem_win;
-    WINDOW *disk_win;
-    WINDOW *process_win;
-    WINDOW *alert_win;
-    WINDOW *confirm_win;      // Window for confirmation dialog
+    // Wait times for the top CPU processes, the selection and the watch list
+    DelayAccounting delays;
     
-    // For calculating CPU and network usage
-    std::vector<CPUTimeInfo> prev_cpu_times;
-    std::vector<CPUTimeInfo> curr_cpu_times;
+    // Synthetic load and the monitor's readings of it
+    StressGenerator stress;
+    std::vector<StressReading> stress_readings;
+    std::vector<int> stress_prev_pids;             // Sorted PIDs of the previous refresh
+    std::chrono::steady_clock::time_point stress_last_sample;
     
-    // For calculating disk I/O stats
-    std::unordered_map<std::string, std::pair<unsigned long, unsigned long>> prev_disk_stats;
+    // Kernel log events (OOM kills, hung tasks, I/O errors, ...)
+    KernelLogTap kernel_log;
+    std::string kernel_alert;                      // Banner for the latest critical event
+    time_t kernel_alert_until = 0;                 // Banner is shown until then
+    time_t kernel_notified_at[KEV_TYPE_COUNT] = {}; // Desktop notification throttling
+    
+    // Output backend and the screen regions it draws
+    std::unique_ptr<Renderer> screen;
+    Panel cpu_win;
+    Panel mem_win;
+    Panel disk_win;
+    Panel process_win;
+    Panel alert_win;          // Open only while an alert is shown
     
     // For process list navigation
     int process_list_offset = 0;
-    int process_sort_type = 0; // 0 = CPU%, 1 = MEM%
+    int selected_pid = -1;     // Highlighted process (-1 = first row)
+    int process_sort_type = 0; // 0 = CPU%, 1 = MEM%, 2-5 = CPU/I/O/swap-in/reclaim wait, 6 = pressure
+    
+    // Largest THP users among the processes with the most resident memory
+    struct HugePageUser {
+        int pid;
+        std::string name;
+        unsigned long anon_huge_kb;
+    };
+    std::vector<HugePageUser> huge_page_users;  // Most first; only those with any
+    
+    // Composite score that ranks processes and picks the kill target
+    PressureScorer pressure;
     
     // Internal state
     bool running = true;
@@ -140,6 +204,18 @@ private:
     int terminal_height = 0;
     int terminal_width = 0;
     
+    // Output-aware rendering
+    std::chrono::time_point<std::chrono::high_resolution_clock> last_frame;
+    std::chrono::time_point<std::chrono::high_resolution_clock> last_tmux_check;
+    int frame_interval_ms = 50;   // Current frame interval, raised while the tty lags
+    int tty_queued_bytes = 0;     // Output queue after the last frame (TIOCOUTQ)
+    bool render_suspended = false; // Backgrounded or detached: collect but don't draw
+    bool tmux_detached = false;
+    pid_t tmux_check_pid = -1;    // Running 'tmux display-message', answered through tmux_check_fd
+    int tmux_check_fd = -1;
+    std::chrono::time_point<std::chrono::high_resolution_clock> tmux_check_started;
+    bool terminal_lost = false;   // Hangup or I/O error on the tty: never draw again
+    
     // Warning states
     bool warning_state = false;      // True if currently in warning state
     bool pre_warning_state = false;  // True if currently in pre-warning state
@@ -149,34 +225,128 @@ private:
     
     // Private member functions
     void initializeWindows();
+    void destroyWindows();
     void resizeWindows();
+    void setupColors();
     void collectData();
     
     // Debug log method
     void debugLog(const std::string& message);
     
     // Data collection methods
-    void updateCPUInfo();
-    void updateMemoryInfo();
-    void updateDiskInfo();
-    void updateProcessInfo();
-    void updateMemoryStats();
-    void updateDiskLatency();
+    void updateSystemInfo();
+    void updatePerfCounters();
+    void updateDelayAccounting();
+    void updateHugePageUsers();
+    void updateStressReadings();
     
     // Display methods
     void displayCPUInfo();
     void displayMemoryInfo();
+    void displayHugePages();
     void displayDiskInfo();
     void displayProcessInfo();
     void displayAlert();
-    bool displayConfirmationDialog(const std::string& message);
+    void displayHistoryStatus();
+    void displayWatchdogStatus();
+    void displayOverheadStatus();
+    // Without 'question' the message is only shown until a key is pressed
+    bool displayConfirmationDialog(const std::string& message, bool question = true);
     
     // System notification methods
     void sendSystemNotification(const std::string& title, const std::string& message, bool critical = false);
     void checkAndSendNotifications();
     
+    // Render throttling and suspension
+    void installTerminalSignalHandlers();
+    bool updateRenderState();
+    void startTmuxCheck();
+    bool pollTmuxCheck();
+    void cancelTmuxCheck();
+    bool frameDue();
+    void recordFrame(std::chrono::time_point<std::chrono::high_resolution_clock> frame_start);
+    void adjustFrameInterval(bool congested, long frame_us);
+    
+    // History navigation
+    void loadHistoryView(uint64_t seq);
+    void pauseView();
+    void scrubHistory(int steps);
+    void returnToLive();
+    
+    // Snapshot diff view
+    uint64_t viewedSeq() const;
+    void markDiffBaseline();
+    void toggleDiffView();
+    void updateDiff();
+    void displayDiffView();
+    
+    // Wait-channel profiler view
+    void toggleWaitProfile();
+    void displayWaitProfile();
+    
+    // Page-cache explorer view
+    std::vector<int> cacheScanPids() const;
+    void togglePageCache();
+    void displayPageCache();
+    
+    // Directory space analyzer view
+    void toggleDiskUsage();
+    bool handleDiskUsageKey(int ch);
+    void displayDiskUsage();
+    
+    // Write hotspot view
+    void toggleWriteHotspots();
+    void displayWriteHotspots();
+    
+    // Watch list
+    void updateWatchTargets();
+    bool isWatched(int pid) const;
+    void toggleWatchPin();
+    void pollWatchAlerts();
+    void toggleWatchView();
+    void displayWatchList();
+    
+    // Application view
+    void toggleAppView();
+    void displayAppGroups();
+    
+    // Process history search
+    void toggleProcessHistory();
+    bool handleProcessHistoryKey(int ch);
+    void displayProcessHistory();
+    
+    // Kernel log events
+    void pollKernelLog();
+    void handleKernelEvent(const KernelEvent& event);
+    std::string kernelEventTarget(const KernelEvent& event) const;
+    void toggleKernelEvents();
+    void displayKernelEvents();
+    void displayKernelBanner();
+    
+    // Self-overhead budget
+    void applyOverheadSettings();
+    std::string monitorState() const;
+    
+    // Flight recorder triggers
+    std::vector<int> flightCapturePids(int pid) const;
+    void triggerFlightRecorder(const std::string& reason, int pid);
+    void checkFlightTriggers();
+    
+    // Injected vs. measured load
+    std::string stressReadingLine(size_t i, bool average) const;
+    
+    // Delay accounting columns
+    void cycleDelaySort();
+    void displayDelayExits();
+    
+    // Process selection
+    int selectedIndex() const;
+    void moveSelection(int delta);
+    void setProcessView(ProcessView view);
+    
     // Process management
-    void killHighestCPUProcess();
+    const Process* highestPressureProcess() const;
+    void killHighestPressureProcess();
     bool killProcess(int pid);
     
     // Helper methods
@@ -197,6 +367,15 @@ public:
     // Debug-only mode (no UI)
     void runDebugMode();
     
+    // Compare bytes and CPU per frame of the rendering backends
+    void runRenderBenchmark(int frames);
+    
+    // Headless --stress-report mode
+    void runStressReport();
+    
+    // Injected vs. measured averages of the --stress run (empty without one)
+    std::string stressSummary() const;
+    
     // Handle user input
     void handleInput(int ch);
     
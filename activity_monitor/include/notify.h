@@ -0,0 +1,10 @@
+#ifndef NOTIFY_H
+#define NOTIFY_H
+
+#include <string>
+
+// Show a desktop notification with notify-send (part of libnotify-bin).
+// Failures are ignored: a missing notifier must not break monitoring.
+void sendDesktopNotification(const std::string& title, const std::string& message, bool critical);
+
+#endif // NOTIFY_H
@@ -0,0 +1,40 @@
+#ifndef ONCE_H
+#define ONCE_H
+
+#include <string>
+#include <ostream>
+
+// Field groups a --once snapshot can report
+enum OnceField {
+    ONCE_CPU    = 1 << 0,   // Total CPU usage
+    ONCE_CORES  = 1 << 1,   // Per-core CPU usage
+    ONCE_MEMORY = 1 << 2,
+    ONCE_SWAP   = 1 << 3,
+    ONCE_DISKS  = 1 << 4,
+    ONCE_PROCS  = 1 << 5,   // Process count and top CPU users (scans /proc)
+    ONCE_ALL    = (1 << 6) - 1
+};
+
+enum OnceFormat {
+    ONCE_TEXT,
+    ONCE_JSON,
+    ONCE_KV     // key=value lines, for shell scripts
+};
+
+struct OnceOptions {
+    bool enabled = false;
+    int interval_ms = 0;        // CPU sampling interval; 0 = averaged since boot
+    OnceFormat format = ONCE_TEXT;
+    int fields = ONCE_CPU | ONCE_MEMORY | ONCE_SWAP | ONCE_DISKS;
+    int top = 5;                // Processes listed with ONCE_PROCS
+};
+
+// Parse "cpu,memory,procs" (or "all") into OnceField bits; false with a message on error
+bool parseOnceFields(const std::string& spec, int& fields, std::string& error);
+bool parseOnceFormat(const std::string& name, OnceFormat& format);
+
+// Print one snapshot of the requested fields without any terminal setup.
+// Only the collectors those fields need are run; returns the exit status.
+int runOnce(const OnceOptions& options, std::ostream& out);
+
+#endif // ONCE_H
@@ -0,0 +1,66 @@
+#ifndef OVERHEAD_BUDGET_H
+#define OVERHEAD_BUDGET_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+
+// What the monitor may spend on collection and drawing at the current step
+struct OverheadSettings {
+    int refresh_ms = 1000;       // Collection interval
+    bool process_detail = true;  // Tier-2 process fields (I/O and run-queue counters, perf and delays)
+    int frame_ms = 0;            // Least time between frames (0 = no limit beyond the tty's)
+};
+
+// Keeps the monitor's own CPU use (all threads and finished helper processes,
+// from getrusage) under a share of one core (--cpu-budget). The use is
+// measured over windows of at least 5 s. A window over the budget moves one step down a ladder of
+// cheaper settings:
+//   1. 4 frames per second
+//   2. no tier-2 process fields
+//   3. twice the refresh interval
+//   4. 1 frame per second
+//   5. 4 times the refresh interval
+//   6. 8 times the refresh interval
+// Without a display the frame steps are left out. Two windows in a row
+// under half the budget move one step back up.
+class OverheadBudget {
+public:
+    // 'percent' of one core, 0 to disable; 'refresh_ms' is the configured interval
+    void configure(double percent, int refresh_ms, bool display);
+    bool enabled() const { return budget_percent > 0.0; }
+
+    // Call often; measures when a window is complete. True if the settings changed.
+    bool update();
+
+    const OverheadSettings& settings() const { return current; }
+    int step() const { return level; }
+    int maxStep() const { return static_cast<int>(ladder.size()) - 1; }
+    double budget() const { return budget_percent; }
+    double measuredPercent() const { return window_percent; }   // Over the last complete window (-1 = none yet)
+    double averagePercent() const;                              // Since the first update
+
+    // "self 0.84% of 1.00% CPU; refresh 2 s, no tier-2 fields, 1 fps"
+    std::string describe() const;
+
+private:
+    static const int MIN_WINDOW_MS = 5000;
+
+    double budget_percent = 0.0;
+    bool with_display = true;
+    std::vector<OverheadSettings> ladder;   // Settings of each step
+    int level = 0;
+    OverheadSettings current;
+    int calm_windows = 0;            // Windows in a row under half the budget
+
+    bool started = false;
+    std::chrono::steady_clock::time_point first_wall;
+    std::chrono::steady_clock::time_point window_wall;
+    double first_cpu_s = 0.0;
+    double window_cpu_s = 0.0;
+    double last_cpu_s = 0.0;
+    std::chrono::steady_clock::time_point last_wall;
+    double window_percent = -1.0;
+};
+
+#endif // OVERHEAD_BUDGET_H
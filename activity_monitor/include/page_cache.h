@@ -0,0 +1,87 @@
+#ifndef PAGE_CACHE_H
+#define PAGE_CACHE_H
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// One file and how much of it is in the page cache
+struct CachedFile {
+    std::string path;
+    uint64_t size_bytes;
+    uint64_t resident_bytes;
+    int pid;                    // A process that has it open (-1 for path scans)
+    std::string open_path;      // /proc/PID/fd/N to open instead of 'path' (empty for path scans)
+    uint64_t device = 0;        // Identity of an open file, checked when it is reopened
+    uint64_t inode = 0;
+};
+
+// Finds which files occupy the page cache. A background worker maps each
+// candidate file and counts its resident pages with mincore(), without
+// reading the file. Candidates are the regular files open by a set of
+// processes, or every file below a directory. The worker rescans
+// periodically and paces itself to a CPU share and a files-per-second rate.
+class PageCacheExplorer {
+public:
+    static const size_t MAX_RESULTS = 200;   // Largest cached files kept per pass
+
+    PageCacheExplorer() {}
+    ~PageCacheExplorer();
+
+    // Start scanning files open by 'pids' (when 'root' is empty) or the tree at 'root'
+    void start(const std::vector<int>& pids, const std::string& root, int rescan_seconds,
+               int cpu_percent, int files_per_second);
+    void stop();
+    bool active() const { return running.load(); }
+
+    // Processes to take open files from in the next pass
+    void setPids(const std::vector<int>& pids);
+
+    struct Stats {
+        size_t files_scanned = 0;       // Files examined in the last complete pass
+        size_t files_skipped = 0;       // Could not be opened or mapped
+        uint64_t resident_bytes = 0;    // Sum over all scanned files
+        uint64_t mapped_bytes = 0;      // Size of all scanned files
+        double pass_seconds = 0.0;      // Duration of the last pass (including pacing)
+        size_t passes = 0;              // Complete passes
+        bool scanning = false;          // A pass is in progress
+        size_t progress = 0;            // Files examined so far in the current pass
+    };
+
+    // Results of the last complete pass, largest resident first
+    std::vector<CachedFile> results() const;
+    Stats stats() const;
+    const std::string& root() const { return scan_root; }
+
+private:
+    std::thread worker;
+    std::atomic<bool> running{false};
+    bool stop_requested = false;
+    mutable std::mutex lock;             // Guards everything below the thread handle
+    std::condition_variable wake;
+
+    std::vector<int> scan_pids;
+    std::string scan_root;
+    int rescan_interval = 30;
+    double cpu_share = 0.05;
+    int file_rate = 200;
+
+    std::vector<CachedFile> published;
+    Stats current;
+
+    std::vector<unsigned char> residency;  // mincore() output, reused across files
+
+    void workerLoop();
+    bool collectCandidates(std::vector<CachedFile>& files, double& work_done, double cpu_start,
+                           std::chrono::steady_clock::time_point wall_start);
+    bool measure(CachedFile& file);
+    bool pace(size_t progress, double work_done, double cpu_start,
+              std::chrono::steady_clock::time_point wall_start);
+};
+
+#endif // PAGE_CACHE_H
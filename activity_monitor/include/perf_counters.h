@@ -0,0 +1,79 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <chrono>
+#include <cstdint>
+
+// Exact per-process accounting from perf_event software counters
+struct PerfSample {
+    double cpu_percent = 0.0;         // task-clock over the last interval / wall time
+    double context_switches = 0.0;    // Per second
+    double cpu_migrations = 0.0;      // Per second
+    double page_faults = 0.0;         // Per second
+    size_t threads_counted = 0;       // Threads with an open counter group
+    size_t threads_total = 0;         // Threads in the process
+    bool valid = false;               // False until counted over one interval
+};
+
+// Opens one counter group (task-clock, context-switches, cpu-migrations,
+// page-faults) per thread of each tracked process and reads each group
+// with a single read(). Uses only software events, so no hardware PMU is
+// needed; if perf_event_open is not permitted the collector turns itself
+// off and reports why.
+class PerfCounterCollector {
+public:
+    static const size_t MAX_GROUPS = 256;  // Thread groups open at once (4 fds each)
+
+    PerfCounterCollector() {}
+    ~PerfCounterCollector();
+
+    // Probe perf_event_open once; false (with a reason) if it cannot be used
+    bool probe();
+    bool available() const { return usable; }
+    const std::string& unavailableReason() const { return reason; }
+    bool userOnly() const { return exclude_kernel; }
+
+    // Count exactly these processes from now on; others are closed
+    void track(const std::vector<int>& pids);
+
+    // Read all groups and compute rates since the previous update
+    void update();
+
+    // Latest sample for a tracked process, or nullptr
+    const PerfSample* sample(int pid) const;
+
+    size_t groupsOpen() const { return group_count; }
+
+private:
+    enum { COUNTER_TASK_CLOCK, COUNTER_CONTEXT_SWITCHES, COUNTER_CPU_MIGRATIONS, COUNTER_PAGE_FAULTS, COUNTER_COUNT };
+
+    struct ThreadGroup {
+        int tid;
+        int fds[COUNTER_COUNT];
+        uint64_t last[COUNTER_COUNT];  // Values at the previous read (0 when opened)
+        bool seen;                     // Still present in the last task scan
+    };
+
+    struct TrackedProcess {
+        std::vector<ThreadGroup> threads;
+        PerfSample current;
+    };
+
+    bool usable = false;
+    bool probed = false;
+    bool exclude_kernel = false;   // Fallback when kernel-side counting is refused
+    std::string reason;
+
+    std::map<int, TrackedProcess> tracked;
+    size_t group_count = 0;
+    std::chrono::steady_clock::time_point last_update;
+
+    bool openGroup(int tid, ThreadGroup& group);
+    void closeGroup(ThreadGroup& group);
+    void refreshThreads(int pid, TrackedProcess& proc);
+};
+
+#endif // PERF_COUNTERS_H
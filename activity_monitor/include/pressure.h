@@ -0,0 +1,71 @@
+#ifndef PRESSURE_H
+#define PRESSURE_H
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <chrono>
+#include "system_info.h"
+
+// Weight of each signal in the composite pressure score (--pressure)
+struct PressureWeights {
+    float cpu = 1.0f;          // CPU time used over the interval
+    float rss_growth = 1.0f;   // Resident memory gained per second
+    float io = 1.0f;           // Storage bytes read and written per second
+    float faults = 1.0f;       // Major page faults per second
+    float run_delay = 1.0f;    // Share of the interval spent waiting for a CPU
+};
+
+// Parse "cpu=2,rss=1,io=1,faults=0.5,runq=1"; signals not named keep their weight
+bool parsePressureWeights(const std::string& spec, PressureWeights& weights, std::string& error);
+
+// Ranks processes that are moderately heavy on several axes at once. Each
+// signal is divided by its largest value in the process table (or a floor,
+// so an idle system does not magnify noise), then weighted and summed; the
+// top process on every axis would score the sum of the weights. The table
+// is laid out as one column per signal, padded to whole blocks, so the
+// scoring pass compiles to vector instructions.
+class PressureScorer {
+public:
+    static const size_t BLOCK = 8;   // Column padding: scored in blocks of this many processes
+
+    void setWeights(const PressureWeights& new_weights) { weights = new_weights; }
+    const PressureWeights& getWeights() const { return weights; }
+
+    // Score every process from its change since the previous call (stored in Process::pressure)
+    void update(std::vector<Process>& processes);
+
+    // Measure rates afresh at the next update (the counters were not kept up to date)
+    void restartRates() { have_previous = false; }
+
+    // The signals behind a process's score, largest first ("CPU 85%, I/O 12.0 MB/s")
+    std::string describe(int pid) const;
+
+private:
+    struct Previous {
+        unsigned long long start_time;
+        unsigned long long cpu_ticks;
+        unsigned long rss_kb;
+        unsigned long long io_bytes;
+        unsigned long long major_faults;
+        unsigned long long run_delay_ns;
+        size_t row;                  // Row in the columns of the last update
+    };
+
+    PressureWeights weights;
+    std::unordered_map<int, Previous> previous;   // By PID, from the last update
+    std::unordered_map<int, Previous> current;    // Filled by an update, then swapped; kept to reuse its buckets
+    std::chrono::steady_clock::time_point last_update;
+    bool have_previous = false;
+
+    // Signals of the last update, one entry per process in its order
+    std::vector<float> cpu;          // % of one core
+    std::vector<float> rss_growth;   // KB/s (growth only)
+    std::vector<float> io;           // Bytes/s
+    std::vector<float> faults;       // Per second
+    std::vector<float> run_delay;    // % of the interval
+    std::vector<float> score;
+    float scale[5] = {};             // Weight / column maximum of the last update
+};
+
+#endif // PRESSURE_H
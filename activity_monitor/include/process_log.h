@@ -0,0 +1,130 @@
+#ifndef PROCESS_LOG_H
+#define PROCESS_LOG_H
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <ctime>
+#include <ostream>
+#include "system_info.h"
+
+// Append-only record of every process the monitor has seen, with a trigram
+// index over the command lines. Records are written when a process exits
+// (it was missing at a refresh), and for the processes still running when
+// the log is closed. Each record holds the totals at the last sighting, so
+// processes that live shorter than one refresh are not recorded.
+class ProcessLog {
+public:
+    struct Record {
+        int32_t pid;
+        int32_t uid;              // -1 if unknown
+        uint64_t start_time;      // Clock ticks since boot
+        int64_t started_at;       // Wall-clock start time
+        int64_t last_seen;        // Exit time, or when the log was closed while running
+        uint64_t cpu_ticks;       // utime + stime (clock ticks)
+        uint64_t peak_rss_kb;     // Largest RSS seen at a refresh
+        uint64_t read_bytes;      // Storage I/O totals
+        uint64_t write_bytes;
+        uint64_t boot_id;         // Identifies the boot start_time counts from
+        uint32_t flags;
+        uint32_t text_offset;     // Command line within the text arena
+        uint32_t text_length;
+    };
+
+    static const uint32_t FLAG_RUNNING = 1;   // Still running when the log was closed
+
+    ProcessLog();
+    ~ProcessLog();
+
+    // Load the existing log. With 'writable', new records are appended to it
+    // (created with mode 0600, command lines may hold secrets) and the records
+    // are indexed for repeated searches; a read-only log is searched by a scan,
+    // which is faster than building the index for a single query.
+    bool open(const std::string& path, bool writable, std::string& error);
+    // Record the processes still running, then close the file
+    void close();
+    bool isOpen() const { return loaded; }
+    bool isWritable() const { return fd >= 0; }
+    // Why appending stopped (a failed write), empty while it works
+    const std::string& error() const { return last_error; }
+
+    // Follow the processes of one refresh; exited ones are appended to the log
+    void update(const std::vector<Process>& processes);
+
+    // Records whose command line contains 'text' (ASCII case-insensitive), newest first;
+    // limit 0 returns every match
+    std::vector<size_t> search(const std::string& text, size_t limit = 0) const;
+
+    size_t recordCount() const { return records.size(); }
+    const Record& record(size_t index) const { return records[index]; }
+    std::string commandLine(size_t index) const;
+    // On one line: newlines and tabs inside arguments become spaces
+    std::string printableCommandLine(size_t index) const;
+
+    // Heap used by the records, command lines and index (bytes)
+    size_t memoryUsage() const;
+
+private:
+    struct Live {
+        Record record;
+        std::string cmdline;
+        uint64_t seen = 0;        // Generation of the last refresh that listed it
+    };
+
+    // Ascending record numbers, delta-encoded as varints
+    struct PostingList {
+        std::vector<uint8_t> deltas;
+        uint32_t last = 0;
+        uint32_t count = 0;
+    };
+
+    int fd = -1;
+    bool loaded = false;
+    bool indexed = false;
+    time_t boot_time = 0;
+    uint64_t boot_id = 0;
+    long ticks_per_second = 100;
+
+    std::vector<Record> records;
+    std::string text;                                    // All command lines, back to back
+    // A process across sessions: start times restart at every boot
+    struct RecordKey {
+        uint64_t boot_id;
+        uint64_t start_time;
+        int32_t pid;
+        bool operator==(const RecordKey& other) const {
+            return boot_id == other.boot_id && start_time == other.start_time && pid == other.pid;
+        }
+    };
+    struct RecordKeyHash {
+        size_t operator()(const RecordKey& k) const {
+            return std::hash<uint64_t>()(k.boot_id ^ (k.start_time << 22) ^ static_cast<uint32_t>(k.pid));
+        }
+    };
+    std::unordered_map<RecordKey, uint32_t, RecordKeyHash> running_records;  // Records flagged running
+
+    // Trigrams are folded to 6-bit characters, so the index is a direct table
+    std::vector<uint32_t> trigram_lists;                 // Folded trigram -> 1 + list (0 = none)
+    std::vector<PostingList> lists;
+
+    std::unordered_map<uint64_t, Live> live;             // Processes seen in the current session
+    uint64_t generation = 0;
+    std::string pending;                                 // Encoded records not yet written
+    std::string last_error;
+
+    // Within a session the boot is the same for every process
+    static uint64_t key(int pid, uint64_t start_time) { return (start_time << 22) | static_cast<uint32_t>(pid); }
+    void add(const Record& record, const char* cmdline, size_t length);
+    void index(uint32_t number, const char* cmdline, size_t length);
+    void append(const Record& record, const std::string& cmdline);
+    void flush();
+    bool load(const std::string& path, bool writable, std::string& error);
+    std::string readCommandLine(const Process& proc) const;
+};
+
+// Print the records of the log at 'path' whose command line contains 'query',
+// newest first, with the search time; returns the exit status
+int runProcessSearch(const std::string& path, const std::string& query, std::ostream& out);
+
+#endif // PROCESS_LOG_H
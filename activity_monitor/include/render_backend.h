@@ -0,0 +1,135 @@
+#ifndef RENDER_BACKEND_H
+#define RENDER_BACKEND_H
+
+#include <ncurses.h>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// A rectangular screen region drawn by one of the display methods.
+// Attributes use the ncurses vocabulary (COLOR_PAIR(n), A_BOLD, ...) for
+// both backends so the display code does not care which one is active.
+struct Panel {
+    WINDOW* win = nullptr;  // Backing window (ncurses backend only)
+    int y = 0;              // Screen position and size
+    int x = 0;
+    int height = 0;
+    int width = 0;
+    attr_t attrs = 0;       // Current drawing attributes (wattron/wattroff)
+    attr_t bkgd = 0;        // Background attributes (wbkgd)
+    bool open = false;      // False until createPanel(), and after destroyPanel()
+};
+
+// Output backend for the terminal UI
+class Renderer {
+public:
+    virtual ~Renderer() {}
+
+    virtual const char* name() const = 0;
+
+    virtual void definePair(short pair, short fg, short bg) = 0;
+    virtual void createPanel(Panel& p, int height, int width, int y, int x) = 0;
+    virtual void destroyPanel(Panel& p) = 0;
+
+    // Drawing; coordinates are relative to the panel and clipped to it
+    virtual void clear(Panel& p) = 0;
+    virtual void box(Panel& p) = 0;
+    virtual void background(Panel& p, attr_t attrs) = 0;
+    virtual void print(Panel& p, int row, int col, const char* fmt, ...)
+        __attribute__((format(printf, 5, 6))) = 0;
+    virtual void putChar(Panel& p, int row, int col, char ch) = 0;
+    void attrOn(Panel& p, attr_t a) { p.attrs |= a; if (p.win) wattron(p.win, a); }
+    void attrOff(Panel& p, attr_t a) { p.attrs &= ~a; if (p.win) wattroff(p.win, a); }
+
+    // Mark a panel as finished for this frame, then send the frame
+    virtual void refresh(Panel& p) = 0;
+    virtual void present() = 0;
+
+    // Forget what is on the terminal; the next frame repaints everything
+    virtual void invalidate() = 0;
+
+    // Terminal size changed
+    virtual void resize(int rows, int cols) = 0;
+
+    // Output statistics since construction (bytes are only counted by
+    // backends that do their own writing)
+    unsigned long long framesPresented() const { return frames; }
+    unsigned long long bytesWritten() const { return bytes; }
+
+protected:
+    unsigned long long frames = 0;
+    unsigned long long bytes = 0;
+};
+
+// ncurses windows with wnoutrefresh + a single doupdate per frame
+class CursesRenderer : public Renderer {
+public:
+    const char* name() const override { return "ncurses"; }
+
+    void definePair(short pair, short fg, short bg) override;
+    void createPanel(Panel& p, int height, int width, int y, int x) override;
+    void destroyPanel(Panel& p) override;
+    void clear(Panel& p) override;
+    void box(Panel& p) override;
+    void background(Panel& p, attr_t attrs) override;
+    void print(Panel& p, int row, int col, const char* fmt, ...) override
+        __attribute__((format(printf, 5, 6)));
+    void putChar(Panel& p, int row, int col, char ch) override;
+    void refresh(Panel& p) override;
+    void present() override;
+    void invalidate() override;
+    void resize(int rows, int cols) override;
+};
+
+// Composes the whole frame into a preallocated cell buffer, diffs it
+// against the previous frame and sends only the changed cells, with
+// minimal cursor motion and SGR changes, in one writev() per frame.
+class AnsiRenderer : public Renderer {
+public:
+    explicit AnsiRenderer(int fd);
+
+    const char* name() const override { return "ansi"; }
+
+    void definePair(short pair, short fg, short bg) override;
+    void createPanel(Panel& p, int height, int width, int y, int x) override;
+    void destroyPanel(Panel& p) override;
+    void clear(Panel& p) override;
+    void box(Panel& p) override;
+    void background(Panel& p, attr_t attrs) override;
+    void print(Panel& p, int row, int col, const char* fmt, ...) override
+        __attribute__((format(printf, 5, 6)));
+    void putChar(Panel& p, int row, int col, char ch) override;
+    void refresh(Panel& p) override;
+    void present() override;
+    void invalidate() override;
+    void resize(int rows, int cols) override;
+
+private:
+    struct Cell {
+        uint32_t ch;    // Unicode code point
+        uint32_t attr;  // Masked ncurses attributes
+        bool operator==(const Cell& o) const { return ch == o.ch && attr == o.attr; }
+        bool operator!=(const Cell& o) const { return !(*this == o); }
+    };
+
+    int fd;
+    int rows = 0;
+    int cols = 0;
+    std::vector<Cell> frame;     // Being composed
+    std::vector<Cell> previous;  // What the terminal shows
+    std::string out;             // Escape sequence buffer, reused across frames
+    bool clear_pending = true;   // Start the next frame with a full screen clear
+    bool line_drawing = false;   // DEC line-drawing character set selected
+    short pair_fg[256];
+    short pair_bg[256];
+
+    void setCell(int row, int col, uint32_t ch, uint32_t attr);
+    void putText(Panel& p, int row, int col, const char* text);
+    uint32_t effectiveAttr(const Panel& p, attr_t attrs) const;
+    void appendSgr(uint32_t attr);
+    void appendMove(int row, int col, int cur_row, int cur_col);
+    void appendChar(uint32_t ch);
+    void writeFrame();
+};
+
+#endif // RENDER_BACKEND_H
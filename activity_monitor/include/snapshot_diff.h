@@ -0,0 +1,54 @@
+#ifndef SNAPSHOT_DIFF_H
+#define SNAPSHOT_DIFF_H
+
+#include <vector>
+#include <string>
+#include <ctime>
+#include "system_info.h"
+
+// Change of a process present in both snapshots
+struct ProcessDelta {
+    int pid;
+    std::string name;
+    float cpu_before;
+    float cpu_after;
+    long rss_delta_kb;        // Positive = grew
+    long long io_delta_bytes; // Read + write bytes moved between the snapshots
+};
+
+// Change of a mount present in both snapshots
+struct DiskDelta {
+    std::string mount_point;
+    float percent_before;
+    float percent_after;
+    long long io_ops_delta;
+    float latency_before_ms;
+    float latency_after_ms;
+};
+
+// Everything that changed between two snapshots
+struct SnapshotDiff {
+    time_t from_time = 0;
+    time_t to_time = 0;
+    float total_cpu_delta = 0.0f;
+    long long mem_used_delta_kb = 0;
+    long long swap_used_delta_kb = 0;
+
+    std::vector<Process> started;          // Present only in the later snapshot
+    std::vector<Process> exited;           // Present only in the earlier snapshot
+    std::vector<ProcessDelta> cpu_movers;  // Largest |CPU%| changes first
+    std::vector<ProcessDelta> rss_movers;  // Largest |RSS| changes first
+    std::vector<ProcessDelta> io_movers;   // Most I/O between the snapshots first
+
+    std::vector<float> core_deltas;        // Per-core usage change (percentage points)
+    std::vector<DiskDelta> disk_changes;
+    std::vector<std::string> mounts_added;
+    std::vector<std::string> mounts_removed;
+};
+
+// Compare two snapshots. Both process tables must be sorted by PID (as
+// SnapshotHistory::load returns them) so the comparison is a single
+// merge-join; a PID whose start time differs counts as exit + start.
+SnapshotDiff diffSnapshots(const Snapshot& before, const Snapshot& after, size_t top_n = 5);
+
+#endif // SNAPSHOT_DIFF_H
@@ -0,0 +1,87 @@
+#ifndef STRESS_H
+#define STRESS_H
+
+#include <vector>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <sys/types.h>
+
+// One synthetic load of --stress
+enum StressType {
+    STRESS_CPU,      // Busy loop at a duty cycle, pinned to one core
+    STRESS_MEMORY,   // Allocate and touch memory at a rate, then hold it
+    STRESS_FORK,     // Fork and reap short-lived children at a rate
+    STRESS_WRITE,    // Write and fdatasync a file at a rate
+    STRESS_READ      // Read a file at a rate, dropping it from the cache first
+};
+
+struct StressLoad {
+    StressType type;
+    int core = -1;          // STRESS_CPU: core to pin to
+    double amount = 0.0;    // CPU percent, MB to allocate, forks/s or MB/s
+    double rate = 0.0;      // STRESS_MEMORY: MB/s
+    pid_t pid = -1;         // Worker process while running
+};
+
+// Injected value of one load next to what the monitor measured
+struct StressReading {
+    double injected = 0.0;          // From the worker's own accounting
+    double measured = 0.0;          // From the monitor's collectors
+    double measured_process = 0.0;  // CPU loads: the worker's CPU% in the process list
+    double sum_injected = 0.0;      // For the averages over the run
+    double sum_measured = 0.0;
+    double sum_process = 0.0;
+    int samples = 0;
+    uint64_t last_progress = 0;
+    unsigned long long last_io = 0;
+    bool primed = false;            // Baselines taken
+};
+
+// Generates exactly specified load in child processes, so the monitor
+// measures it like any other workload. Each worker publishes its own exact
+// progress (CPU time used, bytes touched, forks done, bytes moved) in shared
+// memory as the ground truth to compare the monitor's readings against.
+class StressGenerator {
+public:
+    StressGenerator() {}
+    ~StressGenerator();
+
+    // Parse "cpu=50@0-1,mem=512@64,fork=100,write=20,read=20"; false with a message on error
+    static bool parse(const std::string& spec, std::vector<StressLoad>& loads, std::string& error);
+    static std::string describe(const StressLoad& load);
+
+    // Fork one worker per load; call before starting any threads
+    void start(const std::vector<StressLoad>& loads, int duration_seconds);
+    void stop();
+    bool active() const { return running; }
+
+    // Stop the workers once the duration has passed; true while still running
+    bool checkDuration();
+
+    const std::vector<StressLoad>& loads() const { return workers; }
+
+    // Ground truth of load i: CPU ns used, bytes touched, forks done or bytes moved
+    uint64_t progress(size_t i) const;
+
+    double elapsedSeconds() const;
+
+private:
+    static const size_t MAX_LOADS = 64;
+
+    std::vector<StressLoad> workers;
+    std::atomic<uint64_t>* counters = nullptr;   // Shared with the workers
+    std::chrono::steady_clock::time_point started;
+    std::chrono::steady_clock::time_point stopped;
+    int duration = 0;                            // Seconds, 0 = until stopped
+    bool running = false;
+
+    static void runWorker(const StressLoad& load, std::atomic<uint64_t>* counter);
+    static void cpuWorker(const StressLoad& load, std::atomic<uint64_t>* counter);
+    static void memoryWorker(const StressLoad& load, std::atomic<uint64_t>* counter);
+    static void forkWorker(const StressLoad& load, std::atomic<uint64_t>* counter);
+    static void ioWorker(const StressLoad& load, std::atomic<uint64_t>* counter);
+};
+
+#endif // STRESS_H
@@ -0,0 +1,134 @@
+#ifndef SYSTEM_INFO_H
+#define SYSTEM_INFO_H
+
+#include <vector>
+#include <string>
+#include <ctime>
+
+// Represents a single process
+struct Process {
+    int pid;                  // Process ID
+    std::string name;         // Process name
+    float cpu_percent;        // CPU usage (%)
+    float mem_percent;        // Memory usage (%)
+    unsigned long rss_kb;     // Resident set size (KB)
+    unsigned long long start_time;      // Start time in clock ticks since boot (tells reused PIDs apart)
+    unsigned long long io_read_bytes;   // Bytes read from storage (0 if /proc/[pid]/io is unreadable)
+    unsigned long long io_write_bytes;  // Bytes written to storage
+    unsigned long long cpu_ticks;       // utime + stime in clock ticks
+    unsigned long long major_faults;    // Page faults that needed I/O
+    unsigned long long run_delay_ns;    // Time spent runnable but waiting for a CPU (/proc/[pid]/schedstat)
+    int uid;                  // Real user ID (-1 if unknown)
+    float pressure;           // Composite pressure score of the last interval (0 until scored)
+    
+    // For sorting processes
+    bool operator<(const Process& other) const {
+        return cpu_percent > other.cpu_percent; // Default sort by CPU usage (descending)
+    }
+};
+
+// Represents CPU information
+struct CPUInfo {
+    std::vector<float> core_usage;  // Usage per core (%)
+    float total_usage;              // Total CPU usage (%)
+    int num_cores;                  // Number of cores
+};
+
+// Store CPU time data for accurate calculations
+struct CPUTimeInfo {
+    unsigned long user;
+    unsigned long nice;
+    unsigned long system;
+    unsigned long idle;
+    unsigned long iowait;
+    unsigned long irq;
+    unsigned long softirq;
+    unsigned long steal;
+    
+    // Calculate total time
+    unsigned long total() const {
+        return user + nice + system + idle + iowait + irq + softirq + steal;
+    }
+    
+    // Calculate idle time
+    unsigned long idle_time() const {
+        return idle + iowait;
+    }
+    
+    // Calculate active time
+    unsigned long active_time() const {
+        return user + nice + system + irq + softirq + steal;
+    }
+};
+
+// Represents memory information
+struct MemoryInfo {
+    unsigned long total;      // Total memory (KB)
+    unsigned long free;       // Free memory (KB)
+    unsigned long available;  // Available memory (KB)
+    unsigned long used;       // Used memory (KB)
+    float percent_used;       // Percentage of memory used
+    
+    // Swap information
+    unsigned long swap_total;
+    unsigned long swap_free;
+    unsigned long swap_used;
+    float swap_percent_used;
+    
+    // Cache information
+    unsigned long cached;     // Cached memory (KB)
+    unsigned long buffers;    // Buffer memory (KB)
+    float cache_hit_rate;     // Cache hit rate (%)
+    
+    // Latency information
+    float latency_ns;         // Memory access latency in nanoseconds
+    
+    // Huge pages (/proc/meminfo)
+    unsigned long anon_huge_kb;     // AnonHugePages: anonymous memory backed by THP
+    unsigned long shmem_huge_kb;    // ShmemHugePages: shmem and tmpfs backed by THP
+    unsigned long hugepages_total;  // HugeTLB pool, in pages of hugepage_size_kb
+    unsigned long hugepages_free;
+    unsigned long hugepages_rsvd;   // Reserved for mappings but not yet faulted in
+    unsigned long hugepages_surp;   // Allocated beyond the configured pool
+    unsigned long hugepage_size_kb;
+    
+    // THP and compaction events since boot (/proc/vmstat)
+    unsigned long long thp_fault_alloc;     // Faults served with a huge page
+    unsigned long long thp_fault_fallback;  // Faults that wanted a huge page and got a small one
+    unsigned long long thp_collapse_alloc;  // Huge pages assembled by khugepaged
+    unsigned long long compact_stall;       // Allocations that stalled in direct compaction
+    unsigned long long compact_fail;        // Direct compactions that freed no huge page
+    
+    // The same events per second over the last interval (0 until read twice)
+    float thp_fault_alloc_rate;
+    float thp_fault_fallback_rate;
+    float thp_collapse_alloc_rate;
+    float compact_stall_rate;
+    float compact_fail_rate;
+    double vmstat_read_at;          // CLOCK_MONOTONIC seconds of the counters (0 = never read)
+};
+
+// Represents disk information for each partition
+struct DiskInfo {
+    std::string device;           // Device name (e.g., /dev/sda1)
+    std::string mount_point;      // Mount point (e.g., /)
+    unsigned long total_space;    // Total space (KB)
+    unsigned long free_space;     // Free space (KB)
+    unsigned long used_space;     // Used space (KB)
+    float percent_used;           // Percentage of space used
+    
+    // I/O and latency metrics
+    float read_latency_ms;        // Read latency in milliseconds
+    unsigned long io_operations;  // Number of I/O operations since boot
+};
+
+// A complete point-in-time view of the system
+struct Snapshot {
+    time_t taken_at;
+    CPUInfo cpu;
+    MemoryInfo memory;
+    std::vector<DiskInfo> disks;
+    std::vector<Process> processes;
+};
+
+#endif // SYSTEM_INFO_H
@@ -0,0 +1,14 @@
+#ifndef THREAD_CPU_H
+#define THREAD_CPU_H
+
+#include <ctime>
+
+// CPU time of the calling thread (seconds); background samplers report
+// their own overhead from it
+inline double threadCpuSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#endif // THREAD_CPU_H
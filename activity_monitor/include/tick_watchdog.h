@@ -0,0 +1,75 @@
+#ifndef TICK_WATCHDOG_H
+#define TICK_WATCHDOG_H
+
+#include <string>
+#include <cstddef>
+
+// What one refresh collects at the current degradation level
+struct TickPlan {
+    bool process_detail = true;  // Tier-2 fields: per-process I/O and run-queue counters, perf and delay sampling
+    bool scan_processes = true;  // Walk /proc/[pid]; otherwise the previous process table is kept
+    bool record_history = true;  // Push a snapshot into the history
+};
+
+// Overrun statistics since startup
+struct TickStats {
+    unsigned long long ticks = 0;
+    unsigned long long overruns = 0;        // Refreshes that took longer than the budget
+    unsigned long long degraded_ticks = 0;  // Refreshes run below full fidelity
+    unsigned long long degradations = 0;    // Steps down a level
+    double last_ms = 0.0;
+    double worst_ms = 0.0;
+    double average_ms = 0.0;                // Exponential average over about 10 refreshes
+    int worst_level = 0;
+};
+
+// Measures every refresh against its budget (the refresh interval) and
+// sheds load while refreshes overrun it, one level at a time:
+//   1. skip the tier-2 per-process fields
+//   2. scan processes every 2nd refresh
+//   3. scan processes every 4th refresh
+//   4. keep every 2nd snapshot in the history
+// Two overruns in a row, or one of more than twice the budget, step down a
+// level. A level is restored after a run of refreshes that did all their
+// work in under half the budget; the run doubles whenever a restored level
+// overruns again, so a monitor at the edge of its budget does not flap.
+class TickWatchdog {
+public:
+    static const int MAX_LEVEL = 4;
+
+    void setBudget(double ms) { budget_ms = ms; }
+    double budget() const { return budget_ms; }
+
+    // What the refresh about to run should collect
+    TickPlan plan();
+
+    // Time taken by the planned refresh; true if the level changed
+    bool record(double ms);
+
+    int level() const { return degradation; }
+    bool degraded() const { return degradation > 0; }
+    const TickStats& stats() const { return totals; }
+
+    // The step a level adds ("processes every 2nd refresh")
+    static const char* levelName(int level);
+
+    // "12 overruns in 300 refreshes, worst 1.32 s"
+    std::string summary() const;
+
+private:
+    static const int MIN_CALM = 10;    // Refreshes under half the budget before restoring a level
+    static const int MAX_CALM = 160;
+
+    double budget_ms = 1000.0;
+    int degradation = 0;
+    TickPlan current;                  // Plan of the refresh being measured
+    int consecutive_overruns = 0;
+    int calm = 0;                      // Full refreshes under half the budget in a row
+    int calm_needed = MIN_CALM;
+    unsigned long long restored_at = 0; // Tick of the last restore (0 = none)
+    TickStats totals;
+
+    void changeLevel(int level);
+};
+
+#endif // TICK_WATCHDOG_H
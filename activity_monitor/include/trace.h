@@ -0,0 +1,51 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+
+// Records spans and counters of the monitor itself in Chrome Trace Event
+// format (viewable in Perfetto or chrome://tracing). Each thread appends to
+// its own single-producer ring without locks; a flusher thread drains the
+// rings to the file twice a second. Recording stops when the file reaches
+// its size limit, and events that find a ring full are dropped and counted.
+// Names and categories must be string literals.
+class Tracer {
+public:
+    // Start writing to 'path'; false if the file cannot be created
+    static bool start(const std::string& path, size_t max_bytes);
+    // Flush everything and close the JSON array
+    static void stop();
+
+    static bool enabled() { return recording.load(std::memory_order_relaxed); }
+    static int64_t now();
+
+    static void complete(const char* category, const char* name, int64_t start_ns, int64_t end_ns);
+    static void counter(const char* name, double value);
+    static void instant(const char* category, const char* name);
+    // Label the calling thread in the viewer
+    static void nameThread(const char* name);
+
+    // Cleared by stop() and when the file reaches its size limit
+    static std::atomic<bool> recording;
+};
+
+// Complete event covering the enclosing scope
+class TraceSpan {
+public:
+    TraceSpan(const char* category, const char* name)
+        : category(category), name(name), start_ns(Tracer::enabled() ? Tracer::now() : 0) {}
+    ~TraceSpan() {
+        if (start_ns != 0 && Tracer::enabled()) {
+            Tracer::complete(category, name, start_ns, Tracer::now());
+        }
+    }
+
+private:
+    const char* category;
+    const char* name;
+    int64_t start_ns;
+};
+
+#endif // TRACE_H
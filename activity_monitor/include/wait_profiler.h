@@ -0,0 +1,82 @@
+#ifndef WAIT_PROFILER_H
+#define WAIT_PROFILER_H
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+// One bucket of the blocking-point histogram
+struct BlockingPoint {
+    char state;            // Thread state from stat (R, S, D, ...)
+    int syscall_nr;        // Syscall the thread is in; -1 = none (user space), -2 = unknown
+    char wchan[48];        // Kernel function the thread sleeps in ("" if running)
+    char target[64];       // What the syscall's fd refers to, if it takes one
+    unsigned long count;   // Samples that landed here
+};
+
+// Samples /proc/[pid]/task/*/{wchan,syscall,stat} of one process on a
+// background thread and aggregates where its threads are waiting.
+// Counters live in a fixed-size table; samples that do not fit are only
+// counted as overflow, so memory use never depends on the workload.
+class WaitProfiler {
+public:
+    static const size_t MAX_POINTS = 256;   // Histogram buckets (power of two)
+    static const size_t MAX_THREADS = 4096; // Threads tracked per process
+
+    WaitProfiler() {}
+    ~WaitProfiler();
+
+    // Start sampling 'pid' at 'sample_hz', reading at most 'budget' threads per second
+    bool start(int pid, const std::string& name, int sample_hz, int budget);
+    void stop();
+
+    bool active() const { return running.load(); }
+    int pid() const { return target_pid; }
+    const std::string& name() const { return target_name; }
+
+    // Histogram sorted by count (descending), for display
+    std::vector<BlockingPoint> histogram() const;
+
+    // Sampling statistics
+    struct Stats {
+        unsigned long samples;         // Sampling rounds completed
+        unsigned long thread_samples;  // Individual thread reads
+        unsigned long overflow;        // Thread samples that found no free bucket
+        size_t threads;                // Threads seen in the last task scan
+        size_t threads_per_round;      // Threads read per round under the budget
+        double overhead_percent;       // Sampler CPU time / wall time
+        bool process_gone;             // Target exited
+    };
+    Stats stats() const;
+
+    // Name of a syscall number on this architecture ("" if not in our table)
+    static const char* syscallName(int nr);
+
+private:
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::atomic<bool> stop_requested{false};
+    mutable std::mutex lock;  // Guards points and stats
+
+    int target_pid = -1;
+    std::string target_name;
+    int interval_us = 10000;
+    size_t per_round = 1;
+
+    BlockingPoint points[MAX_POINTS];
+    Stats current = Stats();
+
+    // Thread IDs from the last /proc/[pid]/task scan; sampled round-robin
+    int tids[MAX_THREADS];
+    size_t tid_count = 0;
+    size_t next_tid = 0;
+
+    void workerLoop();
+    bool scanTasks();
+    void sampleThread(int tid, BlockingPoint& sample) const;
+    void record(const BlockingPoint& sample);
+};
+
+#endif // WAIT_PROFILER_H
@@ -0,0 +1,118 @@
+#ifndef WATCH_LIST_H
+#define WATCH_LIST_H
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+// A watch list entry from --watch: a process name or PID with optional limits
+struct WatchRule {
+    std::string name;            // Matched against the process name (empty for PID rules)
+    int pid = -1;
+    float cpu_limit = 0.0f;      // Alert above this CPU% (of one core), 0 = none
+    unsigned long rss_limit_mb = 0; // Alert above this resident size, 0 = none
+};
+
+// One watched process to sample
+struct WatchTarget {
+    int pid;
+    std::string name;
+    float cpu_limit;
+    unsigned long rss_limit_mb;
+    bool pinned;                 // Added from the UI rather than by a rule
+};
+
+struct WatchSample {
+    float cpu_percent;           // Of one core, over the sampling interval
+    unsigned long rss_kb;
+};
+
+// What the view shows for one watched process
+struct WatchedProcess {
+    WatchTarget target;
+    bool alive = true;
+    char state = '?';
+    int threads = 0;
+    bool alerting = false;
+    std::vector<WatchSample> samples;   // Oldest first
+};
+
+// A limit crossed (or cleared) by a watched process
+struct WatchAlert {
+    int pid;
+    std::string name;
+    std::string message;
+    bool raised;                 // false when the process is back under its limits
+};
+
+// Samples a few processes at a fast cadence, independent of the full /proc
+// scan. Each target keeps /proc/[pid]/stat and statm open and re-reads them
+// with pread(), so a sample costs two syscalls per process. Samples go to a
+// fixed ring per process; limits are checked against the average of the
+// last second on every sample.
+class WatchSampler {
+public:
+    static const size_t HISTORY = 600;      // Samples kept per process
+    static const size_t MAX_WATCHED = 16;   // Processes sampled at once
+
+    WatchSampler() {}
+    ~WatchSampler();
+
+    // Parse "postgres:cpu=90:rss=4096,nginx,1234"; false with a message on error
+    static bool parse(const std::string& spec, std::vector<WatchRule>& rules, std::string& error);
+
+    void start(int interval_ms);
+    void stop();
+    bool active() const { return running.load(); }
+    int intervalMs() const { return interval; }
+
+    // Replace the sampled set; processes already sampled keep their history
+    void setTargets(const std::vector<WatchTarget>& targets);
+
+    std::vector<WatchedProcess> snapshot() const;
+
+    // Limit crossings since the last call
+    std::vector<WatchAlert> takeAlerts();
+
+    double overheadPercent() const;
+
+private:
+    struct Slot {
+        WatchTarget target;
+        int stat_fd = -1;
+        int statm_fd = -1;
+        unsigned long long start_time = 0;  // Tells a reused PID apart
+        unsigned long long last_ticks = 0;
+        int64_t last_ns = 0;
+        WatchSample ring[HISTORY];
+        size_t count = 0;
+        size_t next = 0;
+        bool alive = true;
+        char state = '?';
+        int threads = 0;
+        bool alerting = false;
+    };
+
+    std::vector<std::unique_ptr<Slot>> slots;
+    mutable std::mutex lock;             // Guards slots and alerts
+    std::deque<WatchAlert> alerts;
+
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::atomic<bool> stop_requested{false};
+    int interval = 100;
+    std::atomic<double> overhead{0.0};
+
+    void workerLoop();
+    void sample(Slot& slot, int64_t now_ns);
+    void checkLimits(Slot& slot);
+    static bool openSlot(Slot& slot);
+    static void closeSlot(Slot& slot);
+};
+
+#endif // WATCH_LIST_H
@@ -0,0 +1,169 @@
+#ifndef WRITE_TRACKER_H
+#define WRITE_TRACKER_H
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+// Space-Saving heavy-hitter summary with a fixed number of counters. A key
+// that is not tracked takes over the smallest counter and inherits its count
+// as the error bound, so every key seen more than total/capacity times is
+// kept, whatever the number of distinct keys.
+template <typename Key, typename Info>
+class SpaceSaving {
+public:
+    struct Counter {
+        Key key;
+        uint64_t count;   // Upper bound on the key's events
+        uint64_t error;   // count - error is a lower bound
+        Info info;
+    };
+
+    explicit SpaceSaving(size_t capacity) : capacity(capacity) {}
+
+    // Count one event; 'inserted' is set when the key (re)started its counter
+    Counter& add(const Key& key, bool& inserted) {
+        auto found = index.find(key);
+        if (found != index.end()) {
+            inserted = false;
+            counters[found->second].count++;
+            return counters[found->second];
+        }
+
+        inserted = true;
+        if (counters.size() < capacity) {
+            index[key] = counters.size();
+            counters.push_back(Counter{key, 1, 0, Info()});
+            return counters.back();
+        }
+
+        size_t smallest = 0;
+        for (size_t i = 1; i < counters.size(); i++) {
+            if (counters[i].count < counters[smallest].count) {
+                smallest = i;
+            }
+        }
+        Counter& victim = counters[smallest];
+        index.erase(victim.key);
+        index[key] = smallest;
+        victim.key = key;
+        victim.error = victim.count;
+        victim.count++;
+        victim.info = Info();
+        return victim;
+    }
+
+    bool contains(const Key& key) const { return index.count(key) != 0; }
+
+    // Halve all counters so the tables follow recent activity
+    void decay() {
+        std::vector<Counter> kept;
+        kept.reserve(counters.size());
+        for (auto& counter : counters) {
+            counter.count /= 2;
+            counter.error /= 2;
+            if (counter.count > 0) {
+                kept.push_back(counter);
+            }
+        }
+        counters.swap(kept);
+        index.clear();
+        for (size_t i = 0; i < counters.size(); i++) {
+            index[counters[i].key] = i;
+        }
+    }
+
+    // Largest counters first
+    std::vector<Counter> top() const {
+        std::vector<Counter> sorted(counters);
+        std::sort(sorted.begin(), sorted.end(), [](const Counter& a, const Counter& b) {
+            return a.count > b.count;
+        });
+        return sorted;
+    }
+
+    void clear() {
+        counters.clear();
+        index.clear();
+    }
+
+private:
+    size_t capacity;
+    std::vector<Counter> counters;
+    std::unordered_map<Key, size_t> index;
+};
+
+// One row of the write hotspot tables
+struct WriteHotspot {
+    std::string name;          // Process name or file path
+    int pid;                   // Writer (last writer for files)
+    uint64_t events;           // Modify events, upper bound
+    uint64_t error;            // Possible overcount from the sketch
+    uint64_t close_writes;     // Files closed after writing
+};
+
+// Attributes file modifications on one filesystem to processes and files
+// with fanotify (FAN_MODIFY and FAN_CLOSE_WRITE on a filesystem mark, or a
+// mount mark on kernels without one). A worker thread drains the fanotify
+// queue into two Space-Saving tables of fixed size, so a storm of writes to
+// many files costs bounded memory and constant work per event. Counts halve
+// periodically to follow current activity.
+class WriteTracker {
+public:
+    static const size_t TABLE_SIZE = 128;   // Counters per table
+
+    WriteTracker();
+    ~WriteTracker();
+
+    // Watch the filesystem containing 'path'; on failure error() says why
+    bool start(const std::string& path);
+    void stop();
+    bool active() const { return running.load(); }
+    const std::string& error() const { return last_error; }
+    const std::string& path() const { return watch_path; }
+
+    struct Stats {
+        uint64_t events = 0;          // Events read from fanotify
+        uint64_t overflows = 0;       // Times the kernel queue overflowed and dropped events
+        uint64_t unresolved = 0;      // Events whose file could not be named
+        double cpu_seconds = 0.0;     // Worker CPU time
+        double seconds = 0.0;         // Time since start
+        bool filesystem_mark = true;  // false when only the mount is watched
+    };
+
+    // Current tables, largest first
+    void results(std::vector<WriteHotspot>& writers, std::vector<WriteHotspot>& files) const;
+    Stats stats() const;
+
+private:
+    struct WriterInfo {
+        char comm[16];
+        uint64_t close_writes;
+    };
+    struct FileInfo {
+        int pid;
+        uint64_t close_writes;
+    };
+
+    int fan_fd = -1;
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::atomic<bool> stop_requested{false};
+    std::string watch_path;
+    std::string last_error;
+
+    mutable std::mutex lock;             // Guards the tables and stats
+    SpaceSaving<int, WriterInfo> writers;
+    SpaceSaving<std::string, FileInfo> files;
+    Stats current;
+
+    void workerLoop();
+    void record(int pid, const char* comm, const char* path, bool close_write);
+};
+
+#endif // WRITE_TRACKER_H
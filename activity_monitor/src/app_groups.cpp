@@ -0,0 +1,249 @@
+#include "../include/app_groups.h"
+#include <deque>
+#include <sstream>
+#include <algorithm>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+void PatternMatcher::clear() {
+    states.assign(1, State());
+    states[0].next.fill(-1);
+    pattern_count = 0;
+}
+
+void PatternMatcher::add(const std::string& pattern, int id) {
+    if (pattern.empty()) {
+        return;
+    }
+
+    int state = 0;
+    for (unsigned char c : pattern) {
+        if (states[state].next[c] < 0) {
+            states[state].next[c] = static_cast<int>(states.size());
+            states.push_back(State());
+            states.back().next.fill(-1);
+        }
+        state = states[state].next[c];
+    }
+    if (states[state].best < 0 || id < states[state].best) {
+        states[state].best = id;
+    }
+    pattern_count++;
+}
+
+void PatternMatcher::build() {
+    // Breadth-first, so each state's fail target is complete before it is used
+    std::deque<int> queue;
+    for (int c = 0; c < 256; c++) {
+        int child = states[0].next[c];
+        if (child < 0) {
+            states[0].next[c] = 0;
+        } else {
+            states[child].fail = 0;
+            queue.push_back(child);
+        }
+    }
+
+    while (!queue.empty()) {
+        int state = queue.front();
+        queue.pop_front();
+
+        // Inherit matches of the longest proper suffix
+        int fail_best = states[states[state].fail].best;
+        if (fail_best >= 0 && (states[state].best < 0 || fail_best < states[state].best)) {
+            states[state].best = fail_best;
+        }
+
+        // Missing transitions follow the fail link, turning the trie into a DFA
+        for (int c = 0; c < 256; c++) {
+            int child = states[state].next[c];
+            if (child < 0) {
+                states[state].next[c] = states[states[state].fail].next[c];
+            } else {
+                states[child].fail = states[states[state].fail].next[c];
+                queue.push_back(child);
+            }
+        }
+    }
+}
+
+int PatternMatcher::match(const char* text, size_t length) const {
+    int best = -1;
+    int state = 0;
+    for (size_t i = 0; i < length; i++) {
+        state = states[state].next[static_cast<unsigned char>(text[i])];
+        int found = states[state].best;
+        if (found >= 0 && (best < 0 || found < best)) {
+            best = found;
+            if (best == 0) {
+                break;  // Nothing beats the first group
+            }
+        }
+    }
+    return best;
+}
+
+bool AppGrouper::parse(const std::string& spec, std::vector<AppGroupRule>& rules, std::string& error) {
+    size_t equals = spec.find('=');
+    if (equals == std::string::npos || equals == 0) {
+        error = "expected NAME=PATTERN[|PATTERN...] in '" + spec + "'";
+        return false;
+    }
+
+    AppGroupRule rule;
+    rule.name = spec.substr(0, equals);
+    std::stringstream patterns(spec.substr(equals + 1));
+    std::string pattern;
+    while (std::getline(patterns, pattern, '|')) {
+        if (pattern.compare(0, 4, "cmd:") == 0) {
+            pattern = pattern.substr(4);
+            if (!pattern.empty()) {
+                rule.cmdline_patterns.push_back(pattern);
+            }
+        } else if (!pattern.empty()) {
+            rule.comm_patterns.push_back(pattern);
+        }
+    }
+    if (rule.comm_patterns.empty() && rule.cmdline_patterns.empty()) {
+        error = "group '" + rule.name + "' has no patterns";
+        return false;
+    }
+
+    // Repeating a name adds patterns to the existing group
+    for (auto& existing : rules) {
+        if (existing.name == rule.name) {
+            existing.comm_patterns.insert(existing.comm_patterns.end(),
+                                          rule.comm_patterns.begin(), rule.comm_patterns.end());
+            existing.cmdline_patterns.insert(existing.cmdline_patterns.end(),
+                                             rule.cmdline_patterns.begin(), rule.cmdline_patterns.end());
+            return true;
+        }
+    }
+    rules.push_back(rule);
+    return true;
+}
+
+void AppGrouper::configure(const std::vector<AppGroupRule>& rules) {
+    group_names.clear();
+    comm_matcher.clear();
+    cmdline_matcher.clear();
+
+    // The group id is its position, so earlier groups win when several match
+    for (size_t i = 0; i < rules.size(); i++) {
+        group_names.push_back(rules[i].name);
+        for (const auto& pattern : rules[i].comm_patterns) {
+            comm_matcher.add(pattern, static_cast<int>(i));
+        }
+        for (const auto& pattern : rules[i].cmdline_patterns) {
+            cmdline_matcher.add(pattern, static_cast<int>(i));
+        }
+    }
+    comm_matcher.build();
+    cmdline_matcher.build();
+
+    members.clear();
+    have_previous = false;
+}
+
+// Configured group of a process not seen before, or -1
+int AppGrouper::classify(const Process& proc) const {
+    int group = comm_matcher.match(proc.name.data(), proc.name.size());
+    if (cmdline_matcher.empty() || group == 0) {
+        return group;
+    }
+
+    // The command line is read only for new processes, and only if any pattern needs it
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/%d/cmdline", proc.pid);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return group;
+    }
+    char cmdline[4096];
+    ssize_t len = read(fd, cmdline, sizeof(cmdline));
+    close(fd);
+    if (len <= 0) {
+        return group;
+    }
+
+    // Arguments are NUL-separated; match them as one space-separated line
+    std::replace(cmdline, cmdline + len, '\0', ' ');
+    int by_cmdline = cmdline_matcher.match(cmdline, static_cast<size_t>(len));
+    if (by_cmdline >= 0 && (group < 0 || by_cmdline < group)) {
+        group = by_cmdline;
+    }
+    return group;
+}
+
+void AppGrouper::update(const std::vector<Process>& processes) {
+    auto now = std::chrono::steady_clock::now();
+    double dt = have_previous ? std::chrono::duration<double>(now - last_update).count() : 0.0;
+    last_update = now;
+    have_previous = true;
+
+    for (auto& entry : members) {
+        entry.second.seen = false;
+    }
+
+    current.clear();
+    current.resize(group_names.size());
+    for (size_t i = 0; i < group_names.size(); i++) {
+        current[i].name = group_names[i];
+        current[i].configured = true;
+    }
+    std::unordered_map<std::string, size_t> by_name;
+
+    classified = 0;
+    for (const auto& proc : processes) {
+        auto found = members.find(proc.pid);
+        bool known = found != members.end() && found->second.start_time == proc.start_time;
+        Member& member = known ? found->second : members[proc.pid];
+        if (!known) {
+            // New process, or a reused PID
+            member.start_time = proc.start_time;
+            member.group = classify(proc);
+            member.read_bytes = proc.io_read_bytes;
+            member.write_bytes = proc.io_write_bytes;
+            classified++;
+        }
+        member.seen = true;
+
+        AppGroupStats* stats;
+        if (member.group >= 0) {
+            stats = &current[member.group];
+        } else {
+            auto slot = by_name.find(proc.name);
+            if (slot == by_name.end()) {
+                slot = by_name.insert(std::make_pair(proc.name, current.size())).first;
+                current.push_back(AppGroupStats());
+                current.back().name = proc.name;
+            }
+            stats = &current[slot->second];
+        }
+
+        stats->processes++;
+        stats->cpu_percent += proc.cpu_percent;
+        stats->mem_percent += proc.mem_percent;
+        stats->rss_kb += proc.rss_kb;
+        if (known && dt > 0) {
+            if (proc.io_read_bytes >= member.read_bytes) {
+                stats->read_bytes_per_s += (proc.io_read_bytes - member.read_bytes) / dt;
+            }
+            if (proc.io_write_bytes >= member.write_bytes) {
+                stats->write_bytes_per_s += (proc.io_write_bytes - member.write_bytes) / dt;
+            }
+        }
+        member.read_bytes = proc.io_read_bytes;
+        member.write_bytes = proc.io_write_bytes;
+    }
+
+    // Forget processes that exited
+    for (auto it = members.begin(); it != members.end();) {
+        if (it->second.seen) {
+            ++it;
+        } else {
+            it = members.erase(it);
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#include "../include/monitor.h"
+#include <algorithm>
+#include <cstdio>
+
+// Show or hide the per-application view
+void ActivityMonitor::toggleAppView() {
+    if (process_view == VIEW_APPS) {
+        setProcessView(VIEW_PROCESSES);
+        return;
+    }
+
+    // Groups are not updated while hidden, so the counters are stale: group
+    // right away and let I/O rates start from the next refresh
+    setProcessView(VIEW_APPS);
+    app_grouper.restartRates();
+    app_grouper.update(live_processes);
+}
+
+// Format a byte rate compactly ("12.3M/s")
+static std::string formatRate(double bytes_per_s) {
+    static const char* UNITS[] = {"B", "K", "M", "G"};
+    int unit = 0;
+    while (bytes_per_s >= 1024.0 && unit < 3) {
+        bytes_per_s /= 1024.0;
+        unit++;
+    }
+    char text[16];
+    snprintf(text, sizeof(text), unit == 0 ? "%.0f%s/s" : "%.1f%s/s", bytes_per_s, UNITS[unit]);
+    return text;
+}
+
+// Draw applications with the summed metrics of their processes
+void ActivityMonitor::displayAppGroups() {
+    screen->clear(process_win);
+    screen->box(process_win);
+
+    int height = process_win.height;
+    int width = process_win.width;
+    int text_width = std::max(0, width - 4);
+
+    // Follow the process list's sort key
+    std::vector<AppGroupStats> groups = app_grouper.groups();
+    bool by_memory = process_sort_type == 1;
+    std::sort(groups.begin(), groups.end(), [by_memory](const AppGroupStats& a, const AppGroupStats& b) {
+        return by_memory ? a.rss_kb > b.rss_kb : a.cpu_percent > b.cpu_percent;
+    });
+
+    char title[160];
+    snprintf(title, sizeof(title), " Applications: %d groups, %d processes cached, %d new ('c'/'m' sort, 'v' close) ",
+             static_cast<int>(groups.size()), static_cast<int>(app_grouper.cachedProcesses()),
+             static_cast<int>(app_grouper.lastClassified()));
+    screen->attrOn(process_win, COLOR_PAIR(5));
+    screen->print(process_win, 0, 2, "%s", std::string(title).substr(0, text_width).c_str());
+    screen->attrOff(process_win, COLOR_PAIR(5));
+
+    screen->attrOn(process_win, A_BOLD);
+    screen->print(process_win, 1, 2, "%-25s %6s %8s %8s %10s %10s %10s",
+                  "Application", "Procs", "CPU%", "Memory%", "RSS", "Read", "Write");
+    screen->attrOff(process_win, A_BOLD);
+
+    int rows = height - 3;
+    int total = static_cast<int>(groups.size());
+    view_offset = std::max(0, std::min(view_offset, total - rows));
+
+    for (int row = 0; row < rows && view_offset + row < total; row++) {
+        const AppGroupStats& group = groups[view_offset + row];
+
+        // Configured groups stand out from the per-name fallback groups
+        int color = group.cpu_percent > config.cpu_threshold / 2 ? 3 : (group.configured ? 4 : 1);
+        screen->attrOn(process_win, COLOR_PAIR(color));
+        std::string name = group.name.length() > 25 ? group.name.substr(0, 22) + "..." : group.name;
+        screen->print(process_win, row + 2, 2, "%-25s %6d %7.1f%% %7.1f%% %10s %10s %10s",
+                      name.c_str(), group.processes, group.cpu_percent, group.mem_percent,
+                      formatSize(group.rss_kb).c_str(), formatRate(group.read_bytes_per_s).c_str(),
+                      formatRate(group.write_bytes_per_s).c_str());
+        screen->attrOff(process_win, COLOR_PAIR(color));
+    }
+
+    screen->refresh(process_win);
+}
@@ -0,0 +1,135 @@
+#include "../include/asrmt.h"
+#include "../include/collector.h"
+#include <memory>
+#include <new>
+#include <stdexcept>
+
+// The C handles wrap the C++ core; no exception may cross the C boundary
+struct asrmt_sampler {
+    SystemCollector collector;
+    std::string error;
+};
+
+struct asrmt_snapshot {
+    Snapshot data;
+};
+
+int asrmt_api_version(void) {
+    return ASRMT_API_VERSION;
+}
+
+asrmt_sampler* asrmt_sampler_create(void) {
+    asrmt_sampler* sampler = new (std::nothrow) asrmt_sampler();
+    if (sampler == nullptr) {
+        return nullptr;
+    }
+    try {
+        // Baseline for the CPU usage of the first snapshot
+        sampler->collector.updateCPUInfo();
+    } catch (const std::exception&) {
+        delete sampler;
+        return nullptr;
+    }
+    return sampler;
+}
+
+void asrmt_sampler_destroy(asrmt_sampler* sampler) {
+    delete sampler;
+}
+
+const char* asrmt_sampler_error(const asrmt_sampler* sampler) {
+    return sampler != nullptr ? sampler->error.c_str() : "no sampler";
+}
+
+asrmt_snapshot* asrmt_snapshot_take(asrmt_sampler* sampler) {
+    if (sampler == nullptr) {
+        return nullptr;
+    }
+
+    try {
+        sampler->collector.collect();
+        // Owned here until the copy succeeds, so a failed copy does not leak it
+        std::unique_ptr<asrmt_snapshot> snapshot(new asrmt_snapshot());
+        sampler->collector.snapshot(snapshot->data);
+        sampler->error.clear();
+        return snapshot.release();
+    } catch (const std::bad_alloc&) {
+        sampler->error = "out of memory";
+    } catch (const std::exception& e) {
+        sampler->error = e.what();
+    }
+    return nullptr;
+}
+
+void asrmt_snapshot_free(asrmt_snapshot* snapshot) {
+    delete snapshot;
+}
+
+long long asrmt_snapshot_time(const asrmt_snapshot* snapshot) {
+    return static_cast<long long>(snapshot->data.taken_at);
+}
+
+void asrmt_snapshot_cpu(const asrmt_snapshot* snapshot, asrmt_cpu* out) {
+    out->total_percent = snapshot->data.cpu.total_usage;
+    out->num_cores = snapshot->data.cpu.num_cores;
+}
+
+double asrmt_snapshot_core_percent(const asrmt_snapshot* snapshot, int core) {
+    const std::vector<float>& cores = snapshot->data.cpu.core_usage;
+    if (core < 0 || core >= static_cast<int>(cores.size())) {
+        return -1.0;
+    }
+    return cores[core];
+}
+
+void asrmt_snapshot_memory(const asrmt_snapshot* snapshot, asrmt_memory* out) {
+    const MemoryInfo& memory = snapshot->data.memory;
+    out->total_kb = memory.total;
+    out->free_kb = memory.free;
+    out->available_kb = memory.available;
+    out->used_kb = memory.used;
+    out->cached_kb = memory.cached;
+    out->buffers_kb = memory.buffers;
+    out->swap_total_kb = memory.swap_total;
+    out->swap_used_kb = memory.swap_used;
+    out->percent_used = memory.percent_used;
+    out->swap_percent_used = memory.swap_percent_used;
+}
+
+size_t asrmt_snapshot_disk_count(const asrmt_snapshot* snapshot) {
+    return snapshot->data.disks.size();
+}
+
+int asrmt_snapshot_disk(const asrmt_snapshot* snapshot, size_t index, asrmt_disk* out) {
+    if (index >= snapshot->data.disks.size()) {
+        return -1;
+    }
+    const DiskInfo& disk = snapshot->data.disks[index];
+    out->device = disk.device.c_str();
+    out->mount_point = disk.mount_point.c_str();
+    out->total_kb = disk.total_space;
+    out->used_kb = disk.used_space;
+    out->free_kb = disk.free_space;
+    out->percent_used = disk.percent_used;
+    return 0;
+}
+
+size_t asrmt_snapshot_process_count(const asrmt_snapshot* snapshot) {
+    return snapshot->data.processes.size();
+}
+
+int asrmt_snapshot_process(const asrmt_snapshot* snapshot, size_t index, asrmt_process* out) {
+    if (index >= snapshot->data.processes.size()) {
+        return -1;
+    }
+    const Process& proc = snapshot->data.processes[index];
+    out->pid = proc.pid;
+    out->name = proc.name.c_str();
+    out->cpu_percent = proc.cpu_percent;
+    out->mem_percent = proc.mem_percent;
+    out->rss_kb = proc.rss_kb;
+    out->start_time = proc.start_time;
+    out->io_read_bytes = proc.io_read_bytes;
+    out->io_write_bytes = proc.io_write_bytes;
+    return 0;
+}
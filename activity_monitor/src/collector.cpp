@@ -0,0 +1,550 @@
+#include "../include/collector.h"
+#include "../include/trace.h"
+#include <fstream>
+#include <sstream>
+#include <dirent.h>
+#include <cctype>
+#include <stdexcept>
+#include <unordered_map>
+#include <algorithm>
+#include <ctime>
+#include <unistd.h>
+#include <sys/statvfs.h>
+
+// All-zero previous times: the next delta is everything counted since boot
+void bootCPUBaseline(std::vector<CPUTimeInfo>& curr_cpu_times) {
+    CPUTimeInfo zero = {};
+    long cpus = sysconf(_SC_NPROCESSORS_CONF);
+    curr_cpu_times.assign(static_cast<size_t>(std::max(cpus, 1L)) + 1, zero);
+}
+
+// Update CPU information by reading /proc/stat
+void readCPUInfo(CPUInfo& cpu_info, std::vector<CPUTimeInfo>& prev_cpu_times,
+                 std::vector<CPUTimeInfo>& curr_cpu_times) {
+    TraceSpan span("collect", "updateCPUInfo");
+    std::ifstream stat_file("/proc/stat");
+    if (!stat_file.is_open()) {
+        throw std::runtime_error("Failed to open /proc/stat");
+    }
+    
+    // Store previous CPU times for calculation
+    prev_cpu_times = curr_cpu_times;
+    curr_cpu_times.clear();
+    
+    std::string line;
+    size_t core_count = 0;
+    std::vector<float> core_percentages;
+    
+    while (std::getline(stat_file, line)) {
+        if (line.substr(0, 3) == "cpu") {
+            std::istringstream iss(line);
+            std::string cpu_label;
+            iss >> cpu_label;
+            
+            // Parse CPU times
+            CPUTimeInfo cpu_time;
+            iss >> cpu_time.user >> cpu_time.nice >> cpu_time.system >> cpu_time.idle 
+                >> cpu_time.iowait >> cpu_time.irq >> cpu_time.softirq >> cpu_time.steal;
+            
+            // Add this CPU time info to our current dataset
+            curr_cpu_times.push_back(cpu_time);
+            
+            // If we have previous data, calculate CPU usage percentage
+            if (!prev_cpu_times.empty() && prev_cpu_times.size() > core_count) {
+                const CPUTimeInfo& prev = prev_cpu_times[core_count];
+                const CPUTimeInfo& curr = cpu_time;
+                
+                // Calculate the deltas
+                unsigned long total_delta = curr.total() - prev.total();
+                unsigned long idle_delta = curr.idle_time() - prev.idle_time();
+                
+                if (total_delta > 0) {
+                    // The formula: CPU usage = 100% - (idle_delta / total_delta * 100%)
+                    float cpu_percentage = 100.0f * (1.0f - static_cast<float>(idle_delta) / total_delta);
+                    
+                    // For the first line (total CPU), update total_usage
+                    if (cpu_label == "cpu") {
+                        cpu_info.total_usage = cpu_percentage;
+                    } else {
+                        core_percentages.push_back(cpu_percentage);
+                    }
+                }
+            }
+            
+            core_count++;
+        } else if (line.substr(0, 4) != "cpu") {
+            // If we've processed all CPU lines, break
+            break;
+        }
+    }
+    
+    // Update core count and usage data
+    cpu_info.num_cores = static_cast<int>(core_count) - 1;  // Subtract 1 for the total "cpu" line
+    cpu_info.core_usage = core_percentages;
+}
+
+// Update memory information by reading /proc/meminfo
+void readMemoryInfo(MemoryInfo& memory_info) {
+    TraceSpan span("collect", "updateMemoryInfo");
+    std::ifstream meminfo_file("/proc/meminfo");
+    if (!meminfo_file.is_open()) {
+        throw std::runtime_error("Failed to open /proc/meminfo");
+    }
+    
+    std::string line;
+    unsigned long mem_total = 0, mem_free = 0, mem_available = 0;
+    unsigned long swap_total = 0, swap_free = 0;
+    unsigned long cached = 0, buffers = 0;
+    unsigned long anon_huge = 0, shmem_huge = 0, hugepage_size = 0;
+    unsigned long hugepages_total = 0, hugepages_free = 0, hugepages_rsvd = 0, hugepages_surp = 0;
+    
+    while (std::getline(meminfo_file, line)) {
+        std::istringstream iss(line);
+        std::string key;
+        unsigned long value;
+        std::string unit;
+        
+        iss >> key >> value >> unit;
+        
+        if (key == "MemTotal:") {
+            mem_total = value;
+        } else if (key == "MemFree:") {
+            mem_free = value;
+        } else if (key == "MemAvailable:") {
+            mem_available = value;
+        } else if (key == "SwapTotal:") {
+            swap_total = value;
+        } else if (key == "SwapFree:") {
+            swap_free = value;
+        } else if (key == "Cached:") {
+            cached = value;
+        } else if (key == "Buffers:") {
+            buffers = value;
+        } else if (key == "AnonHugePages:") {
+            anon_huge = value;
+        } else if (key == "ShmemHugePages:") {
+            shmem_huge = value;
+        } else if (key == "HugePages_Total:") {
+            hugepages_total = value;
+        } else if (key == "HugePages_Free:") {
+            hugepages_free = value;
+        } else if (key == "HugePages_Rsvd:") {
+            hugepages_rsvd = value;
+        } else if (key == "HugePages_Surp:") {
+            hugepages_surp = value;
+        } else if (key == "Hugepagesize:") {
+            hugepage_size = value;
+        }
+    }
+    
+    // Calculate used memory and percentages
+    unsigned long mem_used = mem_total - mem_available;
+    float mem_percent = (mem_total > 0) ? (100.0f * mem_used / mem_total) : 0.0f;
+    
+    unsigned long swap_used = swap_total - swap_free;
+    float swap_percent = (swap_total > 0) ? (100.0f * swap_used / swap_total) : 0.0f;
+    
+    // Update memory info structure
+    memory_info.total = mem_total;
+    memory_info.free = mem_free;
+    memory_info.available = mem_available;
+    memory_info.used = mem_used;
+    memory_info.percent_used = mem_percent;
+    
+    memory_info.swap_total = swap_total;
+    memory_info.swap_free = swap_free;
+    memory_info.swap_used = swap_used;
+    memory_info.swap_percent_used = swap_percent;
+    
+    memory_info.cached = cached;
+    memory_info.buffers = buffers;
+    
+    memory_info.anon_huge_kb = anon_huge;
+    memory_info.shmem_huge_kb = shmem_huge;
+    memory_info.hugepages_total = hugepages_total;
+    memory_info.hugepages_free = hugepages_free;
+    memory_info.hugepages_rsvd = hugepages_rsvd;
+    memory_info.hugepages_surp = hugepages_surp;
+    memory_info.hugepage_size_kb = hugepage_size;
+}
+
+// Update disk information using statvfs
+void readDiskInfo(std::vector<DiskInfo>& disk_info) {
+    TraceSpan span("collect", "updateDiskInfo");
+    // Read /proc/mounts to get mounted filesystems
+    std::ifstream mounts_file("/proc/mounts");
+    if (!mounts_file.is_open()) {
+        throw std::runtime_error("Failed to open /proc/mounts");
+    }
+    
+    disk_info.clear();
+    
+    std::string line;
+    while (std::getline(mounts_file, line)) {
+        std::istringstream iss(line);
+        std::string device, mount_point, fs_type, options;
+        int dump, pass;
+        
+        iss >> device >> mount_point >> fs_type >> options >> dump >> pass;
+        
+        // Skip non-physical filesystems
+        if (fs_type == "proc" || fs_type == "sysfs" || fs_type == "devpts" || 
+            fs_type == "tmpfs" || fs_type == "devtmpfs" || fs_type == "debugfs" ||
+            mount_point.substr(0, 4) == "/sys" || mount_point.substr(0, 5) == "/proc" ||
+            mount_point.substr(0, 4) == "/dev" || mount_point.substr(0, 4) == "/run") {
+            continue;
+        }
+        
+        // Get disk usage information
+        struct statvfs stat;
+        if (statvfs(mount_point.c_str(), &stat) != 0) {
+            continue;  // Skip if we can't get stats
+        }
+        
+        DiskInfo info;
+        info.device = device;
+        info.mount_point = mount_point;
+        info.read_latency_ms = -1.0f;
+        info.io_operations = 0;
+        
+        // Calculate sizes in KB
+        const unsigned long block_size = stat.f_frsize;
+        info.total_space = (stat.f_blocks * block_size) / 1024;
+        info.free_space = (stat.f_bfree * block_size) / 1024;
+        info.used_space = info.total_space - info.free_space;
+        
+        // Calculate percentage
+        if (info.total_space > 0) {
+            info.percent_used = 100.0f * static_cast<float>(info.used_space) / info.total_space;
+        } else {
+            info.percent_used = 0.0f;
+        }
+        
+        disk_info.push_back(info);
+    }
+}
+
+// Update process information by scanning /proc directory
+void readProcessInfo(std::vector<Process>& process_list, int num_cores, unsigned long total_memory,
+                     bool detail, const CollectorLogger& logger) {
+    TraceSpan span("collect", "updateProcessInfo");
+    
+    // Without detail the tier-2 counters come from the previous scan
+    std::vector<Process> previous;
+    size_t previous_index = 0;
+    if (!detail) {
+        previous.swap(process_list);
+        process_list.reserve(previous.size());
+    }
+    process_list.clear();
+    
+    // Open the /proc directory
+    DIR* proc_dir = opendir("/proc");
+    if (proc_dir == nullptr) {
+        throw std::runtime_error("Failed to open /proc directory");
+    }
+    
+    struct dirent* entry;
+    while ((entry = readdir(proc_dir)) != nullptr) {
+        // Check if the entry is a directory and name is a number (PID)
+        if (entry->d_type == DT_DIR) {
+            std::string name = entry->d_name;
+            bool is_pid = true;
+            for (char c : name) {
+                if (!std::isdigit(c)) {
+                    is_pid = false;
+                    break;
+                }
+            }
+            
+            if (!is_pid) {
+                continue;
+            }
+            
+            int pid = std::stoi(name);
+            
+            // Get process status
+            std::string status_path = "/proc/" + name + "/status";
+            std::ifstream status_file(status_path);
+            if (!status_file.is_open()) {
+                continue;  // Process might have terminated
+            }
+            
+            Process proc;
+            proc.pid = pid;
+            proc.name = "unknown";
+            proc.cpu_percent = 0.0f;
+            proc.mem_percent = 0.0f;
+            proc.rss_kb = 0;
+            proc.start_time = 0;
+            proc.io_read_bytes = 0;
+            proc.io_write_bytes = 0;
+            proc.cpu_ticks = 0;
+            proc.major_faults = 0;
+            proc.run_delay_ns = 0;
+            proc.uid = -1;
+            proc.pressure = 0.0f;
+            
+            // Read status file
+            std::string line;
+            unsigned long vm_rss = 0;
+            
+            while (std::getline(status_file, line)) {
+                if (line.compare(0, 5, "Name:") == 0) {
+                    proc.name = line.substr(6);
+                    // Trim whitespace
+                    proc.name.erase(0, proc.name.find_first_not_of(" \t"));
+                    proc.name.erase(proc.name.find_last_not_of(" \t") + 1);
+                } else if (line.compare(0, 4, "Uid:") == 0) {
+                    proc.uid = std::stoi(line.substr(4));
+                } else if (line.compare(0, 6, "VmRSS:") == 0) {
+                    std::istringstream iss(line.substr(6));
+                    iss >> vm_rss;
+                }
+            }
+            
+            proc.rss_kb = vm_rss;
+            
+            // Calculate memory percentage
+            if (total_memory > 0) {
+                proc.mem_percent = 100.0f * static_cast<float>(vm_rss) / total_memory;
+            }
+            
+            // Read process stat for CPU usage
+            std::string stat_path = "/proc/" + name + "/stat";
+            std::ifstream stat_file(stat_path);
+            if (stat_file.is_open()) {
+                std::string content;
+                std::getline(stat_file, content);
+                
+                // Skip PID and name fields; the name may contain spaces, so
+                // parse from the last ')'
+                size_t name_end = content.rfind(')');
+                std::istringstream iss(name_end != std::string::npos ? content.substr(name_end + 1) : content);
+                
+                // Skip to majflt (field 12), then utime and stime (fields 14 and 15)
+                std::string dummy;
+                for (int i = 0; i < 9; i++) {
+                    iss >> dummy;
+                }
+                iss >> proc.major_faults >> dummy;
+                
+                unsigned long utime = 0, stime = 0;
+                iss >> utime >> stime;
+                
+                // Skip to starttime (field 22)
+                for (int i = 0; i < 6; i++) {
+                    iss >> dummy;
+                }
+                iss >> proc.start_time;
+                
+                // Simple approximation of CPU usage
+                // This isn't completely accurate but gives a rough estimate
+                // For better accuracy, we'd need to track process CPU time between updates
+                unsigned long total_time = utime + stime;
+                proc.cpu_ticks = total_time;
+                proc.cpu_percent = 0.1f * total_time / (num_cores * 100.0f);
+                
+                if (logger) {
+                    logger("Process " + std::to_string(proc.pid) + " (" + proc.name + ") CPU calculation:");
+                    logger("  utime: " + std::to_string(utime) + ", stime: " + std::to_string(stime));
+                    logger("  total_time: " + std::to_string(total_time));
+                    logger("  num_cores: " + std::to_string(num_cores));
+                    logger("  cpu_percent: " + std::to_string(proc.cpu_percent));
+                }
+            }
+            
+            if (detail) {
+                // Read storage I/O counters (only readable for our own processes unless root)
+                std::ifstream io_file("/proc/" + name + "/io");
+                if (io_file.is_open()) {
+                    while (std::getline(io_file, line)) {
+                        if (line.compare(0, 11, "read_bytes:") == 0) {
+                            proc.io_read_bytes = std::stoull(line.substr(11));
+                        } else if (line.compare(0, 12, "write_bytes:") == 0) {
+                            proc.io_write_bytes = std::stoull(line.substr(12));
+                        }
+                    }
+                }
+                
+                // Run-queue wait: the second of cpu time, run delay and timeslices
+                std::ifstream schedstat_file("/proc/" + name + "/schedstat");
+                unsigned long long on_cpu_ns = 0;
+                schedstat_file >> on_cpu_ns >> proc.run_delay_ns;
+            } else {
+                // /proc lists PIDs in ascending order, so the previous scan is walked alongside
+                while (previous_index < previous.size() && previous[previous_index].pid < pid) {
+                    previous_index++;
+                }
+                if (previous_index < previous.size() && previous[previous_index].pid == pid &&
+                    previous[previous_index].start_time == proc.start_time) {
+                    const Process& before = previous[previous_index];
+                    proc.io_read_bytes = before.io_read_bytes;
+                    proc.io_write_bytes = before.io_write_bytes;
+                    proc.run_delay_ns = before.run_delay_ns;
+                }
+            }
+            
+            // Add process to list
+            process_list.push_back(proc);
+        }
+    }
+    
+    closedir(proc_dir);
+}
+
+// Update memory cache hit rates and latency metrics
+void readMemoryStats(MemoryInfo& memory_info, const CollectorLogger& logger) {
+    TraceSpan span("collect", "updateMemoryStats");
+    // Cached and buffers come from /proc/meminfo (already read in updateMemoryInfo);
+    // THP and compaction events from /proc/vmstat, in one pass
+    std::ifstream vmstat_file("/proc/vmstat");
+    if (vmstat_file.is_open()) {
+        unsigned long long fault_alloc = 0, fault_fallback = 0, collapse_alloc = 0;
+        unsigned long long stall = 0, fail = 0;
+        std::string line;
+        while (std::getline(vmstat_file, line)) {
+            std::istringstream iss(line);
+            std::string key;
+            unsigned long long value = 0;
+            
+            iss >> key >> value;
+            
+            if (key == "thp_fault_alloc") {
+                fault_alloc = value;
+            } else if (key == "thp_fault_fallback") {
+                fault_fallback = value;
+            } else if (key == "thp_collapse_alloc") {
+                collapse_alloc = value;
+            } else if (key == "compact_stall") {
+                stall = value;
+            } else if (key == "compact_fail") {
+                fail = value;
+            }
+        }
+        
+        // Rates against the counters of the previous read, still in memory_info
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double read_at = now.tv_sec + now.tv_nsec / 1e9;
+        double dt = memory_info.vmstat_read_at > 0.0 ? read_at - memory_info.vmstat_read_at : 0.0;
+        auto rate = [dt](unsigned long long value, unsigned long long last) {
+            return dt > 0.0 && value >= last ? static_cast<float>((value - last) / dt) : 0.0f;
+        };
+        memory_info.thp_fault_alloc_rate = rate(fault_alloc, memory_info.thp_fault_alloc);
+        memory_info.thp_fault_fallback_rate = rate(fault_fallback, memory_info.thp_fault_fallback);
+        memory_info.thp_collapse_alloc_rate = rate(collapse_alloc, memory_info.thp_collapse_alloc);
+        memory_info.compact_stall_rate = rate(stall, memory_info.compact_stall);
+        memory_info.compact_fail_rate = rate(fail, memory_info.compact_fail);
+        
+        memory_info.thp_fault_alloc = fault_alloc;
+        memory_info.thp_fault_fallback = fault_fallback;
+        memory_info.thp_collapse_alloc = collapse_alloc;
+        memory_info.compact_stall = stall;
+        memory_info.compact_fail = fail;
+        memory_info.vmstat_read_at = read_at;
+    }
+    
+    // Calculate cache hit rate - this is a simplified approximation
+    // In a real system, this would come from performance counters
+    if (memory_info.total > 0) {
+        // Calculate cached memory percentage
+        float cache_percentage = 100.0f * (memory_info.cached + memory_info.buffers) / memory_info.total;
+        
+        // Simulate cache hit rate based on cache size (simplified model)
+        // More cache generally means higher hit rates
+        memory_info.cache_hit_rate = 70.0f + (cache_percentage * 0.25f);
+        
+        // Cap at 99% maximum hit rate
+        if (memory_info.cache_hit_rate > 99.0f) {
+            memory_info.cache_hit_rate = 99.0f;
+        }
+    } else {
+        memory_info.cache_hit_rate = -1.0f;
+    }
+    
+    // Estimate memory latency - this would ideally come from hardware counters
+    // For simulation purposes, we're generating a realistic value
+    // Typical DDR4 memory latency is around 60-100ns
+    memory_info.latency_ns = 60.0f + (40.0f * memory_info.percent_used / 100.0f);
+    
+    if (logger) {
+        logger("Memory cache hit rate: " + std::to_string(memory_info.cache_hit_rate) + "%");
+        logger("Memory latency: " + std::to_string(memory_info.latency_ns) + " ns");
+        logger("THP faults/s: " + std::to_string(memory_info.thp_fault_alloc_rate) + ", fallbacks/s: " +
+               std::to_string(memory_info.thp_fault_fallback_rate) + ", compaction stalls/s: " +
+               std::to_string(memory_info.compact_stall_rate));
+    }
+}
+
+// Only the AnonHugePages line is needed; the rollup is one small read
+unsigned long readAnonHugePages(int pid) {
+    std::ifstream rollup("/proc/" + std::to_string(pid) + "/smaps_rollup");
+    std::string line;
+    while (std::getline(rollup, line)) {
+        if (line.compare(0, 14, "AnonHugePages:") == 0) {
+            return std::stoul(line.substr(14));
+        }
+    }
+    return 0;
+}
+
+// Update disk I/O and latency metrics
+void readDiskLatency(std::vector<DiskInfo>& disk_info, const CollectorLogger& logger) {
+    TraceSpan span("collect", "updateDiskLatency");
+    // Read disk stats from /proc/diskstats
+    std::ifstream diskstats_file("/proc/diskstats");
+    if (!diskstats_file.is_open()) {
+        if (logger) {
+            logger("Failed to open /proc/diskstats");
+        }
+        return;
+    }
+    
+    // Create a map for easier lookup of disk information by device name
+    std::unordered_map<std::string, DiskInfo*> disk_lookup;
+    for (auto& disk : disk_info) {
+        // Extract the device name without path (e.g., "sda1" from "/dev/sda1")
+        size_t pos = disk.device.rfind('/');
+        std::string dev_name = (pos != std::string::npos) ? disk.device.substr(pos + 1) : disk.device;
+        disk_lookup[dev_name] = &disk;
+        
+        // Initialize latency metrics
+        disk.read_latency_ms = -1.0f;
+    }
+    
+    // Parse disk stats
+    std::string line;
+    while (std::getline(diskstats_file, line)) {
+        std::istringstream iss(line);
+        int major, minor;
+        std::string dev_name;
+        unsigned long reads, reads_merged, sectors_read, read_ms;
+        unsigned long writes, writes_merged, sectors_written, write_ms;
+        unsigned long ios_in_progress, io_ms, weighted_io_ms;
+        
+        // Parse disk stats line
+        iss >> major >> minor >> dev_name 
+            >> reads >> reads_merged >> sectors_read >> read_ms
+            >> writes >> writes_merged >> sectors_written >> write_ms
+            >> ios_in_progress >> io_ms >> weighted_io_ms;
+        
+        // Check if this device is one we're monitoring
+        if (disk_lookup.find(dev_name) != disk_lookup.end()) {
+            DiskInfo* disk = disk_lookup[dev_name];
+            
+            // Calculate latency metrics
+            if (reads > 0) {
+                disk->read_latency_ms = static_cast<float>(read_ms) / reads;
+            }
+            
+            // Store total I/O operations
+            disk->io_operations = reads + writes;
+            
+            if (logger) {
+                logger("Disk " + dev_name + " read latency: " + std::to_string(disk->read_latency_ms) + " ms");
+                logger("Disk " + dev_name + " I/O operations: " + std::to_string(disk->io_operations));
+            }
+        }
+    }
+}
@@ -0,0 +1,352 @@
+#include "../include/daemon.h"
+#include "../include/notify.h"
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+// Minimum seconds between desktop notifications of the same kernel event type
+static const int KERNEL_NOTIFY_INTERVAL = 10;
+
+// Seconds before an unchanged CPU alert is repeated
+static const int CPU_ALERT_REPEAT = 60;
+
+// Set from the signal handler; checked once per wakeup
+static volatile sig_atomic_t stop_requested = 0;
+
+static void handleStopSignal(int) {
+    stop_requested = 1;
+}
+
+// Milliseconds since this process was started, from its start time in /proc
+static double msSinceProcessStart() {
+    std::ifstream file("/proc/self/stat");
+    std::string line;
+    if (!std::getline(file, line)) {
+        return 0.0;
+    }
+
+    // Fields after the parenthesised command name; starttime is field 22
+    size_t close_paren = line.rfind(')');
+    if (close_paren == std::string::npos) {
+        return 0.0;
+    }
+    std::istringstream fields(line.substr(close_paren + 2));
+    std::string field;
+    unsigned long long start_ticks = 0;
+    for (int i = 3; i <= 22 && fields >> field; i++) {
+        if (i == 22) {
+            start_ticks = std::stoull(field);
+        }
+    }
+
+    struct timespec boot_now;
+    clock_gettime(CLOCK_BOOTTIME, &boot_now);
+    double now_ms = boot_now.tv_sec * 1000.0 + boot_now.tv_nsec / 1e6;
+    return now_ms - start_ticks * 1000.0 / sysconf(_SC_CLK_TCK);
+}
+
+MonitorDaemon::MonitorDaemon()
+    : started(std::chrono::steady_clock::now()) {
+}
+
+void MonitorDaemon::setConfig(const DaemonConfig& new_config) {
+    config = new_config;
+    history.setCapacity(config.history_size);
+    watchdog.setBudget(config.refresh_rate_ms);
+    overhead.configure(config.cpu_budget_percent, config.refresh_rate_ms, false);
+    flight_recorder.configure(config.flight_dir, config.flight_max_per_hour);
+
+    if (config.kernel_log && !kernel_log.open()) {
+        log("WARN", "Cannot read /dev/kmsg: " + kernel_log.error() + "; kernel events are not watched");
+    }
+
+    // The process log needs the process scan of this build
+    if (!config.process_log_path.empty()) {
+        if (!DaemonCollector::has(FEATURE_PROCESSES)) {
+            throw std::runtime_error("--process-log needs a build with FEATURES including PROCESSES");
+        }
+        std::string error;
+        if (!process_log.open(config.process_log_path, true, error)) {
+            throw std::runtime_error("Cannot open process log: " + error);
+        }
+    }
+
+    // Baseline for the CPU usage of the first collection
+    collector.updateCPUInfo();
+}
+
+// Read everything the watchdog allows; the history is only kept for the flight recorder
+void MonitorDaemon::collect() {
+    auto start = std::chrono::steady_clock::now();
+    TickPlan plan = watchdog.plan();
+    collector.setProcessDetail(plan.process_detail && overhead.settings().process_detail);
+    collector.collect(plan.scan_processes);
+    if (plan.scan_processes && process_log.isWritable()) {
+        process_log.update(collector.processes());
+        if (!process_log.isWritable()) {
+            log("WARN", "Process log: " + process_log.error() + "; no more records are written");
+        }
+    }
+    if (flight_recorder.enabled() && plan.record_history) {
+        history.push(collector.cpu(), collector.memory(), collector.disks(), collector.processes());
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    int before = watchdog.level();
+    if (watchdog.record(ms)) {
+        std::ostringstream oss;
+        oss << "Collection took " << std::fixed << std::setprecision(1) << ms << " ms of "
+            << watchdog.budget() << " ms; ";
+        if (watchdog.level() > before) {
+            oss << "degraded to level " << watchdog.level() << " (" << TickWatchdog::levelName(watchdog.level()) << ")";
+        } else if (watchdog.degraded()) {
+            oss << "restored to level " << watchdog.level() << " (" << TickWatchdog::levelName(watchdog.level()) << ")";
+        } else {
+            oss << "full fidelity restored";
+        }
+        log(watchdog.level() > before ? "WARN" : "INFO", oss.str() + "; " + watchdog.summary());
+    }
+}
+
+// Own overhead and reduced settings, for flight recorder dumps; empty when neither applies
+std::string MonitorDaemon::monitorState() const {
+    std::string state = overhead.enabled() ? overhead.describe() : "";
+    if (watchdog.stats().overruns > 0) {
+        state += (state.empty() ? "" : "; ") + std::string("refresh level ") + std::to_string(watchdog.level()) +
+                 " (" + TickWatchdog::levelName(watchdog.level()) + "), " + watchdog.summary();
+    }
+    return state;
+}
+
+// The collector does not sort, so find the top CPU user directly
+const Process* MonitorDaemon::topCpuProcess() const {
+    if (!DaemonCollector::has(FEATURE_PROCESSES)) {
+        return nullptr;
+    }
+    const std::vector<Process>& processes = collector.processes();
+    auto top = std::max_element(processes.begin(), processes.end(),
+                                [](const Process& a, const Process& b) { return a.cpu_percent < b.cpu_percent; });
+    return top == processes.end() ? nullptr : &*top;
+}
+
+// Same rules as the TUI: alert over the threshold, pre-warn above 80% of it
+void MonitorDaemon::checkCpuAlerts() {
+    if (!DaemonCollector::has(FEATURE_CPU)) {
+        return;
+    }
+    float usage = collector.cpu().total_usage;
+    bool should_warn = usage > config.cpu_threshold;
+    bool should_pre_warn = !should_warn && usage > config.cpu_threshold * 0.8f;
+
+    auto now = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - last_notification).count();
+    bool state_changed = (should_warn != warning_state) || (should_pre_warn != pre_warning_state);
+
+    if (state_changed || (elapsed >= CPU_ALERT_REPEAT && (should_warn || should_pre_warn))) {
+        const Process* top = topCpuProcess();
+        int top_pid = top != nullptr ? top->pid : -1;
+
+        std::ostringstream title;
+        title << std::fixed << std::setprecision(1) << usage << "% (threshold " << config.cpu_threshold << "%)";
+        std::ostringstream message;
+        if (top != nullptr) {
+            message << "highest CPU process " << top->pid << " (" << top->name << ") using "
+                    << std::fixed << std::setprecision(1) << top->cpu_percent << "% CPU";
+        }
+
+        if (should_warn) {
+            alert("ALERT", "CPU usage critical: " + title.str(), message.str(), true, top_pid);
+            last_notification = now;
+        } else if (should_pre_warn) {
+            alert("WARN", "CPU usage warning: " + title.str(), message.str(), false, top_pid);
+            last_notification = now;
+        } else if (warning_state || pre_warning_state) {
+            log("INFO", "CPU usage back to " + title.str());
+        }
+
+        // Dump once per crossing, like the TUI
+        if (should_warn && !warning_state && flight_recorder.enabled()) {
+            if (!flight_recorder.trigger("CPU usage critical: " + title.str(), history,
+                                         FlightRecorder::capturePids(collector.processes(), -1), monitorState())) {
+                log("INFO", "Flight recorder dump skipped, one in progress or hourly cap reached");
+            }
+        }
+    }
+
+    warning_state = should_warn;
+    pre_warning_state = should_pre_warn;
+}
+
+// Log every new kernel event; critical ones also go to the flight recorder
+void MonitorDaemon::pollKernelLog() {
+    size_t added = kernel_log.poll();
+    size_t available = std::min(added, kernel_log.eventCount());
+
+    for (size_t i = available; i > 0; i--) {
+        const KernelEvent& event = kernel_log.event(i - 1);
+        if (event.historical) {
+            continue;
+        }
+
+        bool critical = KernelLogTap::isCritical(event.type);
+        std::string target;
+        if (event.pid >= 0) {
+            target = "PID " + std::to_string(event.pid) + " (" + event.subject + ")";
+        } else {
+            target = event.subject;
+        }
+
+        std::string title = std::string("Kernel: ") + KernelLogTap::typeName(event.type);
+        std::string message = (target.empty() ? "" : target + ": ") + event.message;
+        time_t now = time(nullptr);
+        bool notify = now - kernel_notified_at[event.type] >= KERNEL_NOTIFY_INTERVAL;
+        if (notify) {
+            kernel_notified_at[event.type] = now;
+        }
+
+        log(critical ? "ALERT" : "WARN", title + ": " + message);
+        if (notify && config.desktop_notifications) {
+            sendDesktopNotification(title, message, critical);
+        }
+        if (critical && flight_recorder.enabled()) {
+            flight_recorder.trigger(title + (target.empty() ? "" : ": " + target), history,
+                                    FlightRecorder::capturePids(collector.processes(), event.pid), monitorState());
+        }
+    }
+}
+
+// Send an alert to the log and the optional desktop notifier
+void MonitorDaemon::alert(const std::string& level, const std::string& title, const std::string& message,
+                          bool critical, int pid) {
+    std::string line = message.empty() ? title : title + "; " + message;
+    if (pid > 0) {
+        line += " [pid " + std::to_string(pid) + "]";
+    }
+    log(level, line);
+
+    if (config.desktop_notifications) {
+        sendDesktopNotification(title, message, critical);
+    }
+}
+
+// One timestamped line per message; stdout is line-buffered for journald
+void MonitorDaemon::log(const std::string& level, const std::string& message) {
+    time_t now = time(nullptr);
+    struct tm local;
+    localtime_r(&now, &local);
+    char stamp[32];
+    strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+    std::cout << stamp << " " << level << " " << message << std::endl;
+}
+
+void MonitorDaemon::run() {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handleStopSignal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    collect();
+    first_collection_ms = msSinceProcessStart();
+
+    std::ostringstream oss;
+    oss << "activity_monitord started: refresh " << config.refresh_rate_ms << " ms, CPU threshold "
+        << config.cpu_threshold << "%, kernel log " << (kernel_log.isOpen() ? "on" : "off")
+        << ", flight recorder " << (flight_recorder.enabled() ? config.flight_dir : "off")
+        << ", metrics" << (DaemonCollector::has(FEATURE_CPU) ? " cpu" : "")
+        << (DaemonCollector::has(FEATURE_MEMORY) ? " memory" : "")
+        << (DaemonCollector::has(FEATURE_DISKS) ? " disks" : "")
+        << (DaemonCollector::has(FEATURE_PROCESSES) ? " processes" : "");
+    log("INFO", oss.str());
+
+    auto refresh = std::chrono::milliseconds(overhead.settings().refresh_ms);
+    auto next_collection = std::chrono::steady_clock::now() + refresh;
+    auto bench_end = started + std::chrono::seconds(config.bench_seconds);
+
+    while (!stop_requested) {
+        // Sleep until the next collection unless the kernel logs something first
+        auto now = std::chrono::steady_clock::now();
+        int timeout_ms = static_cast<int>(std::max<long long>(
+            0, std::chrono::duration_cast<std::chrono::milliseconds>(next_collection - now).count()));
+        struct pollfd pfd;
+        pfd.fd = kernel_log.fileDescriptor();
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        poll(&pfd, pfd.fd >= 0 ? 1 : 0, timeout_ms);
+
+        if (pfd.revents & POLLIN) {
+            pollKernelLog();
+        }
+
+        now = std::chrono::steady_clock::now();
+        if (now >= next_collection) {
+            collect();
+            checkCpuAlerts();
+
+            // Stay within --cpu-budget
+            if (overhead.update()) {
+                refresh = std::chrono::milliseconds(overhead.settings().refresh_ms);
+                watchdog.setBudget(overhead.settings().refresh_ms);
+                log(overhead.step() > 0 ? "WARN" : "INFO",
+                    "CPU budget step " + std::to_string(overhead.step()) + ": " + overhead.describe());
+            }
+
+            // Skip missed refreshes rather than collecting back to back
+            next_collection += refresh;
+            if (next_collection <= now) {
+                next_collection = now + refresh;
+            }
+        }
+
+        if (config.bench_seconds > 0 && now >= bench_end) {
+            break;
+        }
+    }
+
+    log("INFO", "activity_monitord stopping");
+}
+
+std::string MonitorDaemon::resourceReport() const {
+    unsigned long rss_kb = 0;
+    unsigned long peak_kb = 0;
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) {
+            rss_kb = std::stoul(line.substr(6));
+        } else if (line.compare(0, 6, "VmHWM:") == 0) {
+            peak_kb = std::stoul(line.substr(6));
+        }
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    double cpu_s = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+                   usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+    double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1)
+        << "startup:  " << first_collection_ms << " ms to the first collection\n"
+        << "resident: " << rss_kb / 1024.0 << " MB (peak " << peak_kb / 1024.0 << " MB)\n"
+        << std::setprecision(3)
+        << "CPU:      " << cpu_s << " s in " << wall_s << " s ("
+        << (wall_s > 0 ? cpu_s / wall_s * 100.0 : 0.0) << "%)\n"
+        << "refresh:  " << watchdog.summary() << ", " << watchdog.stats().degraded_ticks
+        << " degraded (deepest level " << watchdog.stats().worst_level << ")\n";
+    if (overhead.enabled()) {
+        oss << std::setprecision(2) << "budget:   " << overhead.describe() << ", "
+            << overhead.averagePercent() << "% on average\n";
+    }
+    return oss.str();
+}
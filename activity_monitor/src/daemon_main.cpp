@@ -0,0 +1,129 @@
+#include "../include/daemon.h"
+#include <iostream>
+#include <stdexcept>
+#include <getopt.h>
+
+// Show usage info
+static void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [OPTIONS]\n"
+              << "Headless activity monitor: collects and alerts without a terminal UI.\n"
+              << "Alerts are written to stdout as timestamped log lines.\n\n"
+              << "Options:\n"
+              << "  -r, --refresh-rate=MS    Set refresh rate in milliseconds (default: 1000)\n"
+              << "  -t, --threshold=PERCENT  Set CPU threshold for alerts (default: 80.0)\n"
+              << "      --cpu-budget=PERCENT Keep the daemon's own CPU use under PERCENT of one core\n"
+              << "                           by slowing refresh and process detail\n"
+              << "      --notify             Also send alerts as desktop notifications\n"
+              << "      --no-kmsg            Do not watch the kernel log (/dev/kmsg) for events\n"
+              << "      --flight-dir=DIR     On CPU alerts and critical kernel events, dump the\n"
+              << "                           snapshot history and process details below DIR\n"
+              << "      --flight-max=N       Maximum flight recorder dumps per hour (default: 4)\n"
+              << "      --process-log=FILE   Append every process seen (command line, start and\n"
+              << "                           exit time, CPU, peak RSS, I/O) to FILE\n"
+              << "  -H, --history=COUNT      Snapshots kept for flight recorder dumps (default: 300)\n"
+              << "      --bench=SEC          Run for SEC seconds, then print startup time, memory\n"
+              << "                           and CPU use of the daemon and exit\n"
+              << "  -h, --help               Display this help and exit\n"
+              << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    DaemonConfig config;
+
+    static struct option long_options[] = {
+        {"refresh-rate", required_argument, 0, 'r'},
+        {"threshold",    required_argument, 0, 't'},
+        {"cpu-budget",   required_argument, 0, 'j'},
+        {"notify",       no_argument,       0, 'n'},
+        {"no-kmsg",      no_argument,       0, 'K'},
+        {"flight-dir",   required_argument, 0, 'G'},
+        {"flight-max",   required_argument, 0, 'M'},
+        {"history",      required_argument, 0, 'H'},
+        {"process-log",  required_argument, 0, 'A'},
+        {"bench",        required_argument, 0, 'B'},
+        {"help",         no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    int option_index = 0;
+
+    while ((opt = getopt_long(argc, argv, "r:t:H:h", long_options, &option_index)) != -1) {
+        switch (opt) {
+            case 'r':
+                config.refresh_rate_ms = std::stoi(optarg);
+                if (config.refresh_rate_ms < 100) {
+                    std::cerr << "Warning: Refresh rate too low. Setting to 100ms minimum." << std::endl;
+                    config.refresh_rate_ms = 100;
+                }
+                break;
+            case 't':
+                config.cpu_threshold = std::stof(optarg);
+                if (config.cpu_threshold < 0.0f || config.cpu_threshold > 100.0f) {
+                    std::cerr << "Warning: Threshold must be between 0 and 100. Using default of 80%." << std::endl;
+                    config.cpu_threshold = 80.0f;
+                }
+                break;
+            case 'j':
+                config.cpu_budget_percent = std::stod(optarg);
+                if (config.cpu_budget_percent <= 0.0 || config.cpu_budget_percent > 100.0) {
+                    std::cerr << "Warning: --cpu-budget must be above 0 and at most 100. Using 1." << std::endl;
+                    config.cpu_budget_percent = 1.0;
+                }
+                break;
+            case 'n':
+                config.desktop_notifications = true;
+                break;
+            case 'K':
+                config.kernel_log = false;
+                break;
+            case 'G':
+                config.flight_dir = optarg;
+                break;
+            case 'M':
+                config.flight_max_per_hour = std::stoi(optarg);
+                if (config.flight_max_per_hour < 1) {
+                    std::cerr << "Warning: Flight recorder needs at least 1 dump per hour. Using 4." << std::endl;
+                    config.flight_max_per_hour = 4;
+                }
+                break;
+            case 'H':
+                config.history_size = std::stoi(optarg);
+                if (config.history_size < 2) {
+                    std::cerr << "Warning: History must hold at least 2 snapshots. Using 2." << std::endl;
+                    config.history_size = 2;
+                }
+                break;
+            case 'A':
+                config.process_log_path = optarg;
+                break;
+            case 'B':
+                config.bench_seconds = std::stoi(optarg);
+                if (config.bench_seconds < 1) {
+                    std::cerr << "Warning: Benchmark must run at least 1 second. Using 10." << std::endl;
+                    config.bench_seconds = 10;
+                }
+                break;
+            case 'h':
+                printUsage(argv[0]);
+                return 0;
+            default:
+                printUsage(argv[0]);
+                return 1;
+        }
+    }
+
+    try {
+        MonitorDaemon daemon;
+        daemon.setConfig(config);
+        daemon.run();
+        if (config.bench_seconds > 0) {
+            std::cout << daemon.resourceReport();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,424 @@
+#include "../include/delay_accounting.h"
+#include <linux/genetlink.h>
+#include <linux/netlink.h>
+#include <linux/taskstats.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+// Receive buffers for one recvmmsg(); a taskstats reply is about 450 bytes
+static const size_t RECV_SLOTS = DelayAccounting::BATCH;
+static const size_t RECV_SLOT_SIZE = 2048;
+
+// Append one generic netlink request carrying a single attribute
+static void appendRequest(std::string& buf, uint16_t family, uint8_t cmd, uint16_t flags, uint32_t seq,
+                          uint16_t attr_type, const void* data, size_t length) {
+    size_t start = buf.size();
+    size_t payload = NLA_HDRLEN + length;
+    size_t total = NLMSG_HDRLEN + GENL_HDRLEN + NLA_ALIGN(payload);
+    buf.resize(start + NLMSG_ALIGN(total), '\0');
+    char* p = &buf[start];
+
+    struct nlmsghdr header;
+    memset(&header, 0, sizeof(header));
+    header.nlmsg_len = static_cast<uint32_t>(total);
+    header.nlmsg_type = family;
+    header.nlmsg_flags = static_cast<uint16_t>(NLM_F_REQUEST | flags);
+    header.nlmsg_seq = seq;
+    memcpy(p, &header, sizeof(header));
+
+    struct genlmsghdr genl;
+    memset(&genl, 0, sizeof(genl));
+    genl.cmd = cmd;
+    genl.version = family == GENL_ID_CTRL ? 1 : TASKSTATS_GENL_VERSION;
+    memcpy(p + NLMSG_HDRLEN, &genl, sizeof(genl));
+
+    struct nlattr attr;
+    attr.nla_len = static_cast<uint16_t>(payload);
+    attr.nla_type = attr_type;
+    memcpy(p + NLMSG_HDRLEN + GENL_HDRLEN, &attr, sizeof(attr));
+    memcpy(p + NLMSG_HDRLEN + GENL_HDRLEN + NLA_HDRLEN, data, length);
+}
+
+// Call visit(type, data, length) for each attribute in a buffer
+template <typename Visit>
+static void forEachAttr(const char* data, size_t length, Visit visit) {
+    while (length >= NLA_HDRLEN) {
+        struct nlattr attr;
+        memcpy(&attr, data, sizeof(attr));
+        if (attr.nla_len < NLA_HDRLEN || attr.nla_len > length) {
+            return;
+        }
+        visit(attr.nla_type & NLA_TYPE_MASK, data + NLA_HDRLEN, attr.nla_len - NLA_HDRLEN);
+        size_t step = NLA_ALIGN(attr.nla_len);
+        if (step >= length) {
+            return;
+        }
+        data += step;
+        length -= step;
+    }
+}
+
+// Process or thread id and statistics of a taskstats message
+struct TaskstatsReply {
+    int aggregate = 0;             // TASKSTATS_TYPE_AGGR_PID or _AGGR_TGID
+    int id = -1;
+    struct taskstats stats;
+};
+
+static bool parseTaskstats(const struct nlmsghdr* header, TaskstatsReply& reply) {
+    if (header->nlmsg_len < NLMSG_HDRLEN + GENL_HDRLEN) {
+        return false;
+    }
+    memset(&reply.stats, 0, sizeof(reply.stats));
+    bool have_stats = false;
+    const char* attrs = reinterpret_cast<const char*>(header) + NLMSG_HDRLEN + GENL_HDRLEN;
+    forEachAttr(attrs, header->nlmsg_len - NLMSG_HDRLEN - GENL_HDRLEN,
+                [&](int type, const char* data, size_t length) {
+        if (type != TASKSTATS_TYPE_AGGR_PID && type != TASKSTATS_TYPE_AGGR_TGID) {
+            return;
+        }
+        reply.aggregate = type;
+        forEachAttr(data, length, [&](int inner, const char* value, size_t value_length) {
+            if ((inner == TASKSTATS_TYPE_PID || inner == TASKSTATS_TYPE_TGID) && value_length >= 4) {
+                uint32_t id;
+                memcpy(&id, value, sizeof(id));
+                reply.id = static_cast<int>(id);
+            } else if (inner == TASKSTATS_TYPE_STATS) {
+                // Older kernels send a shorter struct; the missing fields stay zero
+                memcpy(&reply.stats, value, std::min(value_length, sizeof(reply.stats)));
+                have_stats = true;
+            }
+        });
+    });
+    return have_stats && reply.id > 0;
+}
+
+static uint64_t reclaimDelay(const struct taskstats& stats) {
+    return stats.freepages_delay_total + stats.thrashing_delay_total + stats.compact_delay_total;
+}
+
+static int openTaskstatsSocket() {
+    int fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC);
+    if (fd < 0) {
+        return -1;
+    }
+    struct sockaddr_nl local;
+    memset(&local, 0, sizeof(local));
+    local.nl_family = AF_NETLINK;
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&local), sizeof(local)) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    // Room for a whole batch of replies, or a burst of exits
+    int size = 1 << 20;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    return fd;
+}
+
+// Send one request and wait for its first reply; the error code for failures
+static int transact(int fd, const std::string& request, std::vector<char>& reply) {
+    if (send(fd, request.data(), request.size(), 0) < 0) {
+        return errno;
+    }
+    reply.resize(8192);
+    ssize_t n = recv(fd, reply.data(), reply.size(), 0);
+    if (n < 0) {
+        return errno;
+    }
+    reply.resize(static_cast<size_t>(n));
+
+    const struct nlmsghdr* header = reinterpret_cast<const struct nlmsghdr*>(reply.data());
+    if (!NLMSG_OK(header, static_cast<size_t>(n))) {
+        return EPROTO;
+    }
+    if (header->nlmsg_type == NLMSG_ERROR) {
+        const struct nlmsgerr* error = static_cast<const struct nlmsgerr*>(NLMSG_DATA(header));
+        return -error->error;
+    }
+    return 0;
+}
+
+DelayAccounting::~DelayAccounting() {
+    if (exit_fd >= 0) {
+        std::string request;
+        appendRequest(request, family, TASKSTATS_CMD_GET, 0, ++seq, TASKSTATS_CMD_ATTR_DEREGISTER_CPUMASK,
+                      exit_mask.c_str(), exit_mask.size() + 1);
+        send(exit_fd, request.data(), request.size(), 0);
+        close(exit_fd);
+    }
+    if (query_fd >= 0) {
+        close(query_fd);
+    }
+}
+
+bool DelayAccounting::probe(const std::string& exit_cpus) {
+    if (probed) {
+        return available();
+    }
+    probed = true;
+
+    int fd = openTaskstatsSocket();
+    if (fd < 0) {
+        reason = std::string("cannot open a generic netlink socket: ") + strerror(errno);
+        return false;
+    }
+
+    // The family id is assigned at boot; look it up by name
+    std::string request;
+    static const char FAMILY_NAME[] = TASKSTATS_GENL_NAME;
+    appendRequest(request, GENL_ID_CTRL, CTRL_CMD_GETFAMILY, 0, ++seq, CTRL_ATTR_FAMILY_NAME,
+                  FAMILY_NAME, sizeof(FAMILY_NAME));
+    std::vector<char> reply;
+    int error = transact(fd, request, reply);
+    if (error == 0) {
+        const struct nlmsghdr* header = reinterpret_cast<const struct nlmsghdr*>(reply.data());
+        forEachAttr(reply.data() + NLMSG_HDRLEN + GENL_HDRLEN, header->nlmsg_len - NLMSG_HDRLEN - GENL_HDRLEN,
+                    [&](int type, const char* data, size_t length) {
+            if (type == CTRL_ATTR_FAMILY_ID && length >= sizeof(family)) {
+                memcpy(&family, data, sizeof(family));
+            }
+        });
+    }
+    if (family == 0) {
+        reason = error == ENOENT || error == 0 ? "this kernel has no taskstats (CONFIG_TASKSTATS)"
+                                               : std::string("taskstats lookup failed: ") + strerror(error);
+        close(fd);
+        return false;
+    }
+
+    // Query ourselves once to find out whether we may
+    request.clear();
+    uint32_t self = static_cast<uint32_t>(getpid());
+    appendRequest(request, family, TASKSTATS_CMD_GET, 0, ++seq, TASKSTATS_CMD_ATTR_TGID, &self, sizeof(self));
+    error = transact(fd, request, reply);
+    if (error != 0) {
+        reason = error == EPERM || error == EACCES ? "taskstats queries need CAP_NET_ADMIN"
+                                                   : std::string("taskstats query failed: ") + strerror(error);
+        close(fd);
+        return false;
+    }
+    query_fd = fd;
+
+    // Enabled at boot with delayacct, or later with the sysctl
+    std::string enabled = "1";
+    std::ifstream sysctl("/proc/sys/kernel/task_delayacct");
+    sysctl >> enabled;
+    accounting_off = enabled == "0";
+
+    receive_buffer.resize(RECV_SLOTS * RECV_SLOT_SIZE);
+    subscribeExits(exit_cpus);
+    return true;
+}
+
+// Register a second socket for the exit notifications of the given CPUs
+bool DelayAccounting::subscribeExits(const std::string& cpus) {
+    exit_mask = cpus;
+    if (exit_mask.empty()) {
+        long count = sysconf(_SC_NPROCESSORS_CONF);
+        exit_mask = count > 1 ? "0-" + std::to_string(count - 1) : "0";
+    }
+
+    int fd = openTaskstatsSocket();
+    if (fd < 0) {
+        return false;
+    }
+    std::string request;
+    appendRequest(request, family, TASKSTATS_CMD_GET, NLM_F_ACK, ++seq, TASKSTATS_CMD_ATTR_REGISTER_CPUMASK,
+                  exit_mask.c_str(), exit_mask.size() + 1);
+    std::vector<char> reply;
+    if (transact(fd, request, reply) != 0) {
+        close(fd);
+        return false;
+    }
+    exit_fd = fd;
+    return true;
+}
+
+void DelayAccounting::track(const std::vector<int>& pids) {
+    for (auto it = tracked.begin(); it != tracked.end();) {
+        if (std::find(pids.begin(), pids.end(), it->first) == pids.end()) {
+            it = tracked.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (int pid : pids) {
+        tracked[pid];
+    }
+}
+
+void DelayAccounting::update() {
+    syscalls = 0;
+    if (query_fd < 0) {
+        return;
+    }
+
+    std::vector<int> pids;
+    pids.reserve(tracked.size());
+    for (const auto& entry : tracked) {
+        pids.push_back(entry.first);
+    }
+    auto now = std::chrono::steady_clock::now();
+    for (size_t begin = 0; begin < pids.size(); begin += BATCH) {
+        queryBatch(pids, begin, std::min(pids.size(), begin + BATCH), now);
+    }
+
+    readExits();
+}
+
+// Whatever is queued, up to 'slots' datagrams, in one recvmmsg()
+int DelayAccounting::receive(int fd, struct mmsghdr* messages, size_t slots) {
+    struct iovec iov[RECV_SLOTS];
+    for (size_t i = 0; i < slots; i++) {
+        iov[i].iov_base = &receive_buffer[i * RECV_SLOT_SIZE];
+        iov[i].iov_len = RECV_SLOT_SIZE;
+        memset(&messages[i], 0, sizeof(messages[i]));
+        messages[i].msg_hdr.msg_iov = &iov[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    syscalls++;
+    return recvmmsg(fd, messages, static_cast<unsigned int>(slots), MSG_DONTWAIT, nullptr);
+}
+
+// One send() for the batch; the kernel has queued every reply when it returns
+void DelayAccounting::queryBatch(const std::vector<int>& pids, size_t begin, size_t end,
+                                 std::chrono::steady_clock::time_point now) {
+    uint32_t first_seq = seq + 1;
+    std::string request;
+    for (size_t i = begin; i < end; i++) {
+        uint32_t pid = static_cast<uint32_t>(pids[i]);
+        appendRequest(request, family, TASKSTATS_CMD_GET, 0, ++seq, TASKSTATS_CMD_ATTR_TGID, &pid, sizeof(pid));
+    }
+    syscalls++;
+    if (send(query_fd, request.data(), request.size(), 0) < 0) {
+        return;
+    }
+
+    struct mmsghdr messages[RECV_SLOTS];
+    size_t expected = end - begin;
+    size_t answered = 0;
+    while (answered < expected) {
+        size_t slots = std::min(RECV_SLOTS, expected - answered);
+        int received = receive(query_fd, messages, slots);
+        if (received <= 0) {
+            break;
+        }
+
+        for (int m = 0; m < received; m++) {
+            size_t length = messages[m].msg_len;
+            for (const struct nlmsghdr* header = reinterpret_cast<const struct nlmsghdr*>(&receive_buffer[m * RECV_SLOT_SIZE]);
+                 NLMSG_OK(header, length); header = NLMSG_NEXT(header, length)) {
+                // Late replies of an earlier batch are not ours to count
+                if (header->nlmsg_seq < first_seq || header->nlmsg_seq > seq) {
+                    continue;
+                }
+                answered++;
+
+                // An error reply means the process is gone
+                TaskstatsReply reply;
+                if (header->nlmsg_type == NLMSG_ERROR || !parseTaskstats(header, reply)) {
+                    continue;
+                }
+                auto it = tracked.find(reply.id);
+                if (it == tracked.end()) {
+                    continue;
+                }
+
+                TrackedProcess& proc = it->second;
+                Totals totals;
+                totals.cpu = reply.stats.cpu_delay_total;
+                totals.blkio = reply.stats.blkio_delay_total;
+                totals.swapin = reply.stats.swapin_delay_total;
+                totals.reclaim = reclaimDelay(reply.stats);
+
+                double elapsed_ns = std::chrono::duration<double, std::nano>(now - proc.last_time).count();
+                if (proc.have_last && elapsed_ns > 0) {
+                    // A thread that is exiting can drop out of the sum for a moment; read a dip as no delay
+                    auto rate = [elapsed_ns](uint64_t current, uint64_t last) {
+                        return current > last ? (current - last) / elapsed_ns * 100.0 : 0.0;
+                    };
+                    proc.current.cpu_percent = rate(totals.cpu, proc.last.cpu);
+                    proc.current.blkio_percent = rate(totals.blkio, proc.last.blkio);
+                    proc.current.swapin_percent = rate(totals.swapin, proc.last.swapin);
+                    proc.current.reclaim_percent = rate(totals.reclaim, proc.last.reclaim);
+                    proc.current.valid = true;
+                }
+                proc.last = totals;
+                proc.last_time = now;
+                proc.have_last = true;
+            }
+        }
+    }
+}
+
+// Drain the exit notifications since the last update
+void DelayAccounting::readExits() {
+    exit_summary = DelayExitSummary();
+    if (exit_fd < 0) {
+        return;
+    }
+
+    // A process exit sends one message per thread, and one for the thread
+    // group if it had several threads; count each process once
+    std::map<int, struct taskstats> exited;
+    struct mmsghdr messages[RECV_SLOTS];
+    while (true) {
+        int received = receive(exit_fd, messages, RECV_SLOTS);
+        if (received < 0 && errno == ENOBUFS) {
+            exit_summary.lost++;
+            continue;
+        }
+        if (received <= 0) {
+            break;
+        }
+
+        for (int m = 0; m < received; m++) {
+            size_t length = messages[m].msg_len;
+            for (const struct nlmsghdr* header = reinterpret_cast<const struct nlmsghdr*>(&receive_buffer[m * RECV_SLOT_SIZE]);
+                 NLMSG_OK(header, length); header = NLMSG_NEXT(header, length)) {
+                TaskstatsReply reply;
+                if (header->nlmsg_type == NLMSG_ERROR || !parseTaskstats(header, reply)) {
+                    continue;
+                }
+                if (reply.aggregate == TASKSTATS_TYPE_AGGR_TGID) {
+                    exited[reply.id] = reply.stats;
+                } else if (reply.stats.ac_tgid == 0 || reply.stats.ac_tgid == static_cast<uint32_t>(reply.id)) {
+                    // The group leader; a later thread-group message replaces it
+                    exited.insert(std::make_pair(reply.id, reply.stats));
+                }
+            }
+        }
+        if (static_cast<size_t>(received) < RECV_SLOTS) {
+            break;
+        }
+    }
+
+    for (const auto& entry : exited) {
+        const struct taskstats& stats = entry.second;
+        double total_ms = (stats.cpu_delay_total + stats.blkio_delay_total + stats.swapin_delay_total +
+                           reclaimDelay(stats)) / 1e6;
+        exit_summary.processes++;
+        exit_summary.cpu_ms += stats.cpu_delay_total / 1e6;
+        exit_summary.blkio_ms += stats.blkio_delay_total / 1e6;
+        exit_summary.swapin_ms += stats.swapin_delay_total / 1e6;
+        exit_summary.reclaim_ms += reclaimDelay(stats) / 1e6;
+        if (total_ms > exit_summary.worst_ms) {
+            exit_summary.worst_ms = total_ms;
+            exit_summary.worst_pid = entry.first;
+            exit_summary.worst_name = std::string(stats.ac_comm, strnlen(stats.ac_comm, sizeof(stats.ac_comm)));
+        }
+    }
+}
+
+const DelaySample* DelayAccounting::sample(int pid) const {
+    auto it = tracked.find(pid);
+    if (it == tracked.end() || !it->second.current.valid) {
+        return nullptr;
+    }
+    return &it->second.current;
+}
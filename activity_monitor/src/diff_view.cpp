@@ -0,0 +1,183 @@
+#include "../include/monitor.h"
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <ctime>
+#include <cstdlib>
+
+// Format a clock time for the diff header
+static std::string formatClock(time_t t) {
+    char buf[16] = "--:--:--";
+    struct tm tm_info;
+    if (t != 0 && localtime_r(&t, &tm_info) != nullptr) {
+        strftime(buf, sizeof(buf), "%H:%M:%S", &tm_info);
+    }
+    return buf;
+}
+
+// Snapshot currently on screen (paused position or newest)
+uint64_t ActivityMonitor::viewedSeq() const {
+    return paused ? history_cursor : history.newestSeq();
+}
+
+// Remember the viewed snapshot as the "before" side of the diff
+void ActivityMonitor::markDiffBaseline() {
+    if (history.empty()) {
+        return;
+    }
+
+    diff_mark_seq = viewedSeq();
+    diff_mark_set = true;
+
+    if (process_view == VIEW_DIFF) {
+        updateDiff();
+    }
+}
+
+// Show or hide the diff view
+void ActivityMonitor::toggleDiffView() {
+    if (process_view == VIEW_DIFF) {
+        setProcessView(VIEW_PROCESSES);
+    } else {
+        setProcessView(VIEW_DIFF);
+        updateDiff();
+    }
+}
+
+// Recompute the diff between the baseline and the viewed snapshot
+void ActivityMonitor::updateDiff() {
+    if (history.empty()) {
+        return;
+    }
+
+    // Without a mark (or once it has been evicted) compare against the oldest snapshot
+    uint64_t from = (diff_mark_set && history.contains(diff_mark_seq)) ? diff_mark_seq : history.oldestSeq();
+    uint64_t to = viewedSeq();
+    if (from > to) {
+        std::swap(from, to);
+    }
+
+    history.load(from, diff_before);
+    history.load(to, diff_after);
+    current_diff = diffSnapshots(diff_before, diff_after);
+}
+
+// Draw the diff in place of the process list
+void ActivityMonitor::displayDiffView() {
+    screen->clear(process_win);
+    screen->box(process_win);
+
+    int height = process_win.height;
+    int width = process_win.width;
+
+    const SnapshotDiff& diff = current_diff;
+
+    std::string title = " Diff " + formatClock(diff.from_time) + " -> " + formatClock(diff.to_time) +
+                        " ('b' mark baseline, 'd' close) ";
+    screen->attrOn(process_win, COLOR_PAIR(5));
+    screen->print(process_win, 0, 2, "%s", title.c_str());
+    screen->attrOff(process_win, COLOR_PAIR(5));
+
+    // Build all lines first, then draw the visible window
+    std::vector<std::pair<int, std::string>> lines;  // (attributes, text)
+    auto signedSize = [this](long long kb) {
+        return std::string(kb < 0 ? "-" : "+") + formatSize(static_cast<unsigned long>(std::llabs(kb)));
+    };
+    auto heading = [&lines](const std::string& text) {
+        lines.push_back(std::make_pair(static_cast<int>(A_BOLD), text));
+    };
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1) << std::showpos
+        << "CPU total: " << diff.total_cpu_delta << " pts" << std::noshowpos
+        << "   Mem used: " << signedSize(diff.mem_used_delta_kb)
+        << "   Swap used: " << signedSize(diff.swap_used_delta_kb);
+    lines.push_back(std::make_pair(0, oss.str()));
+
+    if (!diff.core_deltas.empty()) {
+        oss.str("");
+        oss << "Cores:";
+        for (size_t c = 0; c < diff.core_deltas.size(); c++) {
+            std::ostringstream cell;
+            cell << " " << c << ":" << std::fixed << std::setprecision(1) << std::showpos << diff.core_deltas[c];
+            if (oss.str().length() + cell.str().length() > static_cast<size_t>(width - 6)) {
+                lines.push_back(std::make_pair(0, oss.str()));
+                oss.str("      ");
+            }
+            oss << cell.str();
+        }
+        lines.push_back(std::make_pair(0, oss.str()));
+    }
+
+    heading("Started (" + std::to_string(diff.started.size()) + "):");
+    for (const auto& proc : diff.started) {
+        oss.str("");
+        oss << "  + " << std::left << std::setw(7) << proc.pid << std::setw(25) << proc.name.substr(0, 25)
+            << std::right << std::fixed << std::setprecision(1) << std::setw(6) << proc.cpu_percent << "% CPU  "
+            << formatSize(proc.rss_kb);
+        lines.push_back(std::make_pair(static_cast<int>(COLOR_PAIR(1)), oss.str()));
+    }
+
+    heading("Exited (" + std::to_string(diff.exited.size()) + "):");
+    for (const auto& proc : diff.exited) {
+        oss.str("");
+        oss << "  - " << std::left << std::setw(7) << proc.pid << std::setw(25) << proc.name.substr(0, 25)
+            << std::right << std::fixed << std::setprecision(1) << std::setw(6) << proc.cpu_percent << "% CPU  "
+            << formatSize(proc.rss_kb);
+        lines.push_back(std::make_pair(static_cast<int>(COLOR_PAIR(3)), oss.str()));
+    }
+
+    heading("Top CPU movers:");
+    for (const auto& d : diff.cpu_movers) {
+        oss.str("");
+        oss << "    " << std::left << std::setw(7) << d.pid << std::setw(25) << d.name.substr(0, 25)
+            << std::right << std::fixed << std::setprecision(1) << std::setw(6) << d.cpu_before
+            << "% -> " << std::setw(6) << d.cpu_after << "%";
+        lines.push_back(std::make_pair(static_cast<int>(COLOR_PAIR(d.cpu_after > d.cpu_before ? 2 : 1)), oss.str()));
+    }
+
+    heading("Top RSS movers:");
+    for (const auto& d : diff.rss_movers) {
+        oss.str("");
+        oss << "    " << std::left << std::setw(7) << d.pid << std::setw(25) << d.name.substr(0, 25)
+            << signedSize(d.rss_delta_kb);
+        lines.push_back(std::make_pair(static_cast<int>(COLOR_PAIR(d.rss_delta_kb > 0 ? 2 : 1)), oss.str()));
+    }
+
+    heading("Top I/O:");
+    for (const auto& d : diff.io_movers) {
+        oss.str("");
+        oss << "    " << std::left << std::setw(7) << d.pid << std::setw(25) << d.name.substr(0, 25)
+            << formatSize(static_cast<unsigned long>(d.io_delta_bytes / 1024));
+        lines.push_back(std::make_pair(static_cast<int>(COLOR_PAIR(2)), oss.str()));
+    }
+
+    heading("Disks:");
+    for (const auto& d : diff.disk_changes) {
+        oss.str("");
+        oss << "    " << std::left << std::setw(20) << d.mount_point.substr(0, 20) << std::right
+            << std::fixed << std::setprecision(1) << std::setw(5) << d.percent_before << "% -> "
+            << std::setw(5) << d.percent_after << "%  I/O ops " << std::showpos << d.io_ops_delta << std::noshowpos
+            << "  latency " << formatLatency(d.latency_before_ms, false) << " -> " << formatLatency(d.latency_after_ms, false);
+        lines.push_back(std::make_pair(0, oss.str()));
+    }
+    for (const auto& mount : diff.mounts_added) {
+        lines.push_back(std::make_pair(static_cast<int>(COLOR_PAIR(1)), "  + mounted   " + mount));
+    }
+    for (const auto& mount : diff.mounts_removed) {
+        lines.push_back(std::make_pair(static_cast<int>(COLOR_PAIR(3)), "  - unmounted " + mount));
+    }
+
+    // Draw the visible part
+    int rows = height - 2;
+    view_offset = std::max(0, std::min(view_offset, static_cast<int>(lines.size()) - rows));
+    for (int row = 0; row < rows && view_offset + row < static_cast<int>(lines.size()); row++) {
+        const auto& line = lines[view_offset + row];
+        std::string text = line.second.substr(0, std::max(0, width - 4));
+        screen->attrOn(process_win, line.first);
+        screen->print(process_win, row + 1, 2, "%s", text.c_str());
+        screen->attrOff(process_win, line.first);
+    }
+
+    screen->refresh(process_win);
+}
@@ -0,0 +1,350 @@
+#include "../include/disk_usage.h"
+#include "../include/trace.h"
+#include <algorithm>
+#include <unordered_map>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#ifndef AT_NO_AUTOMOUNT
+#define AT_NO_AUTOMOUNT 0x800
+#endif
+
+// Layout of the records returned by getdents64
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+// Buffer for one getdents64 call
+static const size_t DIRENT_BUFFER_SIZE = 64 * 1024;
+
+static int64_t mtimeNs(const struct stat& st) {
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+}
+
+DiskUsageScanner::~DiskUsageScanner() {
+    stop();
+}
+
+bool DiskUsageScanner::start(const std::string& root, bool incremental) {
+    stop();
+
+    struct stat st;
+    if (lstat(root.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(tree_lock);
+        if (incremental && tree && scan_root == root) {
+            previous_tree = std::move(tree);
+        } else {
+            previous_tree.reset();
+        }
+        tree.reset(new Node());
+        tree->name = root;
+        tree->previous = previous_tree.get();
+    }
+    scan_root = root;
+    root_dev = st.st_dev;
+    linked_inodes.clear();
+
+    stat_directories = 0;
+    stat_reused = 0;
+    stat_files = 0;
+    stat_errors = 0;
+    stat_steals = 0;
+    finished_seconds = 0.0;
+    started = std::chrono::steady_clock::now();
+
+    int threads = static_cast<int>(std::max(2u, std::min(8u, std::thread::hardware_concurrency())));
+    queues.clear();
+    for (int i = 0; i < threads; i++) {
+        queues.emplace_back(new WorkQueue());
+    }
+    queues[0]->items.push_back(tree.get());
+    outstanding = 1;
+
+    stop_requested = false;
+    workers_running = threads;
+    for (int i = 0; i < threads; i++) {
+        workers.emplace_back(&DiskUsageScanner::workerLoop, this, static_cast<size_t>(i));
+    }
+    return true;
+}
+
+void DiskUsageScanner::stop() {
+    stop_requested = true;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    queues.clear();
+    outstanding = 0;
+}
+
+// Own queue first (newest, depth-first), then steal the oldest item of another queue
+DiskUsageScanner::Node* DiskUsageScanner::takeWork(size_t index) {
+    {
+        WorkQueue& own = *queues[index];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.items.empty()) {
+            Node* node = own.items.back();
+            own.items.pop_back();
+            return node;
+        }
+    }
+
+    for (size_t i = 1; i < queues.size(); i++) {
+        WorkQueue& victim = *queues[(index + i) % queues.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.items.empty()) {
+            Node* node = victim.items.front();
+            victim.items.pop_front();
+            stat_steals++;
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+void DiskUsageScanner::workerLoop(size_t index) {
+    Tracer::nameThread("disk usage");
+    while (!stop_requested) {
+        Node* node = takeWork(index);
+        if (node != nullptr) {
+            scanDirectory(index, node);
+            outstanding--;
+        } else if (outstanding.load() == 0) {
+            break;
+        } else {
+            // Others are still listing directories that may produce work
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    if (--workers_running == 0) {
+        finished_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    }
+}
+
+std::string DiskUsageScanner::pathOf(const Node* node) const {
+    std::vector<const std::string*> parts;
+    for (const Node* n = node; n != nullptr; n = n->parent) {
+        parts.push_back(&n->name);
+    }
+
+    std::string path = *parts.back();
+    for (size_t i = parts.size() - 1; i-- > 0;) {
+        if (path.empty() || path[path.size() - 1] != '/') {
+            path += '/';
+        }
+        path += *parts[i];
+    }
+    return path;
+}
+
+// A directory and everything below it is done; tell the parent
+void DiskUsageScanner::finishDirectory(Node* node) {
+    while (node != nullptr && --node->pending == 0) {
+        node = node->parent;
+    }
+}
+
+void DiskUsageScanner::scanDirectory(size_t index, Node* node) {
+    TraceSpan span("disk_usage", "scanDirectory");
+    std::string path = pathOf(node);
+    int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    struct stat dir_st;
+    if (fd < 0 || fstat(fd, &dir_st) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        stat_errors++;
+        finishDirectory(node);
+        return;
+    }
+    node->mtime_ns = mtimeNs(dir_st);
+
+    uint64_t own_bytes = static_cast<uint64_t>(dir_st.st_blocks) * 512;
+    uint64_t own_files = 0;
+    std::vector<std::unique_ptr<Node>> subdirs;
+    const Node* previous = node->previous;
+
+    if (previous != nullptr && previous->mtime_ns == node->mtime_ns && previous->pending.load() == 0) {
+        // Same entries as last time: keep the file totals, only descend into subdirectories
+        close(fd);
+        stat_reused++;
+        own_bytes = previous->own_bytes.load();
+        own_files = previous->own_files.load();
+        for (const auto& old_child : previous->children) {
+            std::unique_ptr<Node> child(new Node());
+            child->name = old_child->name;
+            child->parent = node;
+            child->previous = old_child.get();
+            subdirs.push_back(std::move(child));
+        }
+    } else {
+        stat_directories++;
+
+        // Subdirectories of the previous scan, looked up by name
+        std::unordered_map<std::string, const Node*> old_children;
+        if (previous != nullptr) {
+            for (const auto& old_child : previous->children) {
+                old_children[old_child->name] = old_child.get();
+            }
+        }
+
+        static thread_local std::vector<char> buffer(DIRENT_BUFFER_SIZE);
+        while (!stop_requested) {
+            long n = syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+            if (n <= 0) {
+                break;
+            }
+
+            for (long offset = 0; offset < n;) {
+                const LinuxDirent64* entry = reinterpret_cast<const LinuxDirent64*>(buffer.data() + offset);
+                offset += entry->d_reclen;
+
+                const char* name = entry->d_name;
+                if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                    continue;
+                }
+
+                struct stat st;
+                if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT) != 0) {
+                    continue;
+                }
+
+                if (S_ISDIR(st.st_mode)) {
+                    // Stay on this filesystem
+                    if (st.st_dev != root_dev) {
+                        continue;
+                    }
+                    std::unique_ptr<Node> child(new Node());
+                    child->name = name;
+                    child->parent = node;
+                    auto old = old_children.find(child->name);
+                    child->previous = old != old_children.end() ? old->second : nullptr;
+                    subdirs.push_back(std::move(child));
+                    continue;
+                }
+
+                if (st.st_nlink > 1) {
+                    std::lock_guard<std::mutex> guard(inode_lock);
+                    if (!linked_inodes.insert(st.st_ino).second) {
+                        continue;
+                    }
+                }
+
+                own_bytes += static_cast<uint64_t>(st.st_blocks) * 512;
+                if (S_ISREG(st.st_mode)) {
+                    own_files++;
+                }
+            }
+        }
+        close(fd);
+    }
+
+    node->own_bytes = own_bytes;
+    node->own_files = own_files;
+    stat_files += own_files;
+
+    // Sizes show up in every ancestor right away
+    for (Node* n = node; n != nullptr; n = n->parent) {
+        n->bytes += own_bytes;
+        n->files += own_files;
+    }
+
+    if (!subdirs.empty() && !stop_requested) {
+        node->pending += static_cast<int>(subdirs.size());
+        outstanding += static_cast<long>(subdirs.size());
+
+        std::vector<Node*> work;
+        work.reserve(subdirs.size());
+        {
+            std::lock_guard<std::mutex> guard(tree_lock);
+            for (auto& child : subdirs) {
+                work.push_back(child.get());
+                node->children.push_back(std::move(child));
+            }
+        }
+
+        WorkQueue& own = *queues[index];
+        std::lock_guard<std::mutex> guard(own.lock);
+        own.items.insert(own.items.end(), work.begin(), work.end());
+    }
+
+    finishDirectory(node);
+}
+
+void DiskUsageScanner::fillEntry(const Node* node, DiskUsageEntry& entry) {
+    entry.name = node->name;
+    entry.bytes = node->bytes.load();
+    entry.files = node->files.load();
+    entry.complete = node->pending.load() == 0;
+    entry.is_dir = true;
+}
+
+bool DiskUsageScanner::list(const std::vector<std::string>& path, DiskUsageEntry& self,
+                            std::vector<DiskUsageEntry>& children) const {
+    std::lock_guard<std::mutex> guard(tree_lock);
+    const Node* node = tree.get();
+    if (node == nullptr) {
+        return false;
+    }
+
+    for (const auto& name : path) {
+        const Node* next = nullptr;
+        for (const auto& child : node->children) {
+            if (child->name == name) {
+                next = child.get();
+                break;
+            }
+        }
+        if (next == nullptr) {
+            return false;
+        }
+        node = next;
+    }
+
+    fillEntry(node, self);
+    children.clear();
+    children.reserve(node->children.size() + 1);
+    for (const auto& child : node->children) {
+        DiskUsageEntry entry;
+        fillEntry(child.get(), entry);
+        children.push_back(entry);
+    }
+
+    DiskUsageEntry own;
+    own.bytes = node->own_bytes.load();
+    own.files = node->own_files.load();
+    own.complete = self.complete;
+    own.is_dir = false;
+    children.push_back(own);
+
+    std::sort(children.begin(), children.end(), [](const DiskUsageEntry& a, const DiskUsageEntry& b) {
+        return a.bytes > b.bytes;
+    });
+    return true;
+}
+
+DiskUsageScanner::Stats DiskUsageScanner::stats() const {
+    Stats s;
+    s.directories = stat_directories.load();
+    s.reused = stat_reused.load();
+    s.files = stat_files.load();
+    s.errors = stat_errors.load();
+    s.steals = stat_steals.load();
+    s.threads = static_cast<int>(queues.size());
+    s.seconds = active() ? std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count()
+                         : finished_seconds.load();
+    return s;
+}
@@ -0,0 +1,202 @@
+#include "../include/monitor.h"
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+// Open the analyzer on the fullest mount, or close it
+void ActivityMonitor::toggleDiskUsage() {
+    if (process_view == VIEW_DISK_USAGE) {
+        setProcessView(VIEW_PROCESSES);
+        return;
+    }
+
+    setProcessView(VIEW_DISK_USAGE);
+    if (disk_usage.root().empty()) {
+        du_choosing = true;
+        du_mount_index = 0;
+        for (size_t i = 1; i < disk_info.size(); i++) {
+            if (disk_info[i].percent_used > disk_info[du_mount_index].percent_used) {
+                du_mount_index = static_cast<int>(i);
+            }
+        }
+    }
+}
+
+// Navigation inside the analyzer; false for keys it leaves to the global handler
+bool ActivityMonitor::handleDiskUsageKey(int ch) {
+    if (du_choosing) {
+        int count = static_cast<int>(disk_info.size());
+        switch (ch) {
+            case KEY_UP:
+                du_mount_index = std::max(0, du_mount_index - 1);
+                return true;
+            case KEY_DOWN:
+                du_mount_index = std::min(count - 1, du_mount_index + 1);
+                return true;
+            case '\n':
+            case KEY_ENTER:
+            case KEY_RIGHT:
+                if (du_mount_index >= 0 && du_mount_index < count) {
+                    const std::string& mount = disk_info[du_mount_index].mount_point;
+                    if (disk_usage.start(mount, true)) {
+                        du_choosing = false;
+                        du_path.clear();
+                        du_selected = 0;
+                    }
+                }
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    DiskUsageEntry self;
+    std::vector<DiskUsageEntry> children;
+    if (!disk_usage.list(du_path, self, children)) {
+        du_path.clear();
+        du_selected = 0;
+        return ch == KEY_UP || ch == KEY_DOWN || ch == KEY_LEFT || ch == KEY_RIGHT;
+    }
+    int count = static_cast<int>(children.size());
+
+    switch (ch) {
+        case KEY_UP:
+            du_selected = std::max(0, du_selected - 1);
+            return true;
+        case KEY_DOWN:
+            du_selected = std::min(count - 1, du_selected + 1);
+            return true;
+        case KEY_PPAGE:
+            du_selected = std::max(0, du_selected - 10);
+            return true;
+        case KEY_NPAGE:
+            du_selected = std::min(count - 1, du_selected + 10);
+            return true;
+        case KEY_HOME:
+            du_selected = 0;
+            return true;
+        case KEY_END:
+            du_selected = count - 1;
+            return true;
+        case '\n':
+        case KEY_ENTER:
+        case KEY_RIGHT:
+            if (du_selected >= 0 && du_selected < count && children[du_selected].is_dir) {
+                du_path.push_back(children[du_selected].name);
+                du_selected = 0;
+            }
+            return true;
+        case KEY_LEFT:
+        case KEY_BACKSPACE:
+        case 127:
+            if (du_path.empty()) {
+                // Back to the mount list; the finished tree stays for the next visit
+                disk_usage.stop();
+                du_choosing = true;
+            } else {
+                du_path.pop_back();
+                du_selected = 0;
+            }
+            return true;
+        case 's':
+            // Rescan, reusing directories whose mtime has not changed
+            disk_usage.start(disk_usage.root(), true);
+            return true;
+        case 'S':
+            disk_usage.start(disk_usage.root(), false);
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Draw the mount chooser or the directory listing in place of the process list
+void ActivityMonitor::displayDiskUsage() {
+    screen->clear(process_win);
+    screen->box(process_win);
+
+    int height = process_win.height;
+    int width = process_win.width;
+    int text_width = std::max(0, width - 4);
+    int rows = height - 4;
+
+    if (du_choosing) {
+        screen->attrOn(process_win, COLOR_PAIR(5));
+        screen->print(process_win, 0, 2, "%s", std::string(" Disk usage: choose a mount (Enter scan, 'a' close) ").substr(0, text_width).c_str());
+        screen->attrOff(process_win, COLOR_PAIR(5));
+
+        screen->attrOn(process_win, A_BOLD);
+        screen->print(process_win, 2, 2, "%-30s %-20s %10s %10s %6s", "Mount", "Device", "Used", "Size", "Use%");
+        screen->attrOff(process_win, A_BOLD);
+
+        for (int i = 0; i < static_cast<int>(disk_info.size()) && i < rows; i++) {
+            const DiskInfo& disk = disk_info[i];
+            int color = disk.percent_used > 90.0f ? 3 : (disk.percent_used > 75.0f ? 2 : 1);
+            attr_t attrs = COLOR_PAIR(color) | (i == du_mount_index ? A_REVERSE : 0);
+            screen->attrOn(process_win, attrs);
+            screen->print(process_win, i + 3, 2, "%-30.30s %-20.20s %10s %10s %5.1f%%", disk.mount_point.c_str(),
+                          disk.device.c_str(), formatSize(disk.used_space).c_str(),
+                          formatSize(disk.total_space).c_str(), disk.percent_used);
+            screen->attrOff(process_win, attrs);
+        }
+
+        screen->refresh(process_win);
+        return;
+    }
+
+    DiskUsageEntry self;
+    std::vector<DiskUsageEntry> children;
+    if (!disk_usage.list(du_path, self, children)) {
+        du_path.clear();
+        disk_usage.list(du_path, self, children);
+    }
+    DiskUsageScanner::Stats stats = disk_usage.stats();
+
+    std::string path = disk_usage.root();
+    for (const auto& name : du_path) {
+        path += (path[path.size() - 1] == '/' ? "" : "/") + name;
+    }
+    std::string title = " Disk usage: " + path + " (Enter open, Left up, 's' rescan, 'a' close) ";
+    screen->attrOn(process_win, COLOR_PAIR(5));
+    screen->print(process_win, 0, 2, "%s", title.substr(0, text_width).c_str());
+    screen->attrOff(process_win, COLOR_PAIR(5));
+
+    std::ostringstream oss;
+    oss << formatSize(self.bytes / 1024) << " in " << self.files << " files; "
+        << (disk_usage.active() ? "scanning " : "scanned in ") << std::fixed << std::setprecision(1)
+        << stats.seconds << " s: " << stats.directories << " dirs listed, " << stats.reused
+        << " unchanged, " << stats.steals << " steals, " << stats.threads << " threads";
+    if (stats.errors > 0) {
+        oss << ", " << stats.errors << " unreadable";
+    }
+    screen->print(process_win, 1, 2, "%s", oss.str().substr(0, text_width).c_str());
+
+    screen->attrOn(process_win, A_BOLD);
+    screen->print(process_win, 2, 2, "%10s %6s %10s  %s", "Size", "%", "Files", "Name");
+    screen->attrOff(process_win, A_BOLD);
+
+    int total = static_cast<int>(children.size());
+    du_selected = std::max(0, std::min(du_selected, total - 1));
+    int first = std::max(0, std::min(du_selected - rows / 2, total - rows));
+
+    for (int row = 0; row < rows && first + row < total; row++) {
+        int index = first + row;
+        const DiskUsageEntry& entry = children[index];
+        double percent = self.bytes > 0 ? 100.0 * entry.bytes / self.bytes : 0.0;
+
+        // Subtrees still being scanned are marked with '+'
+        std::string name = entry.is_dir ? entry.name + "/" : "(files here)";
+        if (!entry.complete) {
+            name += " +";
+        }
+
+        attr_t attrs = (entry.is_dir ? A_BOLD : 0) | (index == du_selected ? A_REVERSE : 0);
+        screen->attrOn(process_win, attrs);
+        screen->print(process_win, row + 3, 2, "%10s %5.1f%% %10llu  %s", formatSize(entry.bytes / 1024).c_str(),
+                      percent, static_cast<unsigned long long>(entry.files),
+                      name.substr(0, std::max(0, text_width - 31)).c_str());
+        screen->attrOff(process_win, attrs);
+    }
+
+    screen->refresh(process_win);
+}
@@ -0,0 +1,34 @@
+#include "../include/monitor.h"
+#include <algorithm>
+#include <cstdio>
+
+// The processes captured in depth for a dump
+std::vector<int> ActivityMonitor::flightCapturePids(int pid) const {
+    return FlightRecorder::capturePids(live_processes, pid);
+}
+
+// Hand the history and the offending processes to the recorder's thread
+void ActivityMonitor::triggerFlightRecorder(const std::string& reason, int pid) {
+    if (!flight_recorder.enabled()) {
+        return;
+    }
+
+    if (flight_recorder.trigger(reason, history, flightCapturePids(pid), monitorState())) {
+        debugLog("Flight recorder: dumping " + std::to_string(history.size()) + " snapshots (" + reason + ")");
+    } else {
+        debugLog("Flight recorder: dump skipped, one in progress or hourly cap reached (" + reason + ")");
+    }
+}
+
+// Dump when CPU usage crosses the alert threshold (once per crossing)
+void ActivityMonitor::checkFlightTriggers() {
+    TraceSpan span("alerts", "checkFlightTriggers");
+    bool over = cpu_info.total_usage > config.cpu_threshold;
+    if (over && !flight_cpu_over) {
+        char reason[96];
+        snprintf(reason, sizeof(reason), "CPU usage %.1f%% over threshold %.1f%%",
+                 cpu_info.total_usage, config.cpu_threshold);
+        triggerFlightRecorder(reason, -1);
+    }
+    flight_cpu_over = over;
+}
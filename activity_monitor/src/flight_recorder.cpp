@@ -0,0 +1,281 @@
+#include "../include/flight_recorder.h"
+#include "../include/trace.h"
+#include <fstream>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+// Largest /proc file copied into a capture
+static const size_t MAX_CAPTURE_BYTES = 1024 * 1024;
+
+// Processes captured in depth for each dump (by CPU and by memory)
+static const size_t FLIGHT_TOP_PROCESSES = 3;
+
+// Files copied from /proc/[pid] for each offending process
+static const char* CAPTURE_FILES[] = {"status", "smaps_rollup", "stack", "wchan", "cgroup", "limits", "io"};
+
+// ioprio_set() values, not exported by glibc
+static const int IOPRIO_WHO_PROCESS = 1;
+static const int IOPRIO_CLASS_IDLE = 3;
+static const int IOPRIO_CLASS_SHIFT = 13;
+
+FlightRecorder::~FlightRecorder() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stop_requested = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void FlightRecorder::configure(const std::string& dir, int max_per_hour) {
+    output_dir = dir;
+    dumps_per_hour = std::max(1, max_per_hour);
+}
+
+std::vector<int> FlightRecorder::capturePids(const std::vector<Process>& processes, int pid) {
+    std::vector<const Process*> ranked;
+    ranked.reserve(processes.size());
+    for (const auto& proc : processes) {
+        ranked.push_back(&proc);
+    }
+    size_t top = std::min(ranked.size(), FLIGHT_TOP_PROCESSES);
+
+    std::vector<int> pids;
+    if (pid > 0) {
+        pids.push_back(pid);
+    }
+    auto add = [&pids](const Process* proc) {
+        if (std::find(pids.begin(), pids.end(), proc->pid) == pids.end()) {
+            pids.push_back(proc->pid);
+        }
+    };
+
+    std::partial_sort(ranked.begin(), ranked.begin() + top, ranked.end(),
+                      [](const Process* a, const Process* b) { return a->cpu_percent > b->cpu_percent; });
+    std::for_each(ranked.begin(), ranked.begin() + top, add);
+    std::partial_sort(ranked.begin(), ranked.begin() + top, ranked.end(),
+                      [](const Process* a, const Process* b) { return a->rss_kb > b->rss_kb; });
+    std::for_each(ranked.begin(), ranked.begin() + top, add);
+    return pids;
+}
+
+bool FlightRecorder::trigger(const std::string& reason, const SnapshotHistory& history, const std::vector<int>& pids,
+                             const std::string& monitor_state) {
+    if (!enabled()) {
+        return false;
+    }
+
+    time_t now = time(nullptr);
+    while (!recent_dumps.empty() && now - recent_dumps.front() >= 3600) {
+        recent_dumps.pop_front();
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (writing || pending) {
+        current.skipped_busy++;
+        return false;
+    }
+    if (static_cast<int>(recent_dumps.size()) >= dumps_per_hour) {
+        current.skipped_capped++;
+        return false;
+    }
+    recent_dumps.push_back(now);
+
+    // Copying the compact ring is a few memcpy's; decoding it is left to the worker
+    pending.reset(new Job());
+    pending->reason = reason;
+    pending->monitor_state = monitor_state;
+    pending->triggered_at = now;
+    pending->history.reset(new SnapshotHistory(history));
+    pending->pids = pids;
+
+    if (!worker.joinable()) {
+        worker = std::thread(&FlightRecorder::workerLoop, this);
+    }
+    wake.notify_all();
+    return true;
+}
+
+FlightRecorder::Stats FlightRecorder::stats() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return current;
+}
+
+void FlightRecorder::workerLoop() {
+    Tracer::nameThread("flight recorder");
+    // Dumps must not compete with the workload being diagnosed
+    syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT);
+
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        wake.wait(guard, [this] { return stop_requested || pending; });
+        if (!pending) {
+            break;  // A dump queued before shutdown is still written
+        }
+
+        std::unique_ptr<Job> job = std::move(pending);
+        writing = true;
+        guard.unlock();
+
+        std::string path;
+        std::string error;
+        bool ok = writeDump(*job, path, error);
+        job.reset();
+
+        guard.lock();
+        writing = false;
+        if (ok) {
+            current.written++;
+            current.last_path = path;
+        } else {
+            current.last_error = error;
+        }
+    }
+}
+
+static bool makeDirectories(const std::string& path) {
+    for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+        std::string prefix = path.substr(0, slash);
+        if (mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+        if (slash == std::string::npos) {
+            return true;
+        }
+    }
+}
+
+// Copy at most MAX_CAPTURE_BYTES of a /proc file; NULs (cmdline) become spaces
+static void copyProcFile(const std::string& from, const std::string& to) {
+    int in = open(from.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+        return;  // Gone, or not permitted (stack needs root)
+    }
+
+    std::ofstream out(to);
+    char buffer[8192];
+    size_t total = 0;
+    ssize_t n;
+    while (total < MAX_CAPTURE_BYTES && (n = read(in, buffer, sizeof(buffer))) > 0) {
+        std::replace(buffer, buffer + n, '\0', ' ');
+        out.write(buffer, n);
+        total += static_cast<size_t>(n);
+    }
+    close(in);
+}
+
+bool FlightRecorder::writeDump(const Job& job, std::string& path, std::string& error) {
+    TraceSpan span("flight", "writeDump");
+    char stamp[32];
+    struct tm local;
+    localtime_r(&job.triggered_at, &local);
+    strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &local);
+
+    path = output_dir + "/flight-" + stamp;
+    std::string partial = path + ".partial";
+    if (!makeDirectories(partial)) {
+        error = "cannot create " + partial + ": " + strerror(errno);
+        return false;
+    }
+
+    std::ofstream reason(partial + "/reason.txt");
+    reason << "Reason: " << job.reason << "\n"
+           << "Triggered: " << ctime(&job.triggered_at)
+           << "Snapshots: " << job.history->size() << "\n"
+           << "Captured PIDs:";
+    for (int pid : job.pids) {
+        reason << " " << pid;
+    }
+    reason << "\n";
+    if (!job.monitor_state.empty()) {
+        reason << "Monitor: " << job.monitor_state << "\n";
+    }
+    reason.close();
+
+    // Processes first: they may exit at any moment
+    for (int pid : job.pids) {
+        captureProcess(pid, partial + "/proc-" + std::to_string(pid));
+    }
+    writeTimeline(*job.history, partial);
+
+    if (rename(partial.c_str(), path.c_str()) != 0) {
+        error = "cannot rename " + partial + ": " + strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+// System totals per snapshot, and every process of every snapshot
+void FlightRecorder::writeTimeline(const SnapshotHistory& history, const std::string& dir) {
+    std::ofstream timeline(dir + "/timeline.csv");
+    std::ofstream procs(dir + "/processes.csv");
+    timeline << "time,cpu_percent,mem_used_kb,mem_available_kb,swap_used_kb,cached_kb,cores\n";
+    procs << "time,pid,name,cpu_percent,mem_percent,rss_kb,io_read_bytes,io_write_bytes\n";
+
+    if (history.empty()) {
+        return;
+    }
+
+    Snapshot snapshot;
+    for (uint64_t seq = history.oldestSeq(); seq <= history.newestSeq(); seq++) {
+        if (!history.load(seq, snapshot)) {
+            continue;
+        }
+        long long t = static_cast<long long>(snapshot.taken_at);
+
+        timeline << t << "," << snapshot.cpu.total_usage << "," << snapshot.memory.used << ","
+                 << snapshot.memory.available << "," << snapshot.memory.swap_used << "," << snapshot.memory.cached << ",";
+        for (size_t i = 0; i < snapshot.cpu.core_usage.size(); i++) {
+            timeline << (i > 0 ? " " : "") << snapshot.cpu.core_usage[i];
+        }
+        timeline << "\n";
+
+        for (const auto& proc : snapshot.processes) {
+            procs << t << "," << proc.pid << ",\"" << proc.name << "\"," << proc.cpu_percent << ","
+                  << proc.mem_percent << "," << proc.rss_kb << "," << proc.io_read_bytes << ","
+                  << proc.io_write_bytes << "\n";
+        }
+    }
+}
+
+// One-time deep look at a process
+void FlightRecorder::captureProcess(int pid, const std::string& dir) {
+    std::string proc_dir = "/proc/" + std::to_string(pid);
+    if (mkdir(dir.c_str(), 0755) != 0) {
+        return;
+    }
+
+    copyProcFile(proc_dir + "/cmdline", dir + "/cmdline");
+    for (const char* name : CAPTURE_FILES) {
+        copyProcFile(proc_dir + "/" + name, dir + "/" + name);
+    }
+
+    // Open files as "fd -> target"
+    std::ofstream fds(dir + "/fds");
+    DIR* fd_dir = opendir((proc_dir + "/fd").c_str());
+    if (fd_dir == nullptr) {
+        fds << "unreadable: " << strerror(errno) << "\n";
+        return;
+    }
+    struct dirent* entry;
+    char target[4096];
+    while ((entry = readdir(fd_dir)) != nullptr) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        std::string link = proc_dir + "/fd/" + entry->d_name;
+        ssize_t len = readlink(link.c_str(), target, sizeof(target) - 1);
+        target[len > 0 ? len : 0] = '\0';
+        fds << entry->d_name << " -> " << target << "\n";
+    }
+    closedir(fd_dir);
+}
@@ -0,0 +1,179 @@
+#include "../include/history.h"
+#include <algorithm>
+#include <climits>
+
+// Rebuild the string table once it grows past this many entries
+static const size_t MAX_INTERNED_STRINGS = 65536;
+
+SnapshotHistory::SnapshotHistory(size_t capacity) {
+    setCapacity(capacity);
+}
+
+// Change the number of retained snapshots
+void SnapshotHistory::setCapacity(size_t capacity) {
+    slots.clear();
+    slots.resize(std::max<size_t>(capacity, 1));
+    count = 0;
+    strings.clear();
+    string_ids.clear();
+}
+
+// Look up or add a string in the shared table
+uint32_t SnapshotHistory::intern(const std::string& s) {
+    auto it = string_ids.find(s);
+    if (it != string_ids.end()) {
+        return it->second;
+    }
+
+    uint32_t id = static_cast<uint32_t>(strings.size());
+    strings.push_back(s);
+    string_ids.emplace(s, id);
+    return id;
+}
+
+// Drop strings no longer referenced by any stored snapshot
+void SnapshotHistory::compactStrings() {
+    std::vector<std::string> old_strings;
+    old_strings.swap(strings);
+    string_ids.clear();
+
+    for (uint64_t seq = oldestSeq(); count > 0 && seq <= newestSeq(); seq++) {
+        CompactSnapshot& snap = slots[seq % slots.size()];
+        for (auto& disk : snap.disks) {
+            disk.device_id = intern(old_strings[disk.device_id]);
+            disk.mount_id = intern(old_strings[disk.mount_id]);
+        }
+        for (auto& proc : snap.processes) {
+            proc.name_id = intern(old_strings[proc.name_id]);
+        }
+    }
+}
+
+// Store a new snapshot
+void SnapshotHistory::push(const CPUInfo& cpu, const MemoryInfo& memory,
+                           const std::vector<DiskInfo>& disks, const std::vector<Process>& procs) {
+    // The slot being overwritten is evicted first so compaction never sees it
+    if (count == slots.size()) {
+        count--;
+    }
+
+    if (strings.size() > MAX_INTERNED_STRINGS) {
+        compactStrings();
+    }
+
+    CompactSnapshot& snap = slots[next_seq % slots.size()];
+    snap.taken_at = time(nullptr);
+    snap.total_usage = cpu.total_usage;
+    snap.core_usage.assign(cpu.core_usage.begin(), cpu.core_usage.end());
+    snap.memory = memory;
+
+    snap.disks.clear();
+    for (const auto& disk : disks) {
+        CompactDisk cd;
+        cd.device_id = intern(disk.device);
+        cd.mount_id = intern(disk.mount_point);
+        cd.total_space = disk.total_space;
+        cd.free_space = disk.free_space;
+        cd.read_latency_ms = disk.read_latency_ms;
+        cd.io_operations = disk.io_operations;
+        snap.disks.push_back(cd);
+    }
+
+    snap.processes.clear();
+    for (const auto& proc : procs) {
+        CompactProcess cp;
+        cp.pid = proc.pid;
+        cp.name_id = intern(proc.name);
+        cp.cpu_percent = proc.cpu_percent;
+        cp.mem_percent = proc.mem_percent;
+        cp.rss_kb = static_cast<uint32_t>(std::min<unsigned long>(proc.rss_kb, UINT32_MAX));
+        cp.start_time = proc.start_time;
+        cp.io_read_bytes = proc.io_read_bytes;
+        cp.io_write_bytes = proc.io_write_bytes;
+        snap.processes.push_back(cp);
+    }
+    std::sort(snap.processes.begin(), snap.processes.end(),
+        [](const CompactProcess& a, const CompactProcess& b) {
+            return a.pid < b.pid;
+        });
+
+    next_seq++;
+    count++;
+}
+
+// Decode a stored snapshot
+bool SnapshotHistory::load(uint64_t seq, CPUInfo& cpu, MemoryInfo& memory,
+                           std::vector<DiskInfo>& disks, std::vector<Process>& procs) const {
+    if (!contains(seq)) {
+        return false;
+    }
+
+    const CompactSnapshot& snap = slot(seq);
+
+    cpu.total_usage = snap.total_usage;
+    cpu.core_usage = snap.core_usage;
+    cpu.num_cores = static_cast<int>(snap.core_usage.size());
+    memory = snap.memory;
+
+    disks.resize(snap.disks.size());
+    for (size_t i = 0; i < snap.disks.size(); i++) {
+        const CompactDisk& cd = snap.disks[i];
+        DiskInfo& disk = disks[i];
+        disk.device = strings[cd.device_id];
+        disk.mount_point = strings[cd.mount_id];
+        disk.total_space = cd.total_space;
+        disk.free_space = cd.free_space;
+        disk.used_space = cd.total_space - cd.free_space;
+        disk.percent_used = (cd.total_space > 0) ? 100.0f * disk.used_space / cd.total_space : 0.0f;
+        disk.read_latency_ms = cd.read_latency_ms;
+        disk.io_operations = cd.io_operations;
+    }
+
+    procs.resize(snap.processes.size());
+    for (size_t i = 0; i < snap.processes.size(); i++) {
+        const CompactProcess& cp = snap.processes[i];
+        Process& proc = procs[i];
+        proc.pid = cp.pid;
+        proc.name = strings[cp.name_id];
+        proc.cpu_percent = cp.cpu_percent;
+        proc.mem_percent = cp.mem_percent;
+        proc.rss_kb = cp.rss_kb;
+        proc.start_time = cp.start_time;
+        proc.io_read_bytes = cp.io_read_bytes;
+        proc.io_write_bytes = cp.io_write_bytes;
+        proc.cpu_ticks = 0;     // Not kept in the history
+        proc.major_faults = 0;
+        proc.run_delay_ns = 0;
+        proc.uid = -1;
+        proc.pressure = 0.0f;
+    }
+
+    return true;
+}
+
+bool SnapshotHistory::load(uint64_t seq, Snapshot& snapshot) const {
+    if (!load(seq, snapshot.cpu, snapshot.memory, snapshot.disks, snapshot.processes)) {
+        return false;
+    }
+    snapshot.taken_at = slot(seq).taken_at;
+    return true;
+}
+
+// Wall-clock time a snapshot was taken
+time_t SnapshotHistory::timestamp(uint64_t seq) const {
+    return contains(seq) ? slot(seq).taken_at : 0;
+}
+
+// Approximate heap usage of the stored snapshots
+size_t SnapshotHistory::memoryUsage() const {
+    size_t bytes = slots.capacity() * sizeof(CompactSnapshot);
+    for (const auto& snap : slots) {
+        bytes += snap.core_usage.capacity() * sizeof(float);
+        bytes += snap.disks.capacity() * sizeof(CompactDisk);
+        bytes += snap.processes.capacity() * sizeof(CompactProcess);
+    }
+    for (const auto& s : strings) {
+        bytes += s.capacity() + sizeof(std::string);
+    }
+    return bytes;
+}
@@ -0,0 +1,190 @@
+#include "../include/monitor.h"
+#include <sstream>
+#include <algorithm>
+#include <ctime>
+#include <cstring>
+#include <cctype>
+
+// Seconds a critical kernel event stays in the banner
+static const int KERNEL_BANNER_SECONDS = 60;
+
+// Minimum seconds between desktop notifications of the same event type
+static const int KERNEL_NOTIFY_INTERVAL = 10;
+
+// Read new kernel log records and act on the recognised ones
+void ActivityMonitor::pollKernelLog() {
+    TraceSpan span("events", "pollKernelLog");
+    size_t added = kernel_log.poll();
+    if (added == 0) {
+        return;
+    }
+
+    // Oldest first, so the banner ends up showing the newest event
+    size_t available = std::min(added, kernel_log.eventCount());
+    for (size_t i = available; i > 0; i--) {
+        handleKernelEvent(kernel_log.event(i - 1));
+    }
+
+    // Show new events without waiting for the next frame interval
+    last_frame = std::chrono::high_resolution_clock::time_point();
+}
+
+// True if 'name' is the device 'subject' or one of its partitions: sda1 for
+// sda, nvme0n1p2 or mmcblk0p1 for subjects that end in a digit (not sdaa1 or dm-10)
+static bool onDevice(const std::string& name, const char* subject, size_t subject_len) {
+    if (name.size() < subject_len || name.compare(0, subject_len, subject) != 0) {
+        return false;
+    }
+    size_t pos = subject_len;
+    if (pos == name.size()) {
+        return true;
+    }
+    if (isdigit(static_cast<unsigned char>(subject[subject_len - 1]))) {
+        if (name[pos] != 'p') {
+            return false;
+        }
+        pos++;
+    }
+    return pos < name.size() &&
+           std::all_of(name.begin() + pos, name.end(), [](char c) { return isdigit(static_cast<unsigned char>(c)) != 0; });
+}
+
+// Describe the process or the mounts a kernel event refers to
+std::string ActivityMonitor::kernelEventTarget(const KernelEvent& event) const {
+    if (event.pid >= 0) {
+        return "PID " + std::to_string(event.pid) + " (" + event.subject + ")";
+    }
+    if (event.subject[0] == '\0') {
+        return "";
+    }
+
+    // An error on a whole disk (sda) affects all of its partitions (sda1, sda2, ...)
+    std::string mounts;
+    size_t subject_len = strlen(event.subject);
+    for (const auto& disk : disk_info) {
+        size_t slash = disk.device.rfind('/');
+        std::string name = slash == std::string::npos ? disk.device : disk.device.substr(slash + 1);
+        if (onDevice(name, event.subject, subject_len)) {
+            mounts += (mounts.empty() ? "" : ", ") + disk.mount_point;
+        }
+    }
+
+    return mounts.empty() ? std::string(event.subject) : std::string(event.subject) + " on " + mounts;
+}
+
+// Raise the banner and a desktop notification for events logged while we run
+void ActivityMonitor::handleKernelEvent(const KernelEvent& event) {
+    std::string target = kernelEventTarget(event);
+
+    if (config.debug_mode) {
+        debugLog(std::string("Kernel event: ") + KernelLogTap::typeName(event.type) +
+                 (event.historical ? " (before start)" : "") + " " + target + ": " + event.message);
+    }
+
+    if (event.historical) {
+        return;
+    }
+
+    time_t now = time(nullptr);
+    if (KernelLogTap::isCritical(event.type)) {
+        kernel_alert = std::string(KernelLogTap::typeName(event.type)) + (target.empty() ? "" : ": " + target);
+        kernel_alert_until = now + KERNEL_BANNER_SECONDS;
+        triggerFlightRecorder(kernel_alert, event.pid);
+    }
+
+    if (config.system_notifications && now - kernel_notified_at[event.type] >= KERNEL_NOTIFY_INTERVAL) {
+        kernel_notified_at[event.type] = now;
+        std::string title = std::string("Kernel: ") + KernelLogTap::typeName(event.type);
+        std::string message = (target.empty() ? "" : target + "\n") + event.message;
+        sendSystemNotification(title, message, KernelLogTap::isCritical(event.type));
+    }
+}
+
+// Show or hide the kernel event list
+void ActivityMonitor::toggleKernelEvents() {
+    if (process_view == VIEW_KERNEL_EVENTS) {
+        setProcessView(VIEW_PROCESSES);
+    } else {
+        setProcessView(VIEW_KERNEL_EVENTS);
+        kernel_alert_until = 0;
+    }
+}
+
+// Draw recent kernel events in place of the process list
+void ActivityMonitor::displayKernelEvents() {
+    screen->clear(process_win);
+    screen->box(process_win);
+
+    int height = process_win.height;
+    int width = process_win.width;
+    int text_width = std::max(0, width - 4);
+
+    std::ostringstream oss;
+    oss << " Kernel events: " << kernel_log.eventCount() << " (" << kernel_log.recordsRead() << " records read";
+    if (kernel_log.recordsLost() > 0) {
+        oss << ", " << kernel_log.recordsLost() << " lost";
+    }
+    oss << ") ('e' close) ";
+    screen->attrOn(process_win, COLOR_PAIR(5));
+    screen->print(process_win, 0, 2, "%s", oss.str().substr(0, text_width).c_str());
+    screen->attrOff(process_win, COLOR_PAIR(5));
+
+    if (!kernel_log.isOpen()) {
+        std::string reason = config.kernel_log ? "Cannot read /dev/kmsg: " + kernel_log.error() +
+                                                 " (reading it needs CAP_SYSLOG when kernel.dmesg_restrict=1)"
+                                               : "Kernel log watching is disabled (--no-kmsg)";
+        screen->print(process_win, 2, 2, "%s", reason.substr(0, text_width).c_str());
+        screen->refresh(process_win);
+        return;
+    }
+
+    screen->attrOn(process_win, A_BOLD);
+    screen->print(process_win, 1, 2, "%-8s %-14s %-30s %s", "Time", "Event", "Affects", "Message");
+    screen->attrOff(process_win, A_BOLD);
+
+    int rows = height - 3;
+    int total = static_cast<int>(kernel_log.eventCount());
+    view_offset = std::max(0, std::min(view_offset, total - rows));
+
+    for (int row = 0; row < rows && view_offset + row < total; row++) {
+        const KernelEvent& event = kernel_log.event(view_offset + row);
+
+        char time_str[16] = "--:--:--";
+        struct tm tm_info;
+        if (localtime_r(&event.wall_time, &tm_info) != nullptr) {
+            strftime(time_str, sizeof(time_str), "%H:%M:%S", &tm_info);
+        }
+
+        // Events from before we started are context, not news
+        attr_t attrs = event.historical ? A_DIM : COLOR_PAIR(KernelLogTap::isCritical(event.type) ? 3 : 2);
+        std::string target = kernelEventTarget(event);
+
+        char line[512];
+        snprintf(line, sizeof(line), "%-8s %-14s %-30.30s %s", time_str, KernelLogTap::typeName(event.type),
+                 target.c_str(), event.message);
+
+        screen->attrOn(process_win, attrs);
+        screen->print(process_win, row + 2, 2, "%s", std::string(line).substr(0, text_width).c_str());
+        screen->attrOff(process_win, attrs);
+    }
+
+    screen->refresh(process_win);
+}
+
+// Flag the latest critical kernel event on the process panel border
+void ActivityMonitor::displayKernelBanner() {
+    if (process_view == VIEW_KERNEL_EVENTS || time(nullptr) >= kernel_alert_until) {
+        return;
+    }
+
+    int width = process_win.width;
+    std::string banner = " KERNEL " + kernel_alert + " - 'e' for details ";
+    if (static_cast<int>(banner.length()) > width - 4) {
+        banner = banner.substr(0, std::max(0, width - 4));
+    }
+
+    screen->attrOn(process_win, COLOR_PAIR(3) | A_REVERSE | A_BOLD);
+    screen->print(process_win, process_win.height - 1, 2, "%s", banner.c_str());
+    screen->attrOff(process_win, COLOR_PAIR(3) | A_REVERSE | A_BOLD);
+    screen->refresh(process_win);
+}
@@ -0,0 +1,289 @@
+#include "../include/kernel_log.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Fragments that identify a record; 'subject' says how to find what it is about
+enum SubjectRule {
+    SUBJECT_NONE,
+    SUBJECT_KILLED,      // "Killed process 1234 (name)"
+    SUBJECT_TASK,        // "task name:1234 blocked for more than ..."
+    SUBJECT_BRACKETED,   // "... stuck for 22s! [name:1234]"
+    SUBJECT_PREFIX,      // "name[1234]: segfault at ..."
+    SUBJECT_DEV,         // "I/O error, dev sda, sector ..."
+    SUBJECT_DEVICE,      // "EXT4-fs error (device sda1): ..."
+    SUBJECT_PAREN        // "EXT4-fs (sda1): Remounting filesystem read-only"
+};
+
+struct KernelPattern {
+    const char* needle;
+    KernelEventType type;
+    SubjectRule subject;
+};
+
+static const KernelPattern PATTERNS[] = {
+    {"Killed process ", KEV_OOM_KILL, SUBJECT_KILLED},
+    {" blocked for more than ", KEV_HUNG_TASK, SUBJECT_TASK},
+    {"soft lockup", KEV_LOCKUP, SUBJECT_BRACKETED},
+    {"hard LOCKUP", KEV_LOCKUP, SUBJECT_NONE},
+    {"detected stalls", KEV_RCU_STALL, SUBJECT_NONE},
+    {"I/O error, dev ", KEV_IO_ERROR, SUBJECT_DEV},
+    {"Buffer I/O error on dev ", KEV_IO_ERROR, SUBJECT_DEV},
+    {"-fs error (device ", KEV_FS_ERROR, SUBJECT_DEVICE},
+    {"Remounting filesystem read-only", KEV_FS_READONLY, SUBJECT_PAREN},
+    {": segfault at ", KEV_SEGFAULT, SUBJECT_PREFIX},
+    {"Machine check events logged", KEV_MACHINE_CHECK, SUBJECT_NONE},
+    {"[Hardware Error]", KEV_MACHINE_CHECK, SUBJECT_NONE},
+};
+static const int PATTERN_COUNT = sizeof(PATTERNS) / sizeof(PATTERNS[0]);
+
+// Copy from 'src' up to (not including) any of 'stops' into a bounded buffer
+static void copyUntil(const char* src, const char* stops, char* out, size_t size) {
+    size_t n = 0;
+    while (src[n] != '\0' && strchr(stops, src[n]) == nullptr && n + 1 < size) {
+        out[n] = src[n];
+        n++;
+    }
+    out[n] = '\0';
+}
+
+static uint64_t monotonicMicros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+KernelLogTap::KernelLogTap() {
+    memset(candidates, -1, sizeof(candidates));
+    for (int i = 0; i < PATTERN_COUNT; i++) {
+        unsigned char first = static_cast<unsigned char>(PATTERNS[i].needle[0]);
+        for (int slot = 0; slot < MAX_CANDIDATES; slot++) {
+            if (candidates[first][slot] < 0) {
+                candidates[first][slot] = static_cast<signed char>(i);
+                break;
+            }
+        }
+    }
+}
+
+KernelLogTap::~KernelLogTap() {
+    close();
+}
+
+bool KernelLogTap::open() {
+    close();
+
+    fd = ::open("/dev/kmsg", O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        open_error = strerror(errno);
+        return false;
+    }
+
+    open_error.clear();
+    in_backlog = true;
+    head = 0;
+    count = 0;
+    records = 0;
+    lost = 0;
+    return true;
+}
+
+void KernelLogTap::close() {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+const KernelEvent& KernelLogTap::event(size_t index) const {
+    return events[(head + MAX_EVENTS - 1 - index) % MAX_EVENTS];
+}
+
+const char* KernelLogTap::typeName(KernelEventType type) {
+    switch (type) {
+        case KEV_OOM_KILL:      return "OOM kill";
+        case KEV_HUNG_TASK:     return "Hung task";
+        case KEV_LOCKUP:        return "Lockup";
+        case KEV_RCU_STALL:     return "RCU stall";
+        case KEV_IO_ERROR:      return "I/O error";
+        case KEV_FS_ERROR:      return "FS error";
+        case KEV_FS_READONLY:   return "FS read-only";
+        case KEV_SEGFAULT:      return "Segfault";
+        case KEV_MACHINE_CHECK: return "Hardware error";
+        default:                return "Kernel";
+    }
+}
+
+bool KernelLogTap::isCritical(KernelEventType type) {
+    return type != KEV_SEGFAULT && type != KEV_RCU_STALL;
+}
+
+// Find the earliest pattern in the message; returns its index or -1
+int KernelLogTap::classify(const char* message, const char** match) const {
+    for (const char* p = message; *p != '\0'; p++) {
+        const signed char* slots = candidates[static_cast<unsigned char>(*p)];
+        for (int slot = 0; slot < MAX_CANDIDATES && slots[slot] >= 0; slot++) {
+            const char* needle = PATTERNS[slots[slot]].needle;
+            if (strncmp(p, needle, strlen(needle)) == 0) {
+                *match = p;
+                return slots[slot];
+            }
+        }
+    }
+    return -1;
+}
+
+// Parse "level,seq,usec,flags;text\n[ KEY=value\n...]" held in 'record'
+bool KernelLogTap::parseRecord(size_t length, KernelEvent& event) {
+    char* text = record;
+    text[length] = '\0';
+
+    char* semicolon = strchr(text, ';');
+    if (semicolon == nullptr) {
+        return false;
+    }
+
+    // Dictionary lines follow the first newline; only the text matters here
+    char* message = semicolon + 1;
+    char* newline = strchr(message, '\n');
+    if (newline != nullptr) {
+        *newline = '\0';
+    }
+
+    const char* match = nullptr;
+    int pattern = classify(message, &match);
+    if (pattern < 0) {
+        return false;
+    }
+
+    char* cursor = text;
+    event.level = static_cast<int>(strtol(cursor, &cursor, 10) & 7);
+    event.seq = strtoull(cursor + 1, &cursor, 10);
+    event.timestamp_us = strtoull(cursor + 1, &cursor, 10);
+    event.type = PATTERNS[pattern].type;
+    event.pid = -1;
+    event.subject[0] = '\0';
+    snprintf(event.message, sizeof(event.message), "%s", message);
+
+    const char* p = nullptr;
+    switch (PATTERNS[pattern].subject) {
+        case SUBJECT_KILLED:
+            p = match + strlen(PATTERNS[pattern].needle);
+            event.pid = atoi(p);
+            p = strchr(p, '(');
+            if (p != nullptr) {
+                copyUntil(p + 1, ")", event.subject, sizeof(event.subject));
+            }
+            break;
+
+        case SUBJECT_TASK:
+            // Task names may contain ':'; the PID follows the last one before the match
+            p = strstr(message, "task ");
+            if (p != nullptr && p < match) {
+                const char* colon = match;
+                while (colon > p && *colon != ':') {
+                    colon--;
+                }
+                if (*colon == ':') {
+                    size_t len = std::min(static_cast<size_t>(colon - (p + 5)), sizeof(event.subject) - 1);
+                    memcpy(event.subject, p + 5, len);
+                    event.subject[len] = '\0';
+                    event.pid = atoi(colon + 1);
+                }
+            }
+            break;
+
+        case SUBJECT_BRACKETED:
+            p = strrchr(message, '[');
+            if (p != nullptr) {
+                const char* colon = strrchr(p, ':');
+                if (colon != nullptr) {
+                    size_t len = std::min(static_cast<size_t>(colon - (p + 1)), sizeof(event.subject) - 1);
+                    memcpy(event.subject, p + 1, len);
+                    event.subject[len] = '\0';
+                    event.pid = atoi(colon + 1);
+                }
+            }
+            break;
+
+        case SUBJECT_PREFIX:
+            p = strchr(message, '[');
+            if (p != nullptr && p < match) {
+                size_t len = std::min(static_cast<size_t>(p - message), sizeof(event.subject) - 1);
+                memcpy(event.subject, message, len);
+                event.subject[len] = '\0';
+                event.pid = atoi(p + 1);
+            }
+            break;
+
+        case SUBJECT_DEV:
+            copyUntil(match + strlen(PATTERNS[pattern].needle), ", ", event.subject, sizeof(event.subject));
+            break;
+
+        case SUBJECT_DEVICE:
+            copyUntil(match + strlen(PATTERNS[pattern].needle), ")", event.subject, sizeof(event.subject));
+            break;
+
+        case SUBJECT_PAREN:
+            p = strchr(message, '(');
+            if (p != nullptr && p < match) {
+                copyUntil(p + 1, ")", event.subject, sizeof(event.subject));
+            }
+            break;
+
+        case SUBJECT_NONE:
+            break;
+    }
+
+    return true;
+}
+
+size_t KernelLogTap::poll(size_t max_records) {
+    if (fd < 0) {
+        return 0;
+    }
+
+    uint64_t now_us = monotonicMicros();
+    time_t now = time(nullptr);
+    size_t added = 0;
+
+    for (size_t i = 0; i < max_records; i++) {
+        ssize_t n = read(fd, record, RECORD_SIZE - 1);
+        if (n < 0) {
+            if (errno == EPIPE) {
+                // Records were overwritten before we read them; the next read resumes
+                lost++;
+                continue;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            // EAGAIN: caught up with the log
+            in_backlog = false;
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+        records++;
+
+        KernelEvent& slot = events[head];
+        if (!parseRecord(static_cast<size_t>(n), slot)) {
+            continue;
+        }
+
+        slot.historical = in_backlog;
+        uint64_t age_us = now_us > slot.timestamp_us ? now_us - slot.timestamp_us : 0;
+        slot.wall_time = now - static_cast<time_t>(age_us / 1000000);
+
+        head = (head + 1) % MAX_EVENTS;
+        count = std::min(count + 1, MAX_EVENTS);
+        added++;
+    }
+
+    return added;
+}
@@ -1,4 +1,5 @@
 #include "../include/monitor.h"
+#include "../include/once.h"
 #include <iostream>
 #include <getopt.h>
 
@@ -13,6 +14,57 @@ void printUsage(const char* programName) {
               << "  -n, --no-notify          Disable system desktop notifications\n"
               << "  -d, --debug              Enable debug output\n"
               << "  -o, --debug-only         Run in debug-only mode (no UI)\n"
+              << "  -H, --history=COUNT      Number of snapshots kept for pause/scrub (default: 300)\n"
+              << "  -R, --renderer=BACKEND   Output backend: ansi, ncurses or auto (default: auto)\n"
+              << "      --cpu-budget=PERCENT Keep the monitor's own CPU use under PERCENT of one core\n"
+              << "                           by slowing refresh, process detail and frame rate\n"
+              << "      --bench-render[=N]   Render N frames (default 400) with each backend and\n"
+              << "                           report bytes and CPU time per frame, then exit\n"
+              << "      --profile-hz=HZ      Wait profiler sampling frequency (default: 100)\n"
+              << "      --profile-budget=N   Max threads the profiler reads per second (default: 2000)\n"
+              << "      --no-kmsg            Do not watch the kernel log (/dev/kmsg) for events\n"
+              << "      --perf[=N]           Exact CPU, context-switch and page-fault counts from\n"
+              << "                           perf_event for the top N processes (default 10)\n"
+              << "      --delays[=N]         CPU, I/O, swap-in and reclaim wait from taskstats delay\n"
+              << "                           accounting for the top N and watched processes (default 20)\n"
+              << "      --delay-cpus=LIST    CPUs whose process exits --delays reports (default: all)\n"
+              << "      --pressure=WEIGHTS   Weights of the pressure score used by 's' and 'k', e.g.\n"
+              << "                           cpu=2,rss=1,io=1,faults=1,runq=1 (default: all 1)\n"
+              << "      --cache-path=DIR     Page-cache explorer scans this tree instead of the\n"
+              << "                           files open by the top processes\n"
+              << "      --cache-rescan=SEC   Seconds between page-cache explorer passes (default: 30)\n"
+              << "      --cache-budget=PCT   CPU share for the page-cache explorer (default: 5)\n"
+              << "      --cache-rate=N       Files per second the explorer may open (default: 200)\n"
+              << "      --write-path=DIR     Filesystem watched by the write hotspot view (default: /)\n"
+              << "      --stress=SPEC        Generate load alongside the monitor, e.g.\n"
+              << "                           cpu=50@0-1,mem=512@64,fork=100,write=20,read=20\n"
+              << "                           (CPU% per core, MB at MB/s, forks/s, MB/s)\n"
+              << "      --stress-duration=SEC  Stop the load after SEC seconds (default: until exit,\n"
+              << "                           30 with --stress-report)\n"
+              << "      --stress-report      No UI: print injected vs. measured values each refresh\n"
+              << "      --flight-dir=DIR     On CPU alerts and critical kernel events, dump the\n"
+              << "                           snapshot history and process details below DIR\n"
+              << "      --flight-max=N       Maximum flight recorder dumps per hour (default: 4)\n"
+              << "      --watch=LIST         Sample these processes at the watch cadence, e.g.\n"
+              << "                           postgres:cpu=90:rss=4096,nginx,1234 (name or PID,\n"
+              << "                           optional CPU% and RSS MB alert limits)\n"
+              << "      --watch-interval=MS  Watch list sampling interval (default: 100)\n"
+              << "      --group=NAME=PATTERNS  Application group for the app view: processes whose\n"
+              << "                           name contains one of the |-separated patterns, or\n"
+              << "                           whose command line contains a cmd:PATTERN; repeatable\n"
+              << "      --trace=FILE         Record the monitor's own spans and metrics as a Chrome\n"
+              << "                           trace (open in Perfetto or chrome://tracing)\n"
+              << "      --trace-max=MB       Stop recording when the trace reaches MB (default: 64)\n"
+              << "      --process-log=FILE   Append every process seen (command line, start and\n"
+              << "                           exit time, CPU, peak RSS, I/O) to FILE\n"
+              << "      --search-log=TEXT    Print the processes in --process-log whose command\n"
+              << "                           line contains TEXT, newest first, and exit\n"
+              << "      --once[=MS]          Print one snapshot and exit, without terminal setup;\n"
+              << "                           CPU usage is sampled over MS (default: since boot)\n"
+              << "      --format=FORMAT      --once output: text, json or kv (default: text)\n"
+              << "      --fields=LIST        --once fields: cpu, cores, memory, swap, disks, procs\n"
+              << "                           or all (default: cpu,memory,swap,disks)\n"
+              << "      --top=N              Processes listed by --once for procs (default: 5)\n"
               << "  -h, --help               Display this help and exit\n"
               << std::endl;
 }
@@ -20,6 +72,11 @@ void printUsage(const char* programName) {
 // Main entry point
 int main(int argc, char* argv[]) {
     MonitorConfig config;
+    OnceOptions once;
+    std::string log_search;
+    bool search_log = false;
+    std::string trace_path;
+    int trace_max_mb = 64;
     
     static struct option long_options[] = {
         {"refresh-rate", required_argument, 0, 'r'},
@@ -28,6 +85,38 @@ int main(int argc, char* argv[]) {
         {"no-notify",    no_argument,       0, 'n'},
         {"debug",        no_argument,       0, 'd'},
         {"debug-only",   no_argument,       0, 'o'},
+        {"history",      required_argument, 0, 'H'},
+        {"renderer",     required_argument, 0, 'R'},
+        {"cpu-budget",   required_argument, 0, 'j'},
+        {"bench-render", optional_argument, 0, 'B'},
+        {"profile-hz",   required_argument, 0, 'P'},
+        {"profile-budget", required_argument, 0, 'b'},
+        {"no-kmsg",      no_argument,       0, 'K'},
+        {"perf",         optional_argument, 0, 'p'},
+        {"delays",       optional_argument, 0, 'y'},
+        {"delay-cpus",   required_argument, 0, 'u'},
+        {"pressure",     required_argument, 0, 'z'},
+        {"cache-path",   required_argument, 0, 'C'},
+        {"cache-rescan", required_argument, 0, 'S'},
+        {"cache-budget", required_argument, 0, 'U'},
+        {"cache-rate",   required_argument, 0, 'F'},
+        {"write-path",   required_argument, 0, 'W'},
+        {"stress",       required_argument, 0, 'X'},
+        {"stress-duration", required_argument, 0, 'D'},
+        {"stress-report", no_argument,      0, 'Y'},
+        {"flight-dir",   required_argument, 0, 'G'},
+        {"flight-max",   required_argument, 0, 'M'},
+        {"watch",        required_argument, 0, 'L'},
+        {"watch-interval", required_argument, 0, 'I'},
+        {"group",        required_argument, 0, 'N'},
+        {"trace",        required_argument, 0, 'T'},
+        {"trace-max",    required_argument, 0, 'Z'},
+        {"process-log",  required_argument, 0, 'A'},
+        {"search-log",   required_argument, 0, 'V'},
+        {"once",         optional_argument, 0, 'O'},
+        {"format",       required_argument, 0, 'E'},
+        {"fields",       required_argument, 0, 'Q'},
+        {"top",          required_argument, 0, 'J'},
         {"help",         no_argument,       0, 'h'},
         {0, 0, 0, 0}
     };
@@ -35,7 +124,7 @@ int main(int argc, char* argv[]) {
     int opt;
     int option_index = 0;
     
-    while ((opt = getopt_long(argc, argv, "r:t:andoh", long_options, &option_index)) != -1) {
+    while ((opt = getopt_long(argc, argv, "r:t:andoH:R:h", long_options, &option_index)) != -1) {
         switch (opt) {
             case 'r':
                 config.refresh_rate_ms = std::stoi(optarg);
@@ -64,6 +153,199 @@ int main(int argc, char* argv[]) {
                 config.debug_mode = true;
                 config.debug_only_mode = true;
                 break;
+            case 'H':
+                config.history_size = std::stoi(optarg);
+                if (config.history_size < 2) {
+                    std::cerr << "Warning: History must hold at least 2 snapshots. Using 2." << std::endl;
+                    config.history_size = 2;
+                }
+                break;
+            case 'R':
+                config.renderer = optarg;
+                if (config.renderer != "ansi" && config.renderer != "ncurses" && config.renderer != "auto") {
+                    std::cerr << "Warning: Unknown renderer '" << config.renderer << "'. Using auto." << std::endl;
+                    config.renderer = "auto";
+                }
+                break;
+            case 'B':
+                config.render_benchmark_frames = optarg ? std::stoi(optarg) : 400;
+                if (config.render_benchmark_frames < 2) {
+                    config.render_benchmark_frames = 2;
+                }
+                break;
+            case 'P':
+                config.profile_hz = std::stoi(optarg);
+                if (config.profile_hz < 1 || config.profile_hz > 1000) {
+                    std::cerr << "Warning: Profile frequency must be between 1 and 1000 Hz. Using 100." << std::endl;
+                    config.profile_hz = 100;
+                }
+                break;
+            case 'b':
+                config.profile_budget = std::stoi(optarg);
+                if (config.profile_budget < 1) {
+                    std::cerr << "Warning: Profile budget must be positive. Using 2000." << std::endl;
+                    config.profile_budget = 2000;
+                }
+                break;
+            case 'K':
+                config.kernel_log = false;
+                break;
+            case 'p':
+                config.perf_top_n = optarg ? std::stoi(optarg) : 10;
+                if (config.perf_top_n < 1) {
+                    std::cerr << "Warning: --perf needs at least 1 process. Using 10." << std::endl;
+                    config.perf_top_n = 10;
+                }
+                break;
+            case 'y':
+                config.delay_top_n = optarg ? std::stoi(optarg) : 20;
+                if (config.delay_top_n < 1) {
+                    std::cerr << "Warning: --delays needs at least 1 process. Using 20." << std::endl;
+                    config.delay_top_n = 20;
+                }
+                break;
+            case 'u':
+                config.delay_exit_cpus = optarg;
+                break;
+            case 'j':
+                config.cpu_budget_percent = std::stod(optarg);
+                if (config.cpu_budget_percent <= 0.0 || config.cpu_budget_percent > 100.0) {
+                    std::cerr << "Warning: --cpu-budget must be above 0 and at most 100. Using 1." << std::endl;
+                    config.cpu_budget_percent = 1.0;
+                }
+                break;
+            case 'z': {
+                std::string error;
+                if (!parsePressureWeights(optarg, config.pressure_weights, error)) {
+                    std::cerr << "Error: --pressure: " << error << std::endl;
+                    return 1;
+                }
+                break;
+            }
+            case 'C':
+                config.cache_scan_path = optarg;
+                break;
+            case 'S':
+                config.cache_rescan_s = std::stoi(optarg);
+                if (config.cache_rescan_s < 1) {
+                    std::cerr << "Warning: Rescan interval must be at least 1 second. Using 30." << std::endl;
+                    config.cache_rescan_s = 30;
+                }
+                break;
+            case 'U':
+                config.cache_cpu_percent = std::stoi(optarg);
+                if (config.cache_cpu_percent < 1 || config.cache_cpu_percent > 100) {
+                    std::cerr << "Warning: Cache scan budget must be between 1 and 100%. Using 5%." << std::endl;
+                    config.cache_cpu_percent = 5;
+                }
+                break;
+            case 'F':
+                config.cache_files_per_sec = std::stoi(optarg);
+                if (config.cache_files_per_sec < 1) {
+                    std::cerr << "Warning: Cache scan rate must be positive. Using 200." << std::endl;
+                    config.cache_files_per_sec = 200;
+                }
+                break;
+            case 'W':
+                config.write_track_path = optarg;
+                break;
+            case 'X': {
+                std::string error;
+                if (!StressGenerator::parse(optarg, config.stress_loads, error)) {
+                    std::cerr << "Error: --stress: " << error << std::endl;
+                    return 1;
+                }
+                break;
+            }
+            case 'D':
+                config.stress_duration_s = std::stoi(optarg);
+                if (config.stress_duration_s < 1) {
+                    std::cerr << "Warning: Stress duration must be at least 1 second. Using 30." << std::endl;
+                    config.stress_duration_s = 30;
+                }
+                break;
+            case 'Y':
+                config.stress_report = true;
+                break;
+            case 'G':
+                config.flight_dir = optarg;
+                break;
+            case 'M':
+                config.flight_max_per_hour = std::stoi(optarg);
+                if (config.flight_max_per_hour < 1) {
+                    std::cerr << "Warning: Flight recorder needs at least 1 dump per hour. Using 4." << std::endl;
+                    config.flight_max_per_hour = 4;
+                }
+                break;
+            case 'L': {
+                std::string error;
+                if (!WatchSampler::parse(optarg, config.watch_rules, error)) {
+                    std::cerr << "Error: --watch: " << error << std::endl;
+                    return 1;
+                }
+                break;
+            }
+            case 'I':
+                config.watch_interval_ms = std::stoi(optarg);
+                if (config.watch_interval_ms < 10) {
+                    std::cerr << "Warning: Watch interval too low. Setting to 10ms minimum." << std::endl;
+                    config.watch_interval_ms = 10;
+                }
+                break;
+            case 'N': {
+                std::string error;
+                if (!AppGrouper::parse(optarg, config.app_groups, error)) {
+                    std::cerr << "Error: --group: " << error << std::endl;
+                    return 1;
+                }
+                break;
+            }
+            case 'T':
+                trace_path = optarg;
+                break;
+            case 'Z':
+                trace_max_mb = std::stoi(optarg);
+                if (trace_max_mb < 1) {
+                    std::cerr << "Warning: Trace size limit must be at least 1 MB. Using 64." << std::endl;
+                    trace_max_mb = 64;
+                }
+                break;
+            case 'A':
+                config.process_log_path = optarg;
+                break;
+            case 'V':
+                log_search = optarg;
+                search_log = true;
+                break;
+            case 'O':
+                once.enabled = true;
+                once.interval_ms = optarg ? std::stoi(optarg) : 0;
+                if (once.interval_ms < 0) {
+                    std::cerr << "Warning: Sampling interval cannot be negative. Using since boot." << std::endl;
+                    once.interval_ms = 0;
+                }
+                break;
+            case 'E':
+                if (!parseOnceFormat(optarg, once.format)) {
+                    std::cerr << "Error: --format must be text, json or kv" << std::endl;
+                    return 1;
+                }
+                break;
+            case 'Q': {
+                std::string error;
+                if (!parseOnceFields(optarg, once.fields, error)) {
+                    std::cerr << "Error: --fields: " << error << std::endl;
+                    return 1;
+                }
+                break;
+            }
+            case 'J':
+                once.top = std::stoi(optarg);
+                if (once.top < 0) {
+                    std::cerr << "Warning: --top cannot be negative. Using 5." << std::endl;
+                    once.top = 5;
+                }
+                break;
             case 'h':
                 printUsage(argv[0]);
                 return 0;
@@ -73,22 +355,65 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    if (search_log) {
+        if (config.process_log_path.empty()) {
+            std::cerr << "Error: --search-log needs --process-log=FILE" << std::endl;
+            return 1;
+        }
+        return runProcessSearch(config.process_log_path, log_search, std::cout);
+    }
+    
+    // Scripts and health checks: no monitor, no terminal, only the needed collectors
+    if (once.enabled) {
+        try {
+            return runOnce(once, std::cout);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    
+    if (config.stress_report) {
+        if (config.stress_loads.empty()) {
+            std::cerr << "Error: --stress-report needs --stress" << std::endl;
+            return 1;
+        }
+        if (config.stress_duration_s == 0) {
+            config.stress_duration_s = 30;
+        }
+    }
+    
+    // The stress summary is printed once the terminal has been restored
+    std::string stress_summary;
     try {
         ActivityMonitor monitor;
         monitor.setConfig(config);
         
-        if (config.debug_only_mode) {
+        // After setConfig, so stress workers are forked before the flusher thread exists
+        if (!trace_path.empty() && !Tracer::start(trace_path, static_cast<size_t>(trace_max_mb) * 1024 * 1024)) {
+            throw std::runtime_error("Cannot write trace file " + trace_path);
+        }
+        
+        if (config.render_benchmark_frames > 0) {
+            monitor.runRenderBenchmark(config.render_benchmark_frames);
+        } else if (config.debug_only_mode) {
             monitor.runDebugMode();
+        } else if (config.stress_report) {
+            monitor.runStressReport();
         } else {
             monitor.run();
+            stress_summary = monitor.stressSummary();
         }
     } catch (const std::exception& e) {
-        if (!config.debug_only_mode) {
+        if (!config.debug_only_mode && config.render_benchmark_frames == 0 && !config.stress_report) {
             endwin();
         }
+        Tracer::stop();
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
     }
     
+    Tracer::stop();
+    std::cout << stress_summary;
     return 0;
 } 
\ No newline at end of file
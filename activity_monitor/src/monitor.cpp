@@ -12,50 +12,65 @@
 #include <netinet/in.h>
 #include <iostream>
 #include <sys/types.h>
+#include <unistd.h>
+#include <cstdlib>
+
+// Processes with the most resident memory whose THP use is read each refresh
+static const size_t HUGE_PAGE_TOP_N = 5;
 
 // Initialize monitor
 ActivityMonitor::ActivityMonitor() {
     last_update = std::chrono::high_resolution_clock::now();
     last_notification = last_update;
+    last_frame = last_update;
+    last_tmux_check = last_update;
 }
 
 // Cleanup resources
 ActivityMonitor::~ActivityMonitor() {
+    cancelTmuxCheck();
+    
     if (debug_file.is_open()) {
         debug_file.close();
     }
     
-    if (!config.debug_only_mode) {
-        delwin(cpu_win);
-        delwin(mem_win);
-        delwin(disk_win);
-        delwin(process_win);
+    if (screen) {
+        destroyWindows();
+        screen.reset();
         
-        if (alert_win != nullptr) {
-            delwin(alert_win);
+        if (!terminal_lost) {
+            endwin();
         }
-        
-        endwin();
     }
 }
 
-// Setup display windows
+// Setup display windows for the current terminal size
 void ActivityMonitor::initializeWindows() {
-    int height, width;
-    getmaxyx(stdscr, height, width);
+    int height = terminal_height;
+    int width = terminal_width;
     
     int cpu_height = height / 4;
     int mem_height = height / 4;
     int disk_height = height / 4;
     int process_height = height / 2;
     
-    cpu_win = newwin(cpu_height, width, 0, 0);
-    mem_win = newwin(mem_height, width / 2, cpu_height, 0);
-    disk_win = newwin(disk_height, width / 2, cpu_height, width / 2);
-    process_win = newwin(process_height, width, height - process_height, 0);
-    
-    alert_win = nullptr;
-    scrollok(process_win, TRUE);
+    screen->resize(height, width);
+    screen->createPanel(cpu_win, cpu_height, width, 0, 0);
+    screen->createPanel(mem_win, mem_height, width / 2, cpu_height, 0);
+    screen->createPanel(disk_win, disk_height, width / 2, cpu_height, width / 2);
+    screen->createPanel(process_win, process_height, width, height - process_height, 0);
+}
+
+// Release display windows
+void ActivityMonitor::destroyWindows() {
+    screen->destroyPanel(cpu_win);
+    screen->destroyPanel(mem_win);
+    screen->destroyPanel(disk_win);
+    screen->destroyPanel(process_win);
+    
+    if (alert_win.open) {
+        screen->destroyPanel(alert_win);
+    }
 }
 
 // Handle terminal resize
@@ -67,16 +82,7 @@ void ActivityMonitor::resizeWindows() {
         terminal_height = new_height;
         terminal_width = new_width;
         
-        delwin(cpu_win);
-        delwin(mem_win);
-        delwin(disk_win);
-        delwin(process_win);
-        
-        if (alert_win != nullptr) {
-            delwin(alert_win);
-            alert_win = nullptr;
-        }
-        
+        destroyWindows();
         initializeWindows();
         clear();
         refresh();
@@ -86,8 +92,28 @@ void ActivityMonitor::resizeWindows() {
 // Apply configuration
 void ActivityMonitor::setConfig(const MonitorConfig& new_config) {
     config = new_config;
+    history.setCapacity(config.history_size);
+    watchdog.setBudget(config.refresh_rate_ms);
+    flight_recorder.configure(config.flight_dir, config.flight_max_per_hour);
+    app_grouper.configure(config.app_groups);
+    pressure.setWeights(config.pressure_weights);
+    paused = false;
+    
+    // Opened before the terminal is set up, so a bad path is reported plainly
+    if (!config.process_log_path.empty()) {
+        std::string error;
+        if (!process_log.open(config.process_log_path, true, error)) {
+            throw std::runtime_error("Cannot open process log: " + error);
+        }
+    }
     
-    if (!config.debug_only_mode) {
+    // Workers are forked before any thread exists and before the terminal is set up
+    if (!config.stress_loads.empty()) {
+        stress.start(config.stress_loads, config.stress_duration_s);
+        stress_last_sample = std::chrono::steady_clock::now();
+    }
+    
+    if (!config.debug_only_mode && config.render_benchmark_frames == 0 && !config.stress_report) {
         initscr();
         start_color();
         cbreak();
@@ -98,16 +124,39 @@ void ActivityMonitor::setConfig(const MonitorConfig& new_config) {
         
         getmaxyx(stdscr, terminal_height, terminal_width);
         
-        init_pair(1, COLOR_GREEN, COLOR_BLACK);
-        init_pair(2, COLOR_YELLOW, COLOR_BLACK);
-        init_pair(3, COLOR_RED, COLOR_BLACK);
-        init_pair(4, COLOR_CYAN, COLOR_BLACK);
-        init_pair(5, COLOR_WHITE, COLOR_BLUE);
+        // ncurses always handles terminal modes and input; output goes
+        // through the raw ANSI backend unless ncurses is asked for
+        const char* term = getenv("TERM");
+        bool ansi_capable = term != nullptr && *term != '\0' && std::string(term) != "dumb";
+        if (config.renderer == "ansi" || (config.renderer == "auto" && ansi_capable)) {
+            screen.reset(new AnsiRenderer(STDOUT_FILENO));
+        } else {
+            screen.reset(new CursesRenderer());
+        }
         
+        setupColors();
         initializeWindows();
+        installTerminalSignalHandlers();
     }
+    overhead.configure(config.cpu_budget_percent, config.refresh_rate_ms, screen != nullptr);
     
-    updateCPUInfo();
+    if (config.perf_top_n > 0 && !perf.probe()) {
+        debugLog("perf counters unavailable: " + perf.unavailableReason());
+    }
+    
+    if (config.delay_top_n > 0 && !delays.probe(config.delay_exit_cpus)) {
+        debugLog("delay accounting unavailable: " + delays.unavailableReason());
+    }
+    
+    if (config.kernel_log && config.render_benchmark_frames == 0 && !kernel_log.open()) {
+        debugLog("Kernel log unavailable: " + kernel_log.error());
+    }
+    
+    // Per-process collector detail only goes to the debug log
+    if (config.debug_mode) {
+        collector.setLogger([this](const std::string& message) { debugLog(message); });
+    }
+    collector.updateCPUInfo();
     
     if (config.debug_mode) {
         debugLog("Debug mode enabled");
@@ -117,12 +166,47 @@ void ActivityMonitor::setConfig(const MonitorConfig& new_config) {
         debugLog("  Show alerts: " + std::string(config.show_alert ? "true" : "false"));
         debugLog("  System notifications: " + std::string(config.system_notifications ? "true" : "false"));
         debugLog("  Debug-only mode: " + std::string(config.debug_only_mode ? "true" : "false"));
+        debugLog("  Renderer: " + std::string(screen ? screen->name() : "none"));
+        debugLog("  History size: " + std::to_string(config.history_size) + " snapshots");
     }
 }
 
+// Color pairs used by the display code
+void ActivityMonitor::setupColors() {
+    screen->definePair(1, COLOR_GREEN, COLOR_BLACK);
+    screen->definePair(2, COLOR_YELLOW, COLOR_BLACK);
+    screen->definePair(3, COLOR_RED, COLOR_BLACK);
+    screen->definePair(4, COLOR_CYAN, COLOR_BLACK);
+    screen->definePair(5, COLOR_WHITE, COLOR_BLUE);
+}
+
 // Sort process list
 void ActivityMonitor::sortProcesses() {
-    if (process_sort_type == 0) {
+    if (process_sort_type >= 2 && process_sort_type <= 5) {
+        // Wait share of the chosen kind; processes without a sample go last
+        int kind = process_sort_type;
+        auto waiting = [this, kind](const Process& proc) {
+            const DelaySample* sample = delays.sample(proc.pid);
+            if (sample == nullptr) {
+                return -1.0;
+            }
+            switch (kind) {
+                case 2: return sample->cpu_percent;
+                case 3: return sample->blkio_percent;
+                case 4: return sample->swapin_percent;
+                default: return sample->reclaim_percent;
+            }
+        };
+        std::stable_sort(processes.begin(), processes.end(),
+            [&waiting](const Process& a, const Process& b) {
+                return waiting(a) > waiting(b);
+            });
+    } else if (process_sort_type == 6) {
+        std::sort(processes.begin(), processes.end(),
+            [](const Process& a, const Process& b) {
+                return a.pressure > b.pressure;
+            });
+    } else if (process_sort_type == 0) {
         std::sort(processes.begin(), processes.end(), 
             [](const Process& a, const Process& b) { 
                 return a.cpu_percent > b.cpu_percent; 
@@ -206,304 +290,210 @@ std::string ActivityMonitor::createBar(float percent, int width, bool use_color)
     return bar;
 }
 
-// Update all system data
-void ActivityMonitor::collectData() {
-    updateCPUInfo();
-    updateMemoryInfo();
-    updateDiskInfo();
-    updateProcessInfo();
-    updateMemoryStats();
-    updateDiskLatency();
+// Read exact counters, then choose which processes to count next
+void ActivityMonitor::updatePerfCounters() {
+    TraceSpan span("collect", "updatePerfCounters");
+    if (config.perf_top_n <= 0 || !perf.available()) {
+        return;
+    }
+    
+    perf.update();
+    
+    std::vector<std::pair<float, int>> by_cpu;
+    by_cpu.reserve(live_processes.size());
+    for (const auto& proc : live_processes) {
+        by_cpu.push_back(std::make_pair(proc.cpu_percent, proc.pid));
+    }
+    size_t top = std::min(by_cpu.size(), static_cast<size_t>(config.perf_top_n));
+    std::partial_sort(by_cpu.begin(), by_cpu.begin() + top, by_cpu.end(),
+                      [](const std::pair<float, int>& a, const std::pair<float, int>& b) {
+                          return a.first > b.first;
+                      });
+    
+    std::vector<int> pids;
+    for (size_t i = 0; i < top; i++) {
+        pids.push_back(by_cpu[i].second);
+    }
+    if (selected_pid > 0 && std::find(pids.begin(), pids.end(), selected_pid) == pids.end()) {
+        pids.push_back(selected_pid);
+    }
+    
+    perf.track(pids);
 }
 
-// Update CPU information by reading /proc/stat
-void ActivityMonitor::updateCPUInfo() {
-    std::ifstream stat_file("/proc/stat");
-    if (!stat_file.is_open()) {
-        throw std::runtime_error("Failed to open /proc/stat");
-    }
-    
-    // Store previous CPU times for calculation
-    prev_cpu_times = curr_cpu_times;
-    curr_cpu_times.clear();
-    
-    std::string line;
-    size_t core_count = 0;
-    std::vector<float> core_percentages;
-    
-    while (std::getline(stat_file, line)) {
-        if (line.substr(0, 3) == "cpu") {
-            std::istringstream iss(line);
-            std::string cpu_label;
-            iss >> cpu_label;
-            
-            // Parse CPU times
-            CPUTimeInfo cpu_time;
-            iss >> cpu_time.user >> cpu_time.nice >> cpu_time.system >> cpu_time.idle 
-                >> cpu_time.iowait >> cpu_time.irq >> cpu_time.softirq >> cpu_time.steal;
-            
-            // Add this CPU time info to our current dataset
-            curr_cpu_times.push_back(cpu_time);
-            
-            // If we have previous data, calculate CPU usage percentage
-            if (!prev_cpu_times.empty() && prev_cpu_times.size() > core_count) {
-                const CPUTimeInfo& prev = prev_cpu_times[core_count];
-                const CPUTimeInfo& curr = cpu_time;
-                
-                // Calculate the deltas
-                unsigned long total_delta = curr.total() - prev.total();
-                unsigned long idle_delta = curr.idle_time() - prev.idle_time();
-                
-                if (total_delta > 0) {
-                    // The formula: CPU usage = 100% - (idle_delta / total_delta * 100%)
-                    float cpu_percentage = 100.0f * (1.0f - static_cast<float>(idle_delta) / total_delta);
-                    
-                    // For the first line (total CPU), update total_usage
-                    if (cpu_label == "cpu") {
-                        cpu_info.total_usage = cpu_percentage;
-                    } else {
-                        core_percentages.push_back(cpu_percentage);
-                    }
-                }
-            }
-            
-            core_count++;
-        } else if (line.substr(0, 4) != "cpu") {
-            // If we've processed all CPU lines, break
-            break;
-        }
+// Choose the processes to query, then read their wait times
+void ActivityMonitor::updateDelayAccounting() {
+    TraceSpan span("collect", "updateDelayAccounting");
+    if (config.delay_top_n <= 0 || !delays.available()) {
+        return;
+    }
+    
+    std::vector<std::pair<float, int>> by_cpu;
+    by_cpu.reserve(live_processes.size());
+    for (const auto& proc : live_processes) {
+        by_cpu.push_back(std::make_pair(proc.cpu_percent, proc.pid));
+    }
+    size_t top = std::min(by_cpu.size(), static_cast<size_t>(config.delay_top_n));
+    std::partial_sort(by_cpu.begin(), by_cpu.begin() + top, by_cpu.end(),
+                      [](const std::pair<float, int>& a, const std::pair<float, int>& b) {
+                          return a.first > b.first;
+                      });
+    
+    // Watched processes are the ones someone is asking about
+    std::vector<int> pids = watch_pids;
+    for (size_t i = 0; i < top; i++) {
+        pids.push_back(by_cpu[i].second);
     }
+    if (selected_pid > 0) {
+        pids.push_back(selected_pid);
+    }
+    std::sort(pids.begin(), pids.end());
+    pids.erase(std::unique(pids.begin(), pids.end()), pids.end());
     
-    // Update core count and usage data
-    cpu_info.num_cores = static_cast<int>(core_count) - 1;  // Subtract 1 for the total "cpu" line
-    cpu_info.core_usage = core_percentages;
+    delays.track(pids);
+    delays.update();
+    if (process_sort_type >= 2 && process_sort_type <= 5) {
+        sortProcesses();
+    }
 }
 
-// Update memory information by reading /proc/meminfo
-void ActivityMonitor::updateMemoryInfo() {
-    std::ifstream meminfo_file("/proc/meminfo");
-    if (!meminfo_file.is_open()) {
-        throw std::runtime_error("Failed to open /proc/meminfo");
-    }
-    
-    std::string line;
-    unsigned long mem_total = 0, mem_free = 0, mem_available = 0;
-    unsigned long swap_total = 0, swap_free = 0;
-    unsigned long cached = 0, buffers = 0;
-    
-    while (std::getline(meminfo_file, line)) {
-        std::istringstream iss(line);
-        std::string key;
-        unsigned long value;
-        std::string unit;
-        
-        iss >> key >> value >> unit;
-        
-        if (key == "MemTotal:") {
-            mem_total = value;
-        } else if (key == "MemFree:") {
-            mem_free = value;
-        } else if (key == "MemAvailable:") {
-            mem_available = value;
-        } else if (key == "SwapTotal:") {
-            swap_total = value;
-        } else if (key == "SwapFree:") {
-            swap_free = value;
-        } else if (key == "Cached:") {
-            cached = value;
-        } else if (key == "Buffers:") {
-            buffers = value;
+// AnonHugePages of the largest processes; smaps_rollup walks every
+// mapping, so only a few are read
+void ActivityMonitor::updateHugePageUsers() {
+    TraceSpan span("collect", "updateHugePageUsers");
+    std::vector<std::pair<unsigned long, size_t>> by_rss;
+    by_rss.reserve(live_processes.size());
+    for (size_t i = 0; i < live_processes.size(); i++) {
+        by_rss.push_back(std::make_pair(live_processes[i].rss_kb, i));
+    }
+    size_t top = std::min(by_rss.size(), HUGE_PAGE_TOP_N);
+    std::partial_sort(by_rss.begin(), by_rss.begin() + top, by_rss.end(),
+                      [](const std::pair<unsigned long, size_t>& a, const std::pair<unsigned long, size_t>& b) {
+                          return a.first > b.first;
+                      });
+    
+    huge_page_users.clear();
+    for (size_t i = 0; i < top; i++) {
+        const Process& proc = live_processes[by_rss[i].second];
+        unsigned long anon_huge_kb = readAnonHugePages(proc.pid);
+        if (anon_huge_kb > 0) {
+            huge_page_users.push_back(HugePageUser{proc.pid, proc.name, anon_huge_kb});
+        }
+    }
+    std::sort(huge_page_users.begin(), huge_page_users.end(),
+              [](const HugePageUser& a, const HugePageUser& b) { return a.anon_huge_kb > b.anon_huge_kb; });
+}
+
+// Collect through the shared core and take over its results
+void ActivityMonitor::updateSystemInfo() {
+    collector.setProcessDetail(tick_plan.process_detail);
+    collector.collect(tick_plan.scan_processes);
+    cpu_info = collector.cpu();
+    memory_info = collector.memory();
+    disk_info = collector.disks();
+    
+    // Between process scans the table of the last one stays
+    if (tick_plan.scan_processes) {
+        live_processes = collector.processes();
+        pressure.update(live_processes);
+        if (!paused) {
+            processes = live_processes;
+            sortProcesses();
         }
     }
+}
+
+// Update all system data, as much of it as the watchdog allows
+void ActivityMonitor::collectData() {
+    TraceSpan span("collect", "collectData");
+    auto tick_start = std::chrono::steady_clock::now();
+    bool detail_was_off = !tick_plan.process_detail;
+    tick_plan = watchdog.plan();
+    if (!overhead.settings().process_detail) {
+        tick_plan.process_detail = false;
+    }
     
-    // Calculate used memory and percentages
-    unsigned long mem_used = mem_total - mem_available;
-    float mem_percent = (mem_total > 0) ? (100.0f * mem_used / mem_total) : 0.0f;
+    // Counters held while the detail was off would read as one burst
+    if (tick_plan.process_detail && detail_was_off) {
+        pressure.restartRates();
+        app_grouper.restartRates();
+    }
     
-    unsigned long swap_used = swap_total - swap_free;
-    float swap_percent = (swap_total > 0) ? (100.0f * swap_used / swap_total) : 0.0f;
+    updateSystemInfo();
+    if (tick_plan.scan_processes) {
+        bool log_was_writable = process_log.isWritable();
+        process_log.update(live_processes);
+        if (log_was_writable && !process_log.isWritable()) {
+            debugLog("Process log: " + process_log.error());
+        }
+        updateStressReadings();
+    }
+    if (tick_plan.process_detail) {
+        updatePerfCounters();
+    }
+    updateWatchTargets();
+    if (tick_plan.process_detail) {
+        updateDelayAccounting();
+        updateHugePageUsers();
+    }
+    
+    // Application groups are kept up to date only while shown
+    if (process_view == VIEW_APPS && tick_plan.scan_processes) {
+        TraceSpan groups_span("collect", "updateAppGroups");
+        app_grouper.update(live_processes);
+    }
     
-    // Update memory info structure
-    memory_info.total = mem_total;
-    memory_info.free = mem_free;
-    memory_info.available = mem_available;
-    memory_info.used = mem_used;
-    memory_info.percent_used = mem_percent;
+    if (tick_plan.record_history) {
+        history.push(cpu_info, memory_info, disk_info, live_processes);
+    }
     
-    memory_info.swap_total = swap_total;
-    memory_info.swap_free = swap_free;
-    memory_info.swap_used = swap_used;
-    memory_info.swap_percent_used = swap_percent;
+    // Alerts always evaluate live data, even while the view is paused
+    checkAndSendNotifications();
+    checkFlightTriggers();
     
-    memory_info.cached = cached;
-    memory_info.buffers = buffers;
-}
-
-// Update disk information using statvfs
-void ActivityMonitor::updateDiskInfo() {
-    // Read /proc/mounts to get mounted filesystems
-    std::ifstream mounts_file("/proc/mounts");
-    if (!mounts_file.is_open()) {
-        throw std::runtime_error("Failed to open /proc/mounts");
+    if (paused) {
+        loadHistoryView(history_cursor);
+    } else if (process_view == VIEW_DIFF) {
+        updateDiff();
     }
     
-    disk_info.clear();
+    Tracer::counter("cpu total %", cpu_info.total_usage);
+    Tracer::counter("memory used %", memory_info.percent_used);
+    Tracer::counter("processes", static_cast<double>(live_processes.size()));
     
-    std::string line;
-    while (std::getline(mounts_file, line)) {
-        std::istringstream iss(line);
-        std::string device, mount_point, fs_type, options;
-        int dump, pass;
-        
-        iss >> device >> mount_point >> fs_type >> options >> dump >> pass;
-        
-        // Skip non-physical filesystems
-        if (fs_type == "proc" || fs_type == "sysfs" || fs_type == "devpts" || 
-            fs_type == "tmpfs" || fs_type == "devtmpfs" || fs_type == "debugfs" ||
-            mount_point.substr(0, 4) == "/sys" || mount_point.substr(0, 5) == "/proc" ||
-            mount_point.substr(0, 4) == "/dev" || mount_point.substr(0, 4) == "/run") {
-            continue;
-        }
-        
-        // Get disk usage information
-        struct statvfs stat;
-        if (statvfs(mount_point.c_str(), &stat) != 0) {
-            continue;  // Skip if we can't get stats
-        }
-        
-        DiskInfo info;
-        info.device = device;
-        info.mount_point = mount_point;
-        
-        // Calculate sizes in KB
-        const unsigned long block_size = stat.f_frsize;
-        info.total_space = (stat.f_blocks * block_size) / 1024;
-        info.free_space = (stat.f_bfree * block_size) / 1024;
-        info.used_space = info.total_space - info.free_space;
-        
-        // Calculate percentage
-        if (info.total_space > 0) {
-            info.percent_used = 100.0f * static_cast<float>(info.used_space) / info.total_space;
-        } else {
-            info.percent_used = 0.0f;
-        }
-        
-        disk_info.push_back(info);
+    // The page-cache explorer follows the current top processes
+    if (process_view == VIEW_PAGE_CACHE && config.cache_scan_path.empty()) {
+        page_cache.setPids(cacheScanPids());
+    }
+    
+    double tick_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tick_start).count();
+    Tracer::counter("refresh ms", tick_ms);
+    if (watchdog.record(tick_ms)) {
+        std::ostringstream oss;
+        oss << "Refresh took " << std::fixed << std::setprecision(1) << tick_ms << " ms of "
+            << watchdog.budget() << " ms: level " << watchdog.level() << " ("
+            << TickWatchdog::levelName(watchdog.level()) << "), " << watchdog.summary();
+        debugLog(oss.str());
     }
 }
 
-// Update process information by scanning /proc directory
-void ActivityMonitor::updateProcessInfo() {
-    processes.clear();
-    
-    // Open the /proc directory
-    DIR* proc_dir = opendir("/proc");
-    if (proc_dir == nullptr) {
-        throw std::runtime_error("Failed to open /proc directory");
-    }
-    
-    // Get total system memory for percentage calculations
-    unsigned long total_memory = memory_info.total;
-    
-    struct dirent* entry;
-    while ((entry = readdir(proc_dir)) != nullptr) {
-        // Check if the entry is a directory and name is a number (PID)
-        if (entry->d_type == DT_DIR) {
-            std::string name = entry->d_name;
-            bool is_pid = true;
-            for (char c : name) {
-                if (!std::isdigit(c)) {
-                    is_pid = false;
-                    break;
-                }
-            }
-            
-            if (!is_pid) {
-                continue;
-            }
-            
-            int pid = std::stoi(name);
-            
-            // Get process status
-            std::string status_path = "/proc/" + name + "/status";
-            std::ifstream status_file(status_path);
-            if (!status_file.is_open()) {
-                continue;  // Process might have terminated
-            }
-            
-            Process proc;
-            proc.pid = pid;
-            proc.name = "unknown";
-            proc.cpu_percent = 0.0f;
-            proc.mem_percent = 0.0f;
-            
-            // Read status file
-            std::string line;
-            unsigned long vm_rss = 0;
-            
-            while (std::getline(status_file, line)) {
-                if (line.compare(0, 5, "Name:") == 0) {
-                    proc.name = line.substr(6);
-                    // Trim whitespace
-                    proc.name.erase(0, proc.name.find_first_not_of(" \t"));
-                    proc.name.erase(proc.name.find_last_not_of(" \t") + 1);
-                } else if (line.compare(0, 6, "VmRSS:") == 0) {
-                    std::istringstream iss(line.substr(6));
-                    iss >> vm_rss;
-                }
-            }
-            
-            // Calculate memory percentage
-            if (total_memory > 0) {
-                proc.mem_percent = 100.0f * static_cast<float>(vm_rss) / total_memory;
-            }
-            
-            // Read process stat for CPU usage
-            std::string stat_path = "/proc/" + name + "/stat";
-            std::ifstream stat_file(stat_path);
-            if (stat_file.is_open()) {
-                std::string content;
-                std::getline(stat_file, content);
-                std::istringstream iss(content);
-                
-                // Skip PID and name fields
-                int dummy_pid;
-                std::string dummy_name;
-                iss >> dummy_pid >> dummy_name;
-                
-                // Skip to utime and stime (fields 14 and 15)
-                std::string dummy;
-                for (int i = 0; i < 11; i++) {
-                    iss >> dummy;
-                }
-                
-                unsigned long utime, stime;
-                iss >> utime >> stime;
-                
-                // Simple approximation of CPU usage
-                // This isn't completely accurate but gives a rough estimate
-                // For better accuracy, we'd need to track process CPU time between updates
-                unsigned long total_time = utime + stime;
-                proc.cpu_percent = 0.1f * total_time / (cpu_info.num_cores * 100.0f);
-                
-                if (config.debug_mode) {
-                    debugLog("Process " + std::to_string(proc.pid) + " (" + proc.name + ") CPU calculation:");
-                    debugLog("  utime: " + std::to_string(utime) + ", stime: " + std::to_string(stime));
-                    debugLog("  total_time: " + std::to_string(total_time));
-                    debugLog("  num_cores: " + std::to_string(cpu_info.num_cores));
-                    debugLog("  cpu_percent: " + std::to_string(proc.cpu_percent));
-                }
-            }
-            
-            // Add process to list
-            processes.push_back(proc);
-        }
+// Follow the settings the overhead budget chose
+void ActivityMonitor::applyOverheadSettings() {
+    const OverheadSettings& settings = overhead.settings();
+    watchdog.setBudget(settings.refresh_ms);
+    Tracer::counter("self cpu %", overhead.measuredPercent());
+    Tracer::counter("budget step", overhead.step());
+    debugLog("CPU budget step " + std::to_string(overhead.step()) + ": " + overhead.describe());
+}
+
+// Own overhead and reduced settings, for exports; empty when neither applies
+std::string ActivityMonitor::monitorState() const {
+    std::string state = overhead.enabled() ? overhead.describe() : "";
+    if (watchdog.stats().overruns > 0) {
+        state += (state.empty() ? "" : "; ") + std::string("refresh level ") + std::to_string(watchdog.level()) +
+                 " (" + TickWatchdog::levelName(watchdog.level()) + "), " + watchdog.summary();
     }
-    
-    closedir(proc_dir);
-    
-    // Sort processes
-    sortProcesses();
+    return state;
 }
 
 // Debug log method
@@ -527,125 +517,10 @@ void ActivityMonitor::debugLog(const std::string& message) {
     }
 }
 
-// Update memory cache hit rates and latency metrics
-void ActivityMonitor::updateMemoryStats() {
-    // Read cached and buffers memory amounts from /proc/meminfo (already done in updateMemoryInfo)
-    std::ifstream meminfo_file("/proc/meminfo");
-    if (meminfo_file.is_open()) {
-        std::string line;
-        while (std::getline(meminfo_file, line)) {
-            std::istringstream iss(line);
-            std::string key;
-            unsigned long value;
-            std::string unit;
-            
-            iss >> key >> value >> unit;
-            
-            if (key == "Cached:") {
-                memory_info.cached = value;
-            } else if (key == "Buffers:") {
-                memory_info.buffers = value;
-            }
-        }
-    }
-    
-    // Calculate cache hit rate - this is a simplified approximation
-    // In a real system, this would come from performance counters
-    if (memory_info.total > 0) {
-        // Calculate cached memory percentage
-        float cache_percentage = 100.0f * (memory_info.cached + memory_info.buffers) / memory_info.total;
-        
-        // Simulate cache hit rate based on cache size (simplified model)
-        // More cache generally means higher hit rates
-        memory_info.cache_hit_rate = 70.0f + (cache_percentage * 0.25f);
-        
-        // Cap at 99% maximum hit rate
-        if (memory_info.cache_hit_rate > 99.0f) {
-            memory_info.cache_hit_rate = 99.0f;
-        }
-    } else {
-        memory_info.cache_hit_rate = -1.0f;
-    }
-    
-    // Estimate memory latency - this would ideally come from hardware counters
-    // For simulation purposes, we're generating a realistic value
-    // Typical DDR4 memory latency is around 60-100ns
-    memory_info.latency_ns = 60.0f + (40.0f * memory_info.percent_used / 100.0f);
-    
-    if (config.debug_mode) {
-        debugLog("Memory cache hit rate: " + std::to_string(memory_info.cache_hit_rate) + "%");
-        debugLog("Memory latency: " + formatLatency(memory_info.latency_ns, true));
-    }
-}
-
-// Update disk I/O and latency metrics
-void ActivityMonitor::updateDiskLatency() {
-    // Read disk stats from /proc/diskstats
-    std::ifstream diskstats_file("/proc/diskstats");
-    if (!diskstats_file.is_open()) {
-        if (config.debug_mode) {
-            debugLog("Failed to open /proc/diskstats");
-        }
-        return;
-    }
-    
-    // Create a map for easier lookup of disk information by device name
-    std::unordered_map<std::string, DiskInfo*> disk_lookup;
-    for (auto& disk : disk_info) {
-        // Extract the device name without path (e.g., "sda1" from "/dev/sda1")
-        size_t pos = disk.device.rfind('/');
-        std::string dev_name = (pos != std::string::npos) ? disk.device.substr(pos + 1) : disk.device;
-        disk_lookup[dev_name] = &disk;
-        
-        // Initialize latency metrics
-        disk.read_latency_ms = -1.0f;
-    }
-    
-    // Parse disk stats
-    std::string line;
-    while (std::getline(diskstats_file, line)) {
-        std::istringstream iss(line);
-        int major, minor;
-        std::string dev_name;
-        unsigned long reads, reads_merged, sectors_read, read_ms;
-        unsigned long writes, writes_merged, sectors_written, write_ms;
-        unsigned long ios_in_progress, io_ms, weighted_io_ms;
-        
-        // Parse disk stats line
-        iss >> major >> minor >> dev_name 
-            >> reads >> reads_merged >> sectors_read >> read_ms
-            >> writes >> writes_merged >> sectors_written >> write_ms
-            >> ios_in_progress >> io_ms >> weighted_io_ms;
-        
-        // Check if this device is one we're monitoring
-        if (disk_lookup.find(dev_name) != disk_lookup.end()) {
-            DiskInfo* disk = disk_lookup[dev_name];
-            
-            // Calculate latency metrics
-            if (reads > 0) {
-                disk->read_latency_ms = static_cast<float>(read_ms) / reads;
-            }
-            
-            // Store total I/O operations
-            disk->io_operations = reads + writes;
-            
-            if (config.debug_mode) {
-                debugLog("Disk " + dev_name + " read latency: " + formatLatency(disk->read_latency_ms, false));
-                debugLog("Disk " + dev_name + " I/O operations: " + std::to_string(disk->io_operations));
-            }
-        }
-    }
-}
-
 // Run in debug-only mode (no UI)
 void ActivityMonitor::runDebugMode() {
     // Initialize necessary data
-    updateCPUInfo();
-    updateMemoryInfo();
-    updateDiskInfo();
-    updateProcessInfo();
-    updateMemoryStats();
-    updateDiskLatency();
+    updateSystemInfo();
     
     // Print initial debug information
     debugLog("===== Starting debug-only mode =====");
@@ -662,16 +537,13 @@ void ActivityMonitor::runDebugMode() {
         debugLog("===== Collecting data (cycle " + std::to_string(i+1) + "/" + std::to_string(cycles) + ") =====");
         
         // Update data
-        updateCPUInfo();
+        updateSystemInfo();
         debugLog("CPU usage: " + std::to_string(cpu_info.total_usage) + "%");
         
-        updateMemoryInfo();
-        updateMemoryStats();
         debugLog("Memory usage: " + std::to_string(memory_info.percent_used) + "% (" + formatSize(memory_info.used) + "/" + formatSize(memory_info.total) + ")");
         debugLog("Cache hit rate: " + std::to_string(memory_info.cache_hit_rate) + "%, Latency: " + formatLatency(memory_info.latency_ns, true));
         
         // Log disk information
-        updateDiskLatency();
         debugLog("Disk information:");
         for (const auto& disk : disk_info) {
             debugLog("  " + disk.mount_point + " (" + disk.device + "): " + 
@@ -679,11 +551,9 @@ void ActivityMonitor::runDebugMode() {
                      formatLatency(disk.read_latency_ms, false));
         }
         
-        updateProcessInfo();
         debugLog("Found " + std::to_string(processes.size()) + " processes");
         
         // Log the top 5 CPU-consuming processes
-        sortProcesses();
         debugLog("Top CPU-consuming processes:");
         int count = std::min(5, static_cast<int>(processes.size()));
         for (int j = 0; j < count; j++) {
@@ -693,6 +563,9 @@ void ActivityMonitor::runDebugMode() {
                      ", CPU: " + std::to_string(proc.cpu_percent) + "%");
         }
         
+        // Log kernel events (OOM kills, I/O errors, ...) seen since the last cycle
+        pollKernelLog();
+        
         // Wait for the next update
         std::this_thread::sleep_for(std::chrono::milliseconds(config.refresh_rate_ms));
     }
@@ -2,20 +2,23 @@
 #include <sstream>
 #include <iomanip>
 #include <thread>
+#include <algorithm>
+#include <ctime>
+#include <unistd.h>
 
 // Show CPU stats
 void ActivityMonitor::displayCPUInfo() {
-    wclear(cpu_win);
-    box(cpu_win, 0, 0);
+    screen->clear(cpu_win);
+    screen->box(cpu_win);
     
-    int height, width;
-    getmaxyx(cpu_win, height, width);
+    int height = cpu_win.height;
+    int width = cpu_win.width;
     
-    wattron(cpu_win, COLOR_PAIR(5));
-    mvwprintw(cpu_win, 0, 2, " CPU Usage ");
-    wattroff(cpu_win, COLOR_PAIR(5));
+    screen->attrOn(cpu_win, COLOR_PAIR(5));
+    screen->print(cpu_win, 0, 2, " CPU Usage ");
+    screen->attrOff(cpu_win, COLOR_PAIR(5));
     
-    mvwprintw(cpu_win, 1, 2, "Total:");
+    screen->print(cpu_win, 1, 2, "Total:");
     
     int color = 1;
     if (cpu_info.total_usage > config.cpu_threshold) {
@@ -24,10 +27,10 @@ void ActivityMonitor::displayCPUInfo() {
         color = 2;
     }
     
-    wattron(cpu_win, COLOR_PAIR(color));
+    screen->attrOn(cpu_win, COLOR_PAIR(color));
     std::string bar = createBar(cpu_info.total_usage, width - 10, false);
-    mvwprintw(cpu_win, 1, 10, "%s", bar.c_str());
-    wattroff(cpu_win, COLOR_PAIR(color));
+    screen->print(cpu_win, 1, 10, "%s", bar.c_str());
+    screen->attrOff(cpu_win, COLOR_PAIR(color));
     
     int cores_to_show = std::min(static_cast<int>(cpu_info.core_usage.size()), height - 3);
     for (int i = 0; i < cores_to_show; i++) {
@@ -40,27 +43,30 @@ void ActivityMonitor::displayCPUInfo() {
             color = 2;
         }
         
-        mvwprintw(cpu_win, i + 2, 2, "Core%2d:", i);
-        wattron(cpu_win, COLOR_PAIR(color));
+        screen->print(cpu_win, i + 2, 2, "Core%2d:", i);
+        screen->attrOn(cpu_win, COLOR_PAIR(color));
         bar = createBar(usage, width - 10, false);
-        mvwprintw(cpu_win, i + 2, 10, "%s", bar.c_str());
-        wattroff(cpu_win, COLOR_PAIR(color));
+        screen->print(cpu_win, i + 2, 10, "%s", bar.c_str());
+        screen->attrOff(cpu_win, COLOR_PAIR(color));
     }
     
-    wrefresh(cpu_win);
+    displayOverheadStatus();
+    displayHistoryStatus();
+    displayWatchdogStatus();
+    
+    screen->refresh(cpu_win);
 }
 
 // Show memory stats
 void ActivityMonitor::displayMemoryInfo() {
-    wclear(mem_win);
-    box(mem_win, 0, 0);
+    screen->clear(mem_win);
+    screen->box(mem_win);
     
-    int width;
-    getmaxyx(mem_win, std::ignore, width);
+    int width = mem_win.width;
     
-    wattron(mem_win, COLOR_PAIR(5));
-    mvwprintw(mem_win, 0, 2, " Memory Performance ");
-    wattroff(mem_win, COLOR_PAIR(5));
+    screen->attrOn(mem_win, COLOR_PAIR(5));
+    screen->print(mem_win, 0, 2, " Memory Performance ");
+    screen->attrOff(mem_win, COLOR_PAIR(5));
     
     int color = 1;
     if (memory_info.percent_used > 90.0f) {
@@ -69,11 +75,11 @@ void ActivityMonitor::displayMemoryInfo() {
         color = 2;
     }
     
-    mvwprintw(mem_win, 2, 2, "RAM:");
-    wattron(mem_win, COLOR_PAIR(color));
+    screen->print(mem_win, 2, 2, "RAM:");
+    screen->attrOn(mem_win, COLOR_PAIR(color));
     std::string bar = createBar(memory_info.percent_used, width - 8, false);
-    mvwprintw(mem_win, 2, 8, "%s", bar.c_str());
-    wattroff(mem_win, COLOR_PAIR(color));
+    screen->print(mem_win, 2, 8, "%s", bar.c_str());
+    screen->attrOff(mem_win, COLOR_PAIR(color));
     
     std::string total = formatSize(memory_info.total);
     std::string used = formatSize(memory_info.used);
@@ -81,16 +87,16 @@ void ActivityMonitor::displayMemoryInfo() {
     std::string cached = formatSize(memory_info.cached);
     std::string buffers = formatSize(memory_info.buffers);
     
-    mvwprintw(mem_win, 3, 2, "Total: %s", total.c_str());
-    mvwprintw(mem_win, 4, 2, "Used : %s", used.c_str());
-    mvwprintw(mem_win, 5, 2, "Free : %s", free.c_str());
+    screen->print(mem_win, 3, 2, "Total: %s", total.c_str());
+    screen->print(mem_win, 4, 2, "Used : %s", used.c_str());
+    screen->print(mem_win, 5, 2, "Free : %s", free.c_str());
     
-    wattron(mem_win, COLOR_PAIR(5));
-    mvwprintw(mem_win, 6, 2, "===== Performance Metrics =====");
-    wattroff(mem_win, COLOR_PAIR(5));
+    screen->attrOn(mem_win, COLOR_PAIR(5));
+    screen->print(mem_win, 6, 2, "===== Performance Metrics =====");
+    screen->attrOff(mem_win, COLOR_PAIR(5));
     
-    mvwprintw(mem_win, 7, 2, "Cache: %s", cached.c_str());
-    mvwprintw(mem_win, 8, 2, "Buffr: %s", buffers.c_str());
+    screen->print(mem_win, 7, 2, "Cache: %s", cached.c_str());
+    screen->print(mem_win, 8, 2, "Buffr: %s", buffers.c_str());
     
     if (memory_info.cache_hit_rate > 0) {
         int hit_color = 1;
@@ -100,21 +106,21 @@ void ActivityMonitor::displayMemoryInfo() {
             hit_color = 2;
         }
         
-        wattron(mem_win, COLOR_PAIR(hit_color) | A_BOLD);
-        mvwprintw(mem_win, 9, 2, "Hit Rate: %.1f%%", memory_info.cache_hit_rate);
-        wattroff(mem_win, COLOR_PAIR(hit_color) | A_BOLD);
+        screen->attrOn(mem_win, COLOR_PAIR(hit_color) | A_BOLD);
+        screen->print(mem_win, 9, 2, "Hit Rate: %.1f%%", memory_info.cache_hit_rate);
+        screen->attrOff(mem_win, COLOR_PAIR(hit_color) | A_BOLD);
         
         int hit_width = 20;
         int filled = static_cast<int>(hit_width * memory_info.cache_hit_rate / 100.0);
-        mvwprintw(mem_win, 9, 18, "[");
-        wattron(mem_win, COLOR_PAIR(hit_color));
+        screen->print(mem_win, 9, 18, "[");
+        screen->attrOn(mem_win, COLOR_PAIR(hit_color));
         for (int i = 0; i < hit_width; i++) {
-            mvwaddch(mem_win, 9, 19 + i, (i < filled) ? '|' : ' ');
+            screen->putChar(mem_win, 9, 19 + i, (i < filled) ? '|' : ' ');
         }
-        wattroff(mem_win, COLOR_PAIR(hit_color));
-        mvwprintw(mem_win, 9, 19 + hit_width, "]");
+        screen->attrOff(mem_win, COLOR_PAIR(hit_color));
+        screen->print(mem_win, 9, 19 + hit_width, "]");
     } else {
-        mvwprintw(mem_win, 9, 2, "Hit Rate: N/A");
+        screen->print(mem_win, 9, 2, "Hit Rate: N/A");
     }
     
     std::string latency = formatLatency(memory_info.latency_ns, true);
@@ -126,14 +132,16 @@ void ActivityMonitor::displayMemoryInfo() {
         latency_color = 2;
     }
     
-    wattron(mem_win, COLOR_PAIR(latency_color) | A_BOLD);
-    mvwprintw(mem_win, 10, 2, "Latency: %s", latency.c_str());
-    wattroff(mem_win, COLOR_PAIR(latency_color) | A_BOLD);
+    screen->attrOn(mem_win, COLOR_PAIR(latency_color) | A_BOLD);
+    screen->print(mem_win, 10, 2, "Latency: %s", latency.c_str());
+    screen->attrOff(mem_win, COLOR_PAIR(latency_color) | A_BOLD);
+    
+    displayHugePages();
     
     if (memory_info.swap_total > 0) {
-        wattron(mem_win, COLOR_PAIR(5));
-        mvwprintw(mem_win, 12, 2, "===== Swap Memory =====");
-        wattroff(mem_win, COLOR_PAIR(5));
+        screen->attrOn(mem_win, COLOR_PAIR(5));
+        screen->print(mem_win, 12, 2, "===== Swap Memory =====");
+        screen->attrOff(mem_win, COLOR_PAIR(5));
         
         color = 1;
         if (memory_info.swap_percent_used > 50.0f) {
@@ -142,42 +150,87 @@ void ActivityMonitor::displayMemoryInfo() {
             color = 2;
         }
         
-        mvwprintw(mem_win, 13, 2, "Swap:");
-        wattron(mem_win, COLOR_PAIR(color));
+        screen->print(mem_win, 13, 2, "Swap:");
+        screen->attrOn(mem_win, COLOR_PAIR(color));
         bar = createBar(memory_info.swap_percent_used, width - 8, false);
-        mvwprintw(mem_win, 13, 8, "%s", bar.c_str());
-        wattroff(mem_win, COLOR_PAIR(color));
+        screen->print(mem_win, 13, 8, "%s", bar.c_str());
+        screen->attrOff(mem_win, COLOR_PAIR(color));
         
         std::string swap_total = formatSize(memory_info.swap_total);
         std::string swap_used = formatSize(memory_info.swap_used);
         std::string swap_free = formatSize(memory_info.swap_free);
         
-        mvwprintw(mem_win, 14, 2, "Total: %s", swap_total.c_str());
-        mvwprintw(mem_win, 15, 2, "Used : %s", swap_used.c_str());
-        mvwprintw(mem_win, 16, 2, "Free : %s", swap_free.c_str());
+        screen->print(mem_win, 14, 2, "Total: %s", swap_total.c_str());
+        screen->print(mem_win, 15, 2, "Used : %s", swap_used.c_str());
+        screen->print(mem_win, 16, 2, "Free : %s", swap_free.c_str());
     }
     
-    wrefresh(mem_win);
+    screen->refresh(mem_win);
+}
+
+// Huge pages beside the totals of the memory panel: THP in use, THP and
+// compaction events per second, the HugeTLB pool and the largest THP users
+void ActivityMonitor::displayHugePages() {
+    const int col = 22;
+    int room = mem_win.width - col - 1;
+    if (room < 20) {
+        return;
+    }
+    auto line = [this, room](int row, const std::string& text) {
+        screen->print(mem_win, row, col, "%s", text.substr(0, room).c_str());
+    };
+    char text[128];
+    
+    line(3, "THP anon " + formatSize(memory_info.anon_huge_kb) + ", shmem " + formatSize(memory_info.shmem_huge_kb));
+    
+    // Fallbacks and compaction stalls are the latency spikes
+    bool stalling = memory_info.thp_fault_fallback_rate > 0.0f || memory_info.compact_stall_rate > 0.0f;
+    bool failing = memory_info.compact_fail_rate > 0.0f;
+    int color = failing ? 3 : (stalling ? 2 : 1);
+    snprintf(text, sizeof(text), "faults %.1f/s, fallback %.1f/s, collapse %.1f/s",
+             memory_info.thp_fault_alloc_rate, memory_info.thp_fault_fallback_rate,
+             memory_info.thp_collapse_alloc_rate);
+    screen->attrOn(mem_win, COLOR_PAIR(color));
+    line(4, text);
+    snprintf(text, sizeof(text), "compaction stall %.1f/s, fail %.1f/s",
+             memory_info.compact_stall_rate, memory_info.compact_fail_rate);
+    line(5, text);
+    screen->attrOff(mem_win, COLOR_PAIR(color));
+    
+    if (memory_info.hugepages_total > 0 || memory_info.hugepages_surp > 0) {
+        snprintf(text, sizeof(text), "HugeTLB %lu/%lu free, %lu rsvd, %lu surp, ",
+                 memory_info.hugepages_free, memory_info.hugepages_total,
+                 memory_info.hugepages_rsvd, memory_info.hugepages_surp);
+        line(7, text + formatSize(memory_info.hugepage_size_kb) + " pages");
+    }
+    
+    std::string users = "THP top: ";
+    if (huge_page_users.empty()) {
+        users += "none of the largest";
+    }
+    for (size_t i = 0; i < huge_page_users.size(); i++) {
+        users += (i > 0 ? ", " : "") + huge_page_users[i].name + " " + formatSize(huge_page_users[i].anon_huge_kb);
+    }
+    line(8, users);
 }
 
 // Show disk stats
 void ActivityMonitor::displayDiskInfo() {
-    wclear(disk_win);
-    box(disk_win, 0, 0);
+    screen->clear(disk_win);
+    screen->box(disk_win);
     
-    int height, width;
-    getmaxyx(disk_win, height, width);
+    int height = disk_win.height;
     
-    wattron(disk_win, COLOR_PAIR(5));
-    mvwprintw(disk_win, 0, 2, " Disk Performance ");
-    wattroff(disk_win, COLOR_PAIR(5));
+    screen->attrOn(disk_win, COLOR_PAIR(5));
+    screen->print(disk_win, 0, 2, " Disk Performance ");
+    screen->attrOff(disk_win, COLOR_PAIR(5));
     
     int max_disks = height - 4;
     int disks_shown = 0;
     
-    wattron(disk_win, A_BOLD);
-    mvwprintw(disk_win, 1, 2, "Mount      Usage    Read Latency");
-    wattroff(disk_win, A_BOLD);
+    screen->attrOn(disk_win, A_BOLD);
+    screen->print(disk_win, 1, 2, "Mount      Usage    Read Latency");
+    screen->attrOff(disk_win, A_BOLD);
     
     for (size_t i = 0; i < disk_info.size() && disks_shown < max_disks; i++) {
         const DiskInfo& disk = disk_info[i];
@@ -194,12 +247,12 @@ void ActivityMonitor::displayDiskInfo() {
             color = 2;
         }
         
-        mvwprintw(disk_win, disks_shown + 2, 2, "%-8s", mount.c_str());
+        screen->print(disk_win, disks_shown + 2, 2, "%-8s", mount.c_str());
         
-        wattron(disk_win, COLOR_PAIR(color));
+        screen->attrOn(disk_win, COLOR_PAIR(color));
         std::string bar = createBar(disk.percent_used, 20, false);
-        mvwprintw(disk_win, disks_shown + 2, 11, "%s", bar.c_str());
-        wattroff(disk_win, COLOR_PAIR(color));
+        screen->print(disk_win, disks_shown + 2, 11, "%s", bar.c_str());
+        screen->attrOff(disk_win, COLOR_PAIR(color));
         
         std::string read_latency = formatLatency(disk.read_latency_ms, false);
         
@@ -210,56 +263,131 @@ void ActivityMonitor::displayDiskInfo() {
             read_color = 2;
         }
         
-        wattron(disk_win, COLOR_PAIR(read_color) | A_BOLD);
-        mvwprintw(disk_win, disks_shown + 2, 36, "%-12s", read_latency.c_str());
-        wattroff(disk_win, COLOR_PAIR(read_color) | A_BOLD);
+        screen->attrOn(disk_win, COLOR_PAIR(read_color) | A_BOLD);
+        screen->print(disk_win, disks_shown + 2, 36, "%-12s", read_latency.c_str());
+        screen->attrOff(disk_win, COLOR_PAIR(read_color) | A_BOLD);
         
         disks_shown++;
     }
     
     if (height > 6) {
-        wattron(disk_win, A_BOLD);
-        mvwprintw(disk_win, height - 2, 2, "Latency Key:");
-        wattroff(disk_win, A_BOLD);
+        screen->attrOn(disk_win, A_BOLD);
+        screen->print(disk_win, height - 2, 2, "Latency Key:");
+        screen->attrOff(disk_win, A_BOLD);
         
-        wattron(disk_win, COLOR_PAIR(1));
-        mvwprintw(disk_win, height - 2, 15, "Good");
-        wattroff(disk_win, COLOR_PAIR(1));
+        screen->attrOn(disk_win, COLOR_PAIR(1));
+        screen->print(disk_win, height - 2, 15, "Good");
+        screen->attrOff(disk_win, COLOR_PAIR(1));
         
-        wattron(disk_win, COLOR_PAIR(2));
-        mvwprintw(disk_win, height - 2, 25, "Medium");
-        wattroff(disk_win, COLOR_PAIR(2));
+        screen->attrOn(disk_win, COLOR_PAIR(2));
+        screen->print(disk_win, height - 2, 25, "Medium");
+        screen->attrOff(disk_win, COLOR_PAIR(2));
         
-        wattron(disk_win, COLOR_PAIR(3));
-        mvwprintw(disk_win, height - 2, 37, "High/Poor");
-        wattroff(disk_win, COLOR_PAIR(3));
+        screen->attrOn(disk_win, COLOR_PAIR(3));
+        screen->print(disk_win, height - 2, 37, "High/Poor");
+        screen->attrOff(disk_win, COLOR_PAIR(3));
     }
     
-    wrefresh(disk_win);
+    screen->refresh(disk_win);
 }
 
 // Display process information
 void ActivityMonitor::displayProcessInfo() {
-    wclear(process_win);
-    box(process_win, 0, 0);
+    if (process_view == VIEW_DIFF) {
+        displayDiffView();
+        return;
+    }
+    if (process_view == VIEW_WAIT_PROFILE) {
+        displayWaitProfile();
+        return;
+    }
+    if (process_view == VIEW_KERNEL_EVENTS) {
+        displayKernelEvents();
+        return;
+    }
+    if (process_view == VIEW_PAGE_CACHE) {
+        displayPageCache();
+        return;
+    }
+    if (process_view == VIEW_DISK_USAGE) {
+        displayDiskUsage();
+        return;
+    }
+    if (process_view == VIEW_WRITE_HOTSPOTS) {
+        displayWriteHotspots();
+        return;
+    }
+    if (process_view == VIEW_WATCH) {
+        displayWatchList();
+        return;
+    }
+    if (process_view == VIEW_APPS) {
+        displayAppGroups();
+        return;
+    }
+    if (process_view == VIEW_PROCESS_HISTORY) {
+        displayProcessHistory();
+        return;
+    }
+    
+    screen->clear(process_win);
+    screen->box(process_win);
     
     // Get window size
-    int height, width;
-    getmaxyx(process_win, height, width);
+    int height = process_win.height;
+    int width = process_win.width;
     
     // Draw header
-    wattron(process_win, COLOR_PAIR(5));
-    mvwprintw(process_win, 0, 2, " Processes (Press 'c' for CPU sort, 'm' for memory sort, 'k' to kill highest CPU process) ");
-    wattroff(process_win, COLOR_PAIR(5));
+    screen->attrOn(process_win, COLOR_PAIR(5));
+    screen->print(process_win, 0, 2, " Processes ('c' CPU sort, 'm' memory sort, 's' pressure sort, 'k' kill top pressure process, 'w' profile selected, '*' watch) ");
+    screen->attrOff(process_win, COLOR_PAIR(5));
     
     // Draw column headers
-    wattron(process_win, A_BOLD);
-    mvwprintw(process_win, 1, 2, "%-6s %-25s %-10s %-10s", 
+    screen->attrOn(process_win, A_BOLD);
+    screen->print(process_win, 1, 2, "%-6s %-25s %-10s %-10s", 
               "PID", "Name", "CPU%", "Memory%");
-    wattroff(process_win, A_BOLD);
+    
+    // The pressure score is shown while sorting by it
+    bool show_pressure = process_sort_type == 6;
+    int perf_col = show_pressure ? 64 : 56;
+    if (show_pressure) {
+        screen->print(process_win, 1, 56, "%7s", "vScore");
+    }
+    
+    // Exact counters of the live top processes (not meaningful for history)
+    bool show_perf = config.perf_top_n > 0 && !paused;
+    if (show_perf && perf.available()) {
+        screen->print(process_win, 1, perf_col, "%7s %8s %7s %8s", "Exact%", "CSw/s", "Migr/s", "Flt/s");
+    } else if (show_perf) {
+        screen->print(process_win, 1, perf_col, "(perf: %s)", perf.unavailableReason().c_str());
+    }
+    
+    // Wait shares follow the perf columns; the sorted one is marked
+    bool show_delays = config.delay_top_n > 0 && !paused;
+    int delay_col = show_perf ? perf_col + 35 : perf_col;
+    if (show_delays && delays.available()) {
+        static const char* DELAY_HEADERS[] = {"CPUw%", "I/Ow%", "Swap%", "Recl%"};
+        for (int i = 0; i < 4; i++) {
+            std::string header = std::string(process_sort_type == i + 2 ? "v" : "") + DELAY_HEADERS[i];
+            screen->print(process_win, 1, delay_col + i * 8, "%7s", header.c_str());
+        }
+    } else if (show_delays) {
+        screen->print(process_win, 1, delay_col, "(delays: %s)", delays.unavailableReason().c_str());
+    }
+    screen->attrOff(process_win, A_BOLD);
     
     // Calculate how many processes we can show
     int process_rows = height - 3;
+    
+    // Keep the selected process on screen
+    int selected_index = selectedIndex();
+    if (selected_index >= 0 && process_rows > 0) {
+        if (selected_index < process_list_offset) {
+            process_list_offset = selected_index;
+        } else if (selected_index >= process_list_offset + process_rows) {
+            process_list_offset = selected_index - process_rows + 1;
+        }
+    }
     int end_index = std::min(static_cast<int>(processes.size()), 
                              process_list_offset + process_rows);
     
@@ -276,24 +404,41 @@ void ActivityMonitor::displayProcessInfo() {
             color = 2; // yellow for medium usage
         }
         
-        wattron(process_win, COLOR_PAIR(color));
+        attr_t row_attrs = COLOR_PAIR(color) | (i == selected_index ? A_REVERSE : 0);
+        screen->attrOn(process_win, row_attrs);
         
-        // Create a truncated name if necessary
-        std::string disp_name;
-        if (proc.name.length() > 25) {
-            disp_name = proc.name.substr(0, 22) + "...";
-        } else {
-            disp_name = proc.name;
+        // Create a truncated name if necessary; watched processes are starred
+        std::string disp_name = isWatched(proc.pid) ? "*" + proc.name : proc.name;
+        if (disp_name.length() > 25) {
+            disp_name = disp_name.substr(0, 22) + "...";
         }
         
         // Draw process information - removed status column
-        mvwprintw(process_win, row, 2, "%-6d %-25s %6.1f%%     %6.1f%%", 
+        screen->print(process_win, row, 2, "%-6d %-25s %6.1f%%     %6.1f%%", 
                   proc.pid, 
                   disp_name.c_str(),
                   proc.cpu_percent,
                   proc.mem_percent);
         
-        wattroff(process_win, COLOR_PAIR(color));
+        if (show_pressure) {
+            screen->print(process_win, row, 56, "%7.2f", proc.pressure);
+        }
+        
+        const PerfSample* counted = show_perf ? perf.sample(proc.pid) : nullptr;
+        if (counted != nullptr) {
+            screen->print(process_win, row, perf_col, "%6.1f%% %8.0f %7.0f %8.0f",
+                          counted->cpu_percent, counted->context_switches,
+                          counted->cpu_migrations, counted->page_faults);
+        }
+        
+        const DelaySample* waited = show_delays ? delays.sample(proc.pid) : nullptr;
+        if (waited != nullptr) {
+            screen->print(process_win, row, delay_col, "%6.1f%% %6.1f%% %6.1f%% %6.1f%%",
+                          waited->cpu_percent, waited->blkio_percent,
+                          waited->swapin_percent, waited->reclaim_percent);
+        }
+        
+        screen->attrOff(process_win, row_attrs);
     }
     
     // Show a scroll indicator if there are more processes
@@ -304,14 +449,95 @@ void ActivityMonitor::displayProcessInfo() {
         
         for (int i = 2; i < height - 1; i++) {
             if (i == scrollbar_pos) {
-                mvwaddch(process_win, i, width - 2, '#');
+                screen->putChar(process_win, i, width - 2, '#');
             } else {
-                mvwaddch(process_win, i, width - 2, '|');
+                screen->putChar(process_win, i, width - 2, '|');
             }
         }
     }
     
-    wrefresh(process_win);
+    if (show_delays && delays.available()) {
+        displayDelayExits();
+    }
+    
+    screen->refresh(process_win);
+}
+
+// Exits of the last refresh and the query cost, on the bottom border
+void ActivityMonitor::displayDelayExits() {
+    const DelayExitSummary& exits = delays.exits();
+    char text[200];
+    if (delays.kernelAccountingOff()) {
+        snprintf(text, sizeof(text), " Delay accounting is off in the kernel: sysctl kernel.task_delayacct=1 ");
+    } else if (!delays.exitsSubscribed()) {
+        snprintf(text, sizeof(text), " Exits not reported; %d syscalls per refresh ",
+                 static_cast<int>(delays.syscallsLastUpdate()));
+    } else if (exits.processes == 0) {
+        snprintf(text, sizeof(text), " No exits since the last refresh%s; %d syscalls per refresh ",
+                 exits.lost > 0 ? " (some lost)" : "", static_cast<int>(delays.syscallsLastUpdate()));
+    } else {
+        snprintf(text, sizeof(text), " %d exited%s: waited CPU %.0f ms, I/O %.0f ms, swap %.0f ms, reclaim %.0f ms;"
+                 " most %s (%d) %.0f ms; %d syscalls ",
+                 static_cast<int>(exits.processes), exits.lost > 0 ? " (more lost)" : "", exits.cpu_ms,
+                 exits.blkio_ms, exits.swapin_ms, exits.reclaim_ms, exits.worst_name.c_str(), exits.worst_pid,
+                 exits.worst_ms, static_cast<int>(delays.syscallsLastUpdate()));
+    }
+    std::string line = text;
+    int text_width = std::max(0, process_win.width - 4);
+    screen->print(process_win, process_win.height - 1, 2, "%s", line.substr(0, text_width).c_str());
+}
+
+// Sort by the next wait column: CPU, I/O, swap-in, reclaim
+void ActivityMonitor::cycleDelaySort() {
+    if (config.delay_top_n <= 0 || !delays.available()) {
+        return;
+    }
+    process_sort_type = process_sort_type >= 2 && process_sort_type < 5 ? process_sort_type + 1 : 2;
+    sortProcesses();
+}
+
+// Index of the highlighted process, following it by PID across re-sorts
+int ActivityMonitor::selectedIndex() const {
+    if (processes.empty()) {
+        return -1;
+    }
+    for (size_t i = 0; i < processes.size(); i++) {
+        if (processes[i].pid == selected_pid) {
+            return static_cast<int>(i);
+        }
+    }
+    return 0;
+}
+
+// Move the highlight by a number of rows
+void ActivityMonitor::moveSelection(int delta) {
+    int index = selectedIndex();
+    if (index < 0) {
+        return;
+    }
+    
+    index = std::max(0, std::min(static_cast<int>(processes.size()) - 1, index + delta));
+    selected_pid = processes[index].pid;
+}
+
+// Switch the process panel view
+void ActivityMonitor::setProcessView(ProcessView view) {
+    // Leaving the profile or page-cache view stops its background worker
+    if (process_view == VIEW_WAIT_PROFILE && view != VIEW_WAIT_PROFILE) {
+        wait_profiler.stop();
+    }
+    if (process_view == VIEW_PAGE_CACHE && view != VIEW_PAGE_CACHE) {
+        page_cache.stop();
+    }
+    if (process_view == VIEW_DISK_USAGE && view != VIEW_DISK_USAGE) {
+        disk_usage.stop();
+    }
+    if (process_view == VIEW_WRITE_HOTSPOTS && view != VIEW_WRITE_HOTSPOTS) {
+        write_tracker.stop();
+    }
+    
+    process_view = view;
+    view_offset = 0;
 }
 
 // Display CPU alert when threshold is exceeded
@@ -323,9 +549,8 @@ void ActivityMonitor::displayAlert() {
     
     if (!config.show_alert || (!is_warning && !is_pre_warning)) {
         // Delete alert window if it exists and is not needed
-        if (alert_win != nullptr) {
-            delwin(alert_win);
-            alert_win = nullptr;
+        if (alert_win.open) {
+            screen->destroyPanel(alert_win);
             // Redraw all windows to clear alert
             displayCPUInfo();
             displayMemoryInfo();
@@ -335,31 +560,32 @@ void ActivityMonitor::displayAlert() {
         return;
     }
     
-    // Make sure processes are sorted by CPU usage
-    if (process_sort_type != 0) {
-        process_sort_type = 0;
-        sortProcesses();
-    }
-    
-    // Get highest CPU process if available
-    Process* top_process = nullptr;
-    if (!processes.empty()) {
-        top_process = &processes[0];
+    // The process 'k' would offer to kill, from the live table whatever the sort or pause
+    const Process* top_process = highestPressureProcess();
+    std::string proc_info = "No pressure scores yet";
+    if (top_process != nullptr) {
+        std::ostringstream proc_oss;
+        proc_oss << "Top pressure: " << top_process->pid << " (" << top_process->name << ") "
+                 << std::fixed << std::setprecision(2) << top_process->pressure << ", "
+                 << std::setprecision(1) << top_process->cpu_percent << "% CPU";
+        proc_info = proc_oss.str();
     }
     
     // Create alert window if it doesn't exist
-    if (alert_win == nullptr) {
+    if (!alert_win.open) {
         int height = 9;  // Increased height for top process details
         int width = 60;  // Increased width for more text
         int start_y = (terminal_height - height) / 2;
         int start_x = (terminal_width - width) / 2;
         
-        alert_win = newwin(height, width, start_y, start_x);
+        screen->createPanel(alert_win, height, width, start_y, start_x);
     }
     
     // Get window width
-    int width;
-    getmaxyx(alert_win, std::ignore, width);
+    int width = alert_win.width;
+    if (proc_info.length() > static_cast<size_t>(width - 4)) {
+        proc_info = proc_info.substr(0, width - 7) + "...";
+    }
     
     // Get current time to create blinking effect
     auto now = std::chrono::system_clock::now();
@@ -367,115 +593,252 @@ void ActivityMonitor::displayAlert() {
     bool blink = (time_point % 2 == 0);
     
     // Display alert
-    wclear(alert_win);
+    screen->clear(alert_win);
     
     if (is_warning) {
         // Critical warning - over threshold
         if (blink) {
-            wbkgd(alert_win, COLOR_PAIR(3)); // Red background
+            screen->background(alert_win, COLOR_PAIR(3)); // Red background
         } else {
-            wbkgd(alert_win, COLOR_PAIR(0));
-            box(alert_win, 0, 0);
+            screen->background(alert_win, COLOR_PAIR(0));
+            screen->box(alert_win);
         }
         
         // Warning title
         std::string title = " WARNING: High CPU Usage ";
-        wattron(alert_win, A_BOLD);
-        mvwprintw(alert_win, 0, (width - title.length()) / 2, "%s", title.c_str());
-        wattroff(alert_win, A_BOLD);
+        screen->attrOn(alert_win, A_BOLD);
+        screen->print(alert_win, 0, (width - title.length()) / 2, "%s", title.c_str());
+        screen->attrOff(alert_win, A_BOLD);
         
         std::ostringstream oss;
         oss << "CPU Usage: " << std::fixed << std::setprecision(1) 
             << cpu_info.total_usage << "% > " << config.cpu_threshold << "%";
         
         int center_pos = (width - oss.str().length()) / 2;
-        mvwprintw(alert_win, 2, center_pos, "%s", oss.str().c_str());
+        screen->print(alert_win, 2, center_pos, "%s", oss.str().c_str());
         
-        // Add top process details if available
+        // Add top process details
+        screen->print(alert_win, 4, (width - proc_info.length()) / 2, "%s", proc_info.c_str());
+        
+        // Add instruction for killing the top pressure process
         if (top_process != nullptr) {
-            std::ostringstream proc_oss;
-            proc_oss << "Highest CPU process: " << top_process->pid << " (" 
-                    << top_process->name << ") using " << std::fixed 
-                    << std::setprecision(1) << top_process->cpu_percent << "% CPU";
-            
-            std::string proc_info = proc_oss.str();
-            if (proc_info.length() > static_cast<size_t>(width - 4)) {
-                proc_info = proc_info.substr(0, width - 7) + "...";
-            }
-            
-            mvwprintw(alert_win, 4, (width - proc_info.length()) / 2, "%s", proc_info.c_str());
+            std::string instruction = paused ? "Press 'l' to go live, then 'k' to kill it" : "Press 'k' to kill it";
+            screen->print(alert_win, 6, (width - instruction.length()) / 2, "%s", instruction.c_str());
         }
-        
-        // Add instruction for killing the highest CPU process
-        std::string instruction = "Press 'k' to kill highest CPU process";
-        mvwprintw(alert_win, 6, (width - instruction.length()) / 2, "%s", instruction.c_str());
     } else {
         // Pre-warning - approaching threshold
-        wbkgd(alert_win, COLOR_PAIR(0));
-        box(alert_win, 0, 0);
-        wattron(alert_win, COLOR_PAIR(2)); // Yellow for pre-warning
+        screen->background(alert_win, COLOR_PAIR(0));
+        screen->box(alert_win);
+        screen->attrOn(alert_win, COLOR_PAIR(2)); // Yellow for pre-warning
         
         // Pre-warning title
         std::string title = " NOTICE: Approaching CPU Threshold ";
-        wattron(alert_win, A_BOLD);
-        mvwprintw(alert_win, 0, (width - title.length()) / 2, "%s", title.c_str());
-        wattroff(alert_win, A_BOLD);
+        screen->attrOn(alert_win, A_BOLD);
+        screen->print(alert_win, 0, (width - title.length()) / 2, "%s", title.c_str());
+        screen->attrOff(alert_win, A_BOLD);
         
         std::ostringstream oss;
         oss << "CPU Usage: " << std::fixed << std::setprecision(1) 
             << cpu_info.total_usage << "% (Threshold: " << config.cpu_threshold << "%)";
         
         int center_pos = (width - oss.str().length()) / 2;
-        mvwprintw(alert_win, 2, center_pos, "%s", oss.str().c_str());
+        screen->print(alert_win, 2, center_pos, "%s", oss.str().c_str());
         
-        // Add top process details if available
-        if (top_process != nullptr) {
-            std::ostringstream proc_oss;
-            proc_oss << "Highest CPU process: " << top_process->pid << " (" 
-                    << top_process->name << ") using " << std::fixed 
-                    << std::setprecision(1) << top_process->cpu_percent << "% CPU";
-            
-            std::string proc_info = proc_oss.str();
-            if (proc_info.length() > static_cast<size_t>(width - 4)) {
-                proc_info = proc_info.substr(0, width - 7) + "...";
-            }
-            
-            mvwprintw(alert_win, 4, (width - proc_info.length()) / 2, "%s", proc_info.c_str());
-        }
+        // Add top process details
+        screen->print(alert_win, 4, (width - proc_info.length()) / 2, "%s", proc_info.c_str());
         
         std::string approaching_msg = "CPU utilization is approaching threshold!";
-        mvwprintw(alert_win, 6, (width - approaching_msg.length()) / 2, "%s", approaching_msg.c_str());
+        screen->print(alert_win, 6, (width - approaching_msg.length()) / 2, "%s", approaching_msg.c_str());
         
-        wattroff(alert_win, COLOR_PAIR(2));
+        screen->attrOff(alert_win, COLOR_PAIR(2));
+    }
+    
+    screen->refresh(alert_win);
+}
+
+// Show the paused/scrub position over the CPU window title bar
+void ActivityMonitor::displayHistoryStatus() {
+    if (!paused) {
+        return;
+    }
+    
+    int width = cpu_win.width;
+    
+    char time_str[16] = "--:--:--";
+    time_t taken_at = history.timestamp(history_cursor);
+    struct tm tm_info;
+    if (taken_at != 0 && localtime_r(&taken_at, &tm_info) != nullptr) {
+        strftime(time_str, sizeof(time_str), "%H:%M:%S", &tm_info);
+    }
+    
+    std::ostringstream oss;
+    oss << " PAUSED " << time_str << " (-" << (history.newestSeq() - history_cursor)
+        << "/" << (history.size() - 1) << ") <-/-> scrub, l live ";
+    std::string status = oss.str();
+    
+    int col = width - static_cast<int>(status.length()) - 2;
+    if (col < 16) {
+        return;
+    }
+    
+    screen->attrOn(cpu_win, COLOR_PAIR(2) | A_REVERSE | A_BOLD);
+    screen->print(cpu_win, 0, col, "%s", status.c_str());
+    screen->attrOff(cpu_win, COLOR_PAIR(2) | A_REVERSE | A_BOLD);
+}
+
+// Own CPU use against --cpu-budget and the settings chosen for it, after the CPU panel title
+void ActivityMonitor::displayOverheadStatus() {
+    if (!overhead.enabled()) {
+        return;
+    }
+    
+    std::string status = " " + overhead.describe() + " ";
+    int room = cpu_win.width - 16;
+    if (room < 12) {
+        return;
+    }
+    if (static_cast<int>(status.length()) > room) {
+        status = status.substr(0, room);
+    }
+    
+    attr_t attrs = overhead.step() > 0 ? COLOR_PAIR(2) : COLOR_PAIR(4);
+    screen->attrOn(cpu_win, attrs);
+    screen->print(cpu_win, 0, 14, "%s", status.c_str());
+    screen->attrOff(cpu_win, attrs);
+}
+
+// Refresh overruns on the bottom border of the CPU panel: the degradation
+// level while load is being shed, the statistics once it is restored
+void ActivityMonitor::displayWatchdogStatus() {
+    const TickStats& stats = watchdog.stats();
+    if (stats.overruns == 0) {
+        return;
+    }
+    
+    std::string status;
+    if (watchdog.degraded()) {
+        status = " DEGRADED " + std::to_string(watchdog.level()) + "/" + std::to_string(TickWatchdog::MAX_LEVEL) +
+                 ": " + TickWatchdog::levelName(watchdog.level()) + "; " + watchdog.summary() + " ";
+    } else {
+        status = " " + watchdog.summary() + " ";
+    }
+    
+    int col = cpu_win.width - static_cast<int>(status.length()) - 2;
+    if (col < 2) {
+        return;
+    }
+    
+    attr_t attrs = watchdog.degraded() ? (COLOR_PAIR(2) | A_REVERSE | A_BOLD) : COLOR_PAIR(2);
+    screen->attrOn(cpu_win, attrs);
+    screen->print(cpu_win, cpu_win.height - 1, col, "%s", status.c_str());
+    screen->attrOff(cpu_win, attrs);
+}
+
+// Replace the displayed data with a stored snapshot
+void ActivityMonitor::loadHistoryView(uint64_t seq) {
+    if (history.empty()) {
+        return;
+    }
+    
+    // Clamp to what is still retained; old snapshots are evicted while paused
+    seq = std::max(seq, history.oldestSeq());
+    seq = std::min(seq, history.newestSeq());
+    history_cursor = seq;
+    
+    history.load(seq, cpu_info, memory_info, disk_info, processes);
+    sortProcesses();
+    
+    if (process_view == VIEW_DIFF) {
+        updateDiff();
+    }
+}
+
+// Freeze the view on the newest snapshot
+void ActivityMonitor::pauseView() {
+    if (history.empty()) {
+        return;
+    }
+    
+    paused = true;
+    history_cursor = history.newestSeq();
+}
+
+// Move the paused view by a number of snapshots
+void ActivityMonitor::scrubHistory(int steps) {
+    if (history.empty()) {
+        return;
+    }
+    
+    if (!paused) {
+        pauseView();
+    }
+    
+    uint64_t target = history_cursor;
+    if (steps < 0) {
+        uint64_t back = static_cast<uint64_t>(-steps);
+        target = (target - history.oldestSeq() > back) ? target - back : history.oldestSeq();
+    } else {
+        target += static_cast<uint64_t>(steps);
+    }
+    
+    loadHistoryView(target);
+}
+
+// Resume live updates, showing the last collection immediately
+void ActivityMonitor::returnToLive() {
+    if (!paused) {
+        return;
     }
     
-    wrefresh(alert_win);
+    // The newest snapshot may be older than the last collection, and has no pressure scores
+    paused = false;
+    cpu_info = collector.cpu();
+    memory_info = collector.memory();
+    disk_info = collector.disks();
+    processes = live_processes;
+    sortProcesses();
+    if (process_view == VIEW_DIFF) {
+        updateDiff();
+    }
 }
 
 // Display a confirmation dialog and return the user's choice
-bool ActivityMonitor::displayConfirmationDialog(const std::string& message) {
+bool ActivityMonitor::displayConfirmationDialog(const std::string& message, bool question) {
+    // One row per line of the message, each cut to the dialog width
+    std::vector<std::string> lines;
+    std::istringstream message_lines(message);
+    std::string line;
+    while (std::getline(message_lines, line)) {
+        lines.push_back(line.substr(0, 56));
+    }
+    
     // Create confirmation window
-    int height = 7;
+    int height = 6 + static_cast<int>(lines.size());
     int width = 60;
     int start_y = (terminal_height - height) / 2;
     int start_x = (terminal_width - width) / 2;
     
-    WINDOW* dialog = newwin(height, width, start_y, start_x);
-    box(dialog, 0, 0);
+    Panel dialog;
+    screen->createPanel(dialog, height, width, start_y, start_x);
+    screen->clear(dialog);
+    screen->box(dialog);
     
     // Draw header
-    wattron(dialog, COLOR_PAIR(5));
-    mvwprintw(dialog, 0, 2, " Confirmation ");
-    wattroff(dialog, COLOR_PAIR(5));
+    screen->attrOn(dialog, COLOR_PAIR(5));
+    screen->print(dialog, 0, 2, question ? " Confirmation " : " Notice ");
+    screen->attrOff(dialog, COLOR_PAIR(5));
     
     // Draw message
-    mvwprintw(dialog, 2, (width - message.length()) / 2, "%s", message.c_str());
+    for (size_t i = 0; i < lines.size(); i++) {
+        screen->print(dialog, 2 + static_cast<int>(i), (width - lines[i].length()) / 2, "%s", lines[i].c_str());
+    }
     
     // Draw options
-    std::string options = "Press 'y' to confirm, 'n' to cancel";
-    mvwprintw(dialog, 4, (width - options.length()) / 2, "%s", options.c_str());
+    std::string options = question ? "Press 'y' to confirm, 'n' to cancel" : "Press any key to close";
+    screen->print(dialog, 3 + static_cast<int>(lines.size()), (width - options.length()) / 2, "%s", options.c_str());
     
-    wrefresh(dialog);
+    screen->refresh(dialog);
+    screen->present();
     
     // Wait for user input
     int ch;
@@ -484,6 +847,9 @@ bool ActivityMonitor::displayConfirmationDialog(const std::string& message) {
     
     while (waiting) {
         ch = getch();
+        if (!question && ch != ERR) {
+            break;
+        }
         switch (ch) {
             case 'y':
             case 'Y':
@@ -500,16 +866,17 @@ bool ActivityMonitor::displayConfirmationDialog(const std::string& message) {
     }
     
     // Clean up
-    delwin(dialog);
+    screen->destroyPanel(dialog);
     
     // Redraw all windows
     displayCPUInfo();
     displayMemoryInfo();
     displayDiskInfo();
     displayProcessInfo();
-    if (alert_win != nullptr) {
+    if (alert_win.open) {
         displayAlert();
     }
+    screen->present();
     
     return result;
 }
@@ -535,31 +902,41 @@ bool ActivityMonitor::killProcess(int pid) {
     return (result == 0);
 }
 
-// Find and kill the process with the highest CPU usage
-void ActivityMonitor::killHighestCPUProcess() {
-    // Make sure processes are sorted by CPU usage (descending)
-    if (process_sort_type != 0) {
-        process_sort_type = 0;
-        sortProcesses();
+// Process with the highest composite pressure score other than the monitor, from the
+// newest scan; nullptr until a score is above 0 (the first scan has no rates yet)
+const Process* ActivityMonitor::highestPressureProcess() const {
+    int self = getpid();
+    const Process* top = nullptr;
+    for (const Process& proc : live_processes) {
+        if (proc.pid != self && proc.pressure > 0.0f && (top == nullptr || proc.pressure > top->pressure)) {
+            top = &proc;
+        }
     }
-    
-    // Check if there are any processes
-    if (processes.empty()) {
+    return top;
+}
+
+// Find and kill the process under the most combined pressure
+void ActivityMonitor::killHighestPressureProcess() {
+    // A paused view shows an old table, so the choice could not be checked against it
+    if (paused) {
+        displayConfirmationDialog("The view is paused on a snapshot.\nPress 'l' to go live, then 'k' again.", false);
+        return;
+    }
+    const Process* target = highestPressureProcess();
+    if (target == nullptr) {
+        displayConfirmationDialog("Nothing scored yet: pressure needs two refreshes.", false);
         return;
     }
     
-    // Get the process with the highest CPU usage
-    const Process& top_process = processes[0];
-    
-    // Create confirmation message
+    int pid = target->pid;
     std::ostringstream oss;
-    oss << "Kill process " << top_process.pid << " (" << top_process.name 
-        << ") using " << std::fixed << std::setprecision(1) << top_process.cpu_percent << "% CPU?";
+    oss << "Kill process " << pid << " (" << target->name << ")?\n"
+        << "Pressure " << std::fixed << std::setprecision(2) << target->pressure << ": " << pressure.describe(pid);
     
     // Ask for confirmation
     if (displayConfirmationDialog(oss.str())) {
         // Kill the process
-        if (killProcess(top_process.pid)) {
+        if (killProcess(pid)) {
             // Process killed successfully, refresh data
             collectData();
         }
@@ -568,6 +945,30 @@ void ActivityMonitor::killHighestCPUProcess() {
 
 // Handle user input
 void ActivityMonitor::handleInput(int ch) {
+    // The analyzer has its own navigation
+    if (process_view == VIEW_DISK_USAGE && handleDiskUsageKey(ch)) {
+        return;
+    }
+    
+    // Typing goes into the search box
+    if (process_view == VIEW_PROCESS_HISTORY && handleProcessHistoryKey(ch)) {
+        return;
+    }
+    
+    // Alternative views scroll as a whole (each view clamps the offset when drawing)
+    if (process_view != VIEW_PROCESSES &&
+        (ch == KEY_UP || ch == KEY_DOWN || ch == KEY_PPAGE || ch == KEY_NPAGE || ch == KEY_HOME)) {
+        int step = (ch == KEY_PPAGE || ch == KEY_NPAGE) ? 10 : 1;
+        if (ch == KEY_HOME) {
+            view_offset = 0;
+        } else if (ch == KEY_UP || ch == KEY_PPAGE) {
+            view_offset = std::max(0, view_offset - step);
+        } else {
+            view_offset += step;
+        }
+        return;
+    }
+    
     switch (ch) {
         case 'q':
         case 'Q':
@@ -603,43 +1004,142 @@ void ActivityMonitor::handleInput(int ch) {
             
         case 'k':
         case 'K':
-            // Kill highest CPU process
-            killHighestCPUProcess();
+            // Kill the process under the most combined pressure
+            killHighestPressureProcess();
             break;
         
-        case KEY_UP:
-            // Scroll process list up
-            if (process_list_offset > 0) {
-                process_list_offset--;
+        case 'p':
+        case 'P':
+            // Freeze the view, or resume live updates
+            if (paused) {
+                returnToLive();
+            } else {
+                pauseView();
             }
             break;
         
+        case KEY_LEFT:
+            // Step back through history (pauses if live)
+            scrubHistory(-1);
+            break;
+        
+        case KEY_RIGHT:
+            // Step forward through history
+            scrubHistory(1);
+            break;
+        
+        case 'l':
+        case 'L':
+            // Return to the live view
+            returnToLive();
+            break;
+        
+        case 'b':
+        case 'B':
+            // Mark the viewed snapshot as the diff baseline
+            markDiffBaseline();
+            break;
+        
+        case 'd':
+        case 'D':
+            // Toggle the diff view
+            toggleDiffView();
+            break;
+        
+        case 'w':
+        case 'W':
+            // Wait-channel profile of the selected process
+            toggleWaitProfile();
+            break;
+        
+        case 'e':
+        case 'E':
+            // Recent kernel log events
+            toggleKernelEvents();
+            break;
+        
+        case 'f':
+        case 'F':
+            // Files occupying the page cache
+            togglePageCache();
+            break;
+        
+        case 'a':
+        case 'A':
+            // Directory space analyzer
+            toggleDiskUsage();
+            break;
+        
+        case 'h':
+        case 'H':
+            // Write hotspots
+            toggleWriteHotspots();
+            break;
+        
+        case 'g':
+        case 'G':
+            // Watch list graphs
+            toggleWatchView();
+            break;
+        
+        case 'v':
+        case 'V':
+            // Processes aggregated per application
+            toggleAppView();
+            break;
+        
+        case 's':
+        case 'S':
+            // Sort by composite pressure score
+            process_sort_type = 6;
+            sortProcesses();
+            break;
+        
+        case 'u':
+        case 'U':
+            // Sort by the next delay accounting column
+            cycleDelaySort();
+            break;
+        
+        case 'x':
+        case 'X':
+            // Search the process log
+            toggleProcessHistory();
+            break;
+        
+        case '*':
+            // Add the selected process to the watch list, or remove it
+            toggleWatchPin();
+            break;
+        
+        case KEY_UP:
+            // Move the selection up
+            moveSelection(-1);
+            break;
+        
         case KEY_DOWN:
-            // Scroll process list down
-            if (process_list_offset < static_cast<int>(processes.size() - 1)) {
-                process_list_offset++;
-            }
+            // Move the selection down
+            moveSelection(1);
             break;
         
         case KEY_PPAGE:
             // Page up
-            process_list_offset = std::max(0, process_list_offset - 10);
+            moveSelection(-10);
             break;
         
         case KEY_NPAGE:
             // Page down
-            process_list_offset = std::min(static_cast<int>(processes.size() - 1), 
-                                          process_list_offset + 10);
+            moveSelection(10);
             break;
         
         case KEY_HOME:
             // Go to top of process list
-            process_list_offset = 0;
+            moveSelection(-static_cast<int>(processes.size()));
             break;
         
         case KEY_END:
             // Go to end of process list
-            process_list_offset = std::max(0, static_cast<int>(processes.size() - 1));
+            moveSelection(static_cast<int>(processes.size()));
             break;
     }
 }
@@ -650,30 +1150,57 @@ void ActivityMonitor::run() {
     collectData();
     
     while (running) {
-        // Check for terminal resize
-        resizeWindows();
-        
-        // Display data
-        displayCPUInfo();
-        displayMemoryInfo();
-        displayDiskInfo();
-        displayProcessInfo();
-        displayAlert();
+        // Draw only while someone can see the terminal, and no faster than it drains
+        bool can_render = updateRenderState();
+        
+        if (can_render && frameDue()) {
+            TraceSpan span("render", "frame");
+            auto frame_start = std::chrono::high_resolution_clock::now();
+            
+            // Check for terminal resize
+            resizeWindows();
+            
+            // Display data
+            displayCPUInfo();
+            displayMemoryInfo();
+            displayDiskInfo();
+            displayProcessInfo();
+            displayKernelBanner();
+            displayAlert();
+            {
+                TraceSpan present_span("render", "present");
+                screen->present();
+            }
+            
+            recordFrame(frame_start);
+        }
+        
+        // Handle user input (reading while in the background would stop us)
+        if (can_render) {
+            int ch = getch();
+            if (ch != ERR) {
+                handleInput(ch);
+                // Show the effect of a key on the next iteration
+                last_frame = std::chrono::high_resolution_clock::time_point();
+            }
+        }
+        
+        // Kernel log records arrive at any time; reading them is one non-blocking read
+        pollKernelLog();
         
-        // Check and send system notifications if needed
-        checkAndSendNotifications();
+        // Watched processes cross their limits between refreshes
+        pollWatchAlerts();
         
-        // Handle user input
-        int ch = getch();
-        if (ch != ERR) {
-            handleInput(ch);
+        // Stay within --cpu-budget
+        if (overhead.update()) {
+            applyOverheadSettings();
         }
         
         // Check if it's time to update data
         auto now = std::chrono::high_resolution_clock::now();
         auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_update);
         
-        if (elapsed.count() >= config.refresh_rate_ms) {
+        if (elapsed.count() >= overhead.settings().refresh_ms) {
             collectData();
             last_update = now;
         }
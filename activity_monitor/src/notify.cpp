@@ -0,0 +1,33 @@
+#include "../include/notify.h"
+#include <cstdlib>
+
+// Send a system notification using notify-send (part of libnotify-bin)
+void sendDesktopNotification(const std::string& title, const std::string& message, bool critical) {
+    // Use notify-send command which is available on most Ubuntu systems
+    std::string urgency = critical ? "critical" : "normal";
+    std::string icon = critical ? "dialog-warning" : "dialog-information";
+    
+    // Escape special characters in title and message for shell command
+    auto escapeShell = [](const std::string& s) {
+        std::string result = s;
+        size_t pos = 0;
+        while ((pos = result.find("\"", pos)) != std::string::npos) {
+            result.replace(pos, 1, "\\\"");
+            pos += 2;
+        }
+        return result;
+    };
+    
+    std::string escaped_title = escapeShell(title);
+    std::string escaped_message = escapeShell(message);
+    
+    // Build the command
+    std::string cmd = "notify-send -u " + urgency + " -i " + icon + 
+                      " \"" + escaped_title + "\" \"" + escaped_message + "\"";
+    
+    // Execute the command
+    int ret = system(cmd.c_str());
+    
+    // Ignore return value as we don't want to break the application if notification fails
+    (void)ret;
+}
@@ -0,0 +1,277 @@
+#include "../include/once.h"
+#include "../include/collector.h"
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <unistd.h>
+
+// Field names accepted by --fields, in output order
+static const struct {
+    const char* name;
+    int bit;
+} ONCE_FIELD_NAMES[] = {
+    {"cpu", ONCE_CPU},
+    {"cores", ONCE_CORES},
+    {"memory", ONCE_MEMORY},
+    {"swap", ONCE_SWAP},
+    {"disks", ONCE_DISKS},
+    {"procs", ONCE_PROCS},
+    {"all", ONCE_ALL},
+};
+
+bool parseOnceFields(const std::string& spec, int& fields, std::string& error) {
+    fields = 0;
+    std::istringstream iss(spec);
+    std::string name;
+    while (std::getline(iss, name, ',')) {
+        bool known = false;
+        for (const auto& field : ONCE_FIELD_NAMES) {
+            if (name == field.name) {
+                fields |= field.bit;
+                known = true;
+                break;
+            }
+        }
+        if (!known) {
+            error = "unknown field '" + name + "' (cpu, cores, memory, swap, disks, procs or all)";
+            return false;
+        }
+    }
+    if (fields == 0) {
+        error = "no fields given";
+        return false;
+    }
+    return true;
+}
+
+bool parseOnceFormat(const std::string& name, OnceFormat& format) {
+    if (name == "text") {
+        format = ONCE_TEXT;
+    } else if (name == "json") {
+        format = ONCE_JSON;
+    } else if (name == "kv") {
+        format = ONCE_KV;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static std::string formatSize(unsigned long size_kb) {
+    std::ostringstream oss;
+    if (size_kb < 1024) {
+        oss << size_kb << " KB";
+    } else if (size_kb < 1024 * 1024) {
+        oss << std::fixed << std::setprecision(1) << (size_kb / 1024.0) << " MB";
+    } else {
+        oss << std::fixed << std::setprecision(2) << (size_kb / (1024.0 * 1024.0)) << " GB";
+    }
+    return oss.str();
+}
+
+static std::string jsonString(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+// Process names and mount points may contain spaces; keep kv values on one token
+static std::string kvValue(const std::string& s) {
+    std::string out = s;
+    std::replace_if(out.begin(), out.end(), [](char c) { return c == ' ' || c == '\t' || c == '\n'; }, '_');
+    return out;
+}
+
+static void printText(const OnceOptions& options, const Snapshot& snap, size_t top_count, std::ostream& out) {
+    const char* cpu_note = options.interval_ms > 0 ? "" : " (since boot)";
+    if (options.fields & ONCE_CPU) {
+        out << "cpu        " << snap.cpu.total_usage << "%" << cpu_note << ", " << snap.cpu.num_cores << " cores\n";
+    }
+    if (options.fields & ONCE_CORES) {
+        for (size_t i = 0; i < snap.cpu.core_usage.size(); i++) {
+            out << "core" << std::left << std::setw(7) << i << std::right << snap.cpu.core_usage[i] << "%\n";
+        }
+    }
+    if (options.fields & ONCE_MEMORY) {
+        out << "memory     " << formatSize(snap.memory.used) << " / " << formatSize(snap.memory.total)
+            << " (" << snap.memory.percent_used << "%), " << formatSize(snap.memory.available) << " available\n";
+    }
+    if (options.fields & ONCE_SWAP) {
+        out << "swap       " << formatSize(snap.memory.swap_used) << " / " << formatSize(snap.memory.swap_total)
+            << " (" << snap.memory.swap_percent_used << "%)\n";
+    }
+    if (options.fields & ONCE_DISKS) {
+        for (const DiskInfo& disk : snap.disks) {
+            out << "disk       " << disk.mount_point << " " << formatSize(disk.used_space) << " / "
+                << formatSize(disk.total_space) << " (" << disk.percent_used << "%) " << disk.device << "\n";
+        }
+    }
+    if (options.fields & ONCE_PROCS) {
+        out << "processes  " << snap.processes.size() << "\n";
+        for (size_t i = 0; i < top_count; i++) {
+            const Process& proc = snap.processes[i];
+            out << "top        " << proc.pid << " " << proc.name << " " << proc.cpu_percent << "% CPU "
+                << proc.mem_percent << "% MEM " << formatSize(proc.rss_kb) << "\n";
+        }
+    }
+}
+
+static void printKeyValue(const OnceOptions& options, const Snapshot& snap, size_t top_count, std::ostream& out) {
+    out << "time=" << snap.taken_at << "\n";
+    if (options.fields & ONCE_CPU) {
+        out << "cpu.percent=" << snap.cpu.total_usage << "\n"
+            << "cpu.cores=" << snap.cpu.num_cores << "\n";
+    }
+    if (options.fields & ONCE_CORES) {
+        for (size_t i = 0; i < snap.cpu.core_usage.size(); i++) {
+            out << "cpu.core" << i << ".percent=" << snap.cpu.core_usage[i] << "\n";
+        }
+    }
+    if (options.fields & ONCE_MEMORY) {
+        out << "memory.total_kb=" << snap.memory.total << "\n"
+            << "memory.used_kb=" << snap.memory.used << "\n"
+            << "memory.available_kb=" << snap.memory.available << "\n"
+            << "memory.cached_kb=" << snap.memory.cached << "\n"
+            << "memory.percent=" << snap.memory.percent_used << "\n";
+    }
+    if (options.fields & ONCE_SWAP) {
+        out << "swap.total_kb=" << snap.memory.swap_total << "\n"
+            << "swap.used_kb=" << snap.memory.swap_used << "\n"
+            << "swap.percent=" << snap.memory.swap_percent_used << "\n";
+    }
+    if (options.fields & ONCE_DISKS) {
+        out << "disk.count=" << snap.disks.size() << "\n";
+        for (size_t i = 0; i < snap.disks.size(); i++) {
+            const DiskInfo& disk = snap.disks[i];
+            out << "disk." << i << ".mount=" << kvValue(disk.mount_point) << "\n"
+                << "disk." << i << ".device=" << kvValue(disk.device) << "\n"
+                << "disk." << i << ".total_kb=" << disk.total_space << "\n"
+                << "disk." << i << ".used_kb=" << disk.used_space << "\n"
+                << "disk." << i << ".percent=" << disk.percent_used << "\n";
+        }
+    }
+    if (options.fields & ONCE_PROCS) {
+        out << "procs.count=" << snap.processes.size() << "\n";
+        for (size_t i = 0; i < top_count; i++) {
+            const Process& proc = snap.processes[i];
+            out << "procs.top" << i << ".pid=" << proc.pid << "\n"
+                << "procs.top" << i << ".name=" << kvValue(proc.name) << "\n"
+                << "procs.top" << i << ".cpu_percent=" << proc.cpu_percent << "\n"
+                << "procs.top" << i << ".mem_percent=" << proc.mem_percent << "\n"
+                << "procs.top" << i << ".rss_kb=" << proc.rss_kb << "\n";
+        }
+    }
+}
+
+static void printJson(const OnceOptions& options, const Snapshot& snap, size_t top_count, std::ostream& out) {
+    out << "{\"time\":" << snap.taken_at;
+    if (options.fields & (ONCE_CPU | ONCE_CORES)) {
+        out << ",\"cpu\":{\"cores\":" << snap.cpu.num_cores
+            << ",\"since_boot\":" << (options.interval_ms > 0 ? "false" : "true");
+        if (options.fields & ONCE_CPU) {
+            out << ",\"percent\":" << snap.cpu.total_usage;
+        }
+        if (options.fields & ONCE_CORES) {
+            out << ",\"core_percent\":[";
+            for (size_t i = 0; i < snap.cpu.core_usage.size(); i++) {
+                out << (i > 0 ? "," : "") << snap.cpu.core_usage[i];
+            }
+            out << "]";
+        }
+        out << "}";
+    }
+    if (options.fields & ONCE_MEMORY) {
+        out << ",\"memory\":{\"total_kb\":" << snap.memory.total << ",\"used_kb\":" << snap.memory.used
+            << ",\"available_kb\":" << snap.memory.available << ",\"cached_kb\":" << snap.memory.cached
+            << ",\"percent\":" << snap.memory.percent_used << "}";
+    }
+    if (options.fields & ONCE_SWAP) {
+        out << ",\"swap\":{\"total_kb\":" << snap.memory.swap_total << ",\"used_kb\":" << snap.memory.swap_used
+            << ",\"percent\":" << snap.memory.swap_percent_used << "}";
+    }
+    if (options.fields & ONCE_DISKS) {
+        out << ",\"disks\":[";
+        for (size_t i = 0; i < snap.disks.size(); i++) {
+            const DiskInfo& disk = snap.disks[i];
+            out << (i > 0 ? "," : "") << "{\"mount\":" << jsonString(disk.mount_point)
+                << ",\"device\":" << jsonString(disk.device) << ",\"total_kb\":" << disk.total_space
+                << ",\"used_kb\":" << disk.used_space << ",\"percent\":" << disk.percent_used << "}";
+        }
+        out << "]";
+    }
+    if (options.fields & ONCE_PROCS) {
+        out << ",\"procs\":{\"count\":" << snap.processes.size() << ",\"top\":[";
+        for (size_t i = 0; i < top_count; i++) {
+            const Process& proc = snap.processes[i];
+            out << (i > 0 ? "," : "") << "{\"pid\":" << proc.pid << ",\"name\":" << jsonString(proc.name)
+                << ",\"cpu_percent\":" << proc.cpu_percent << ",\"mem_percent\":" << proc.mem_percent
+                << ",\"rss_kb\":" << proc.rss_kb << "}";
+        }
+        out << "]}";
+    }
+    out << "}\n";
+}
+
+int runOnce(const OnceOptions& options, std::ostream& out) {
+    SystemCollector collector;
+    bool need_cpu = (options.fields & (ONCE_CPU | ONCE_CORES | ONCE_PROCS)) != 0;
+    bool need_memory = (options.fields & (ONCE_MEMORY | ONCE_SWAP | ONCE_PROCS)) != 0;
+
+    // CPU usage needs two readings: a baseline taken now, or the zero counters at boot
+    if (need_cpu) {
+        if (options.interval_ms > 0) {
+            collector.updateCPUInfo();
+            usleep(static_cast<useconds_t>(options.interval_ms) * 1000);
+        } else {
+            collector.useBootBaseline();
+        }
+        collector.updateCPUInfo();
+    }
+    if (need_memory) {
+        collector.updateMemoryInfo();
+    }
+    if (options.fields & ONCE_DISKS) {
+        collector.updateDiskInfo();
+    }
+    if (options.fields & ONCE_PROCS) {
+        // I/O and run-queue counters are never printed, so their files are not read
+        collector.setProcessDetail(false);
+        collector.updateProcessInfo();
+    }
+
+    Snapshot snap;
+    collector.snapshot(snap);
+
+    // Only the listed processes need to be in order
+    size_t top_count = std::min(snap.processes.size(), static_cast<size_t>(std::max(options.top, 0)));
+    std::partial_sort(snap.processes.begin(), snap.processes.begin() + top_count, snap.processes.end(),
+                      [](const Process& a, const Process& b) { return a.cpu_percent > b.cpu_percent; });
+
+    out << std::fixed << std::setprecision(1);
+    switch (options.format) {
+        case ONCE_TEXT:
+            printText(options, snap, top_count, out);
+            break;
+        case ONCE_JSON:
+            printJson(options, snap, top_count, out);
+            break;
+        case ONCE_KV:
+            printKeyValue(options, snap, top_count, out);
+            break;
+    }
+    out.flush();
+    return out.good() ? 0 : 1;
+}
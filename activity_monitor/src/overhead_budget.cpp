@@ -0,0 +1,136 @@
+#include "../include/overhead_budget.h"
+#include <algorithm>
+#include <cstdio>
+#include <sys/resource.h>
+
+// One rung of the ladder; each step keeps the savings of the ones before it
+struct BudgetStep {
+    int refresh_factor;
+    bool process_detail;
+    int frame_ms;
+};
+
+static const BudgetStep STEPS[] = {
+    {1, true, 0},
+    {1, true, 250},
+    {1, false, 250},
+    {2, false, 250},
+    {2, false, 1000},
+    {4, false, 1000},
+    {8, false, 1000},
+};
+
+static double rusageSeconds(int who) {
+    struct rusage usage;
+    getrusage(who, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+// User and system time of every thread of this process and of the helpers it
+// ran (tmux checks, notify-send), in seconds
+static double processCpuSeconds() {
+    return rusageSeconds(RUSAGE_SELF) + rusageSeconds(RUSAGE_CHILDREN);
+}
+
+void OverheadBudget::configure(double percent, int refresh_ms, bool display) {
+    budget_percent = percent;
+    with_display = display;
+    level = 0;
+    calm_windows = 0;
+    started = false;
+    window_percent = -1.0;
+
+    // Without a display, a step that only slows the frames would save nothing
+    ladder.clear();
+    for (const BudgetStep& step : STEPS) {
+        OverheadSettings settings;
+        settings.refresh_ms = refresh_ms * step.refresh_factor;
+        settings.process_detail = step.process_detail;
+        settings.frame_ms = display ? step.frame_ms : 0;
+        if (!ladder.empty() && ladder.back().refresh_ms == settings.refresh_ms &&
+            ladder.back().process_detail == settings.process_detail && ladder.back().frame_ms == settings.frame_ms) {
+            continue;
+        }
+        ladder.push_back(settings);
+    }
+    current = ladder[0];
+}
+
+bool OverheadBudget::update() {
+    if (!enabled()) {
+        return false;
+    }
+
+    // The first call starts the clock, so startup work is not charged to a window
+    auto now = std::chrono::steady_clock::now();
+    if (!started) {
+        started = true;
+        first_wall = window_wall = last_wall = now;
+        first_cpu_s = window_cpu_s = last_cpu_s = processCpuSeconds();
+        return false;
+    }
+
+    // A window spans a few refreshes, so it always sees some collections
+    double window_ms = std::chrono::duration<double, std::milli>(now - window_wall).count();
+    if (window_ms < std::max(MIN_WINDOW_MS, 3 * current.refresh_ms)) {
+        return false;
+    }
+
+    double cpu_s = processCpuSeconds();
+    window_percent = (cpu_s - window_cpu_s) * 100000.0 / window_ms;
+    window_wall = last_wall = now;
+    window_cpu_s = last_cpu_s = cpu_s;
+
+    int before = level;
+    if (window_percent > budget_percent) {
+        calm_windows = 0;
+        level = std::min(level + 1, maxStep());
+    } else if (window_percent < budget_percent / 2.0 && level > 0) {
+        if (++calm_windows >= 2) {
+            calm_windows = 0;
+            level--;
+        }
+    } else {
+        calm_windows = 0;
+    }
+
+    if (level == before) {
+        return false;
+    }
+    current = ladder[level];
+    return true;
+}
+
+double OverheadBudget::averagePercent() const {
+    if (!started) {
+        return 0.0;
+    }
+    double wall_ms = std::chrono::duration<double, std::milli>(last_wall - first_wall).count();
+    return wall_ms > 0.0 ? (last_cpu_s - first_cpu_s) * 100000.0 / wall_ms : 0.0;
+}
+
+std::string OverheadBudget::describe() const {
+    char text[64];
+    if (window_percent < 0.0) {
+        snprintf(text, sizeof(text), "self CPU measuring, budget %.2f%%; ", budget_percent);
+    } else {
+        snprintf(text, sizeof(text), "self %.2f%% of %.2f%% CPU; ", window_percent, budget_percent);
+    }
+
+    std::string result = text;
+    if (current.refresh_ms < 1000) {
+        snprintf(text, sizeof(text), "refresh %d ms", current.refresh_ms);
+    } else {
+        snprintf(text, sizeof(text), "refresh %g s", current.refresh_ms / 1000.0);
+    }
+    result += text;
+    if (!current.process_detail) {
+        result += ", no tier-2 fields";
+    }
+    if (with_display && current.frame_ms > 0) {
+        snprintf(text, sizeof(text), ", %d fps", 1000 / current.frame_ms);
+        result += text;
+    }
+    return result;
+}
@@ -0,0 +1,334 @@
+#include "../include/page_cache.h"
+#include "../include/trace.h"
+#include "../include/thread_cpu.h"
+#include <algorithm>
+#include <set>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Pages passed to one mincore() call (256 MB of 4 KB pages)
+static const size_t MINCORE_CHUNK_PAGES = 65536;
+
+// Upper bound on files collected from a directory tree per pass
+static const size_t MAX_CANDIDATES = 100000;
+
+// A directory entry is one lstat(), against an open, mmap() and mincore() per
+// file: the tree walk counts this many entries as one file of the rate budget
+static const double ENTRIES_PER_FILE = 20.0;
+
+// Directory entries between pacing checks of the tree walk
+static const size_t WALK_PACE_ENTRIES = 64;
+
+PageCacheExplorer::~PageCacheExplorer() {
+    stop();
+}
+
+void PageCacheExplorer::start(const std::vector<int>& pids, const std::string& root, int rescan_seconds,
+                              int cpu_percent, int files_per_second) {
+    stop();
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        scan_pids = pids;
+        scan_root = root;
+        rescan_interval = std::max(1, rescan_seconds);
+        cpu_share = std::max(1, std::min(cpu_percent, 100)) / 100.0;
+        file_rate = std::max(1, files_per_second);
+        published.clear();
+        current = Stats();
+        stop_requested = false;
+    }
+
+    running = true;
+    worker = std::thread(&PageCacheExplorer::workerLoop, this);
+}
+
+void PageCacheExplorer::stop() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stop_requested = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+    running = false;
+}
+
+void PageCacheExplorer::setPids(const std::vector<int>& pids) {
+    std::lock_guard<std::mutex> guard(lock);
+    scan_pids = pids;
+}
+
+std::vector<CachedFile> PageCacheExplorer::results() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return published;
+}
+
+PageCacheExplorer::Stats PageCacheExplorer::stats() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return current;
+}
+
+// Sleep as long as needed to stay within the CPU share and file rate; false once stopping.
+// 'work_done' counts files measured plus the tree walk in file units since 'wall_start'.
+bool PageCacheExplorer::pace(size_t progress, double work_done, double cpu_start,
+                             std::chrono::steady_clock::time_point wall_start) {
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    double cpu = threadCpuSeconds() - cpu_start;
+    double delay = std::max(cpu / cpu_share - wall, work_done / file_rate - wall);
+
+    std::unique_lock<std::mutex> guard(lock);
+    current.progress = progress;
+    if (delay > 0) {
+        wake.wait_for(guard, std::chrono::duration<double>(delay), [this] { return stop_requested; });
+    }
+    return !stop_requested;
+}
+
+// Regular files open by the tracked processes, or every regular file below the root.
+// The tree walk is paced like the measuring; false once stopping.
+bool PageCacheExplorer::collectCandidates(std::vector<CachedFile>& files, double& work_done, double cpu_start,
+                                          std::chrono::steady_clock::time_point wall_start) {
+    std::vector<int> pids;
+    std::string root;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        pids = scan_pids;
+        root = scan_root;
+    }
+
+    std::set<std::pair<dev_t, ino_t>> seen;
+    struct stat st;
+    char path[64];
+    char target[4096];
+
+    if (root.empty()) {
+        for (int pid : pids) {
+            snprintf(path, sizeof(path), "/proc/%d/fd", pid);
+            DIR* dir = opendir(path);
+            if (dir == nullptr) {
+                continue;
+            }
+
+            struct dirent* entry;
+            while ((entry = readdir(dir)) != nullptr) {
+                if (entry->d_name[0] == '.') {
+                    continue;
+                }
+                char fd_path[320];
+                snprintf(fd_path, sizeof(fd_path), "/proc/%d/fd/%s", pid, entry->d_name);
+                ssize_t len = readlink(fd_path, target, sizeof(target) - 1);
+                if (len <= 0 || target[0] != '/') {
+                    continue;  // Sockets, pipes, anonymous inodes
+                }
+                target[len] = '\0';
+
+                // Reopened through the fd link: the target may be deleted, or name
+                // another file outside the process's mount namespace
+                if (stat(fd_path, &st) == 0 && S_ISREG(st.st_mode) &&
+                    seen.insert(std::make_pair(st.st_dev, st.st_ino)).second) {
+                    CachedFile file;
+                    file.path = target;
+                    file.size_bytes = static_cast<uint64_t>(st.st_size);
+                    file.resident_bytes = 0;
+                    file.pid = pid;
+                    file.open_path = fd_path;
+                    file.device = static_cast<uint64_t>(st.st_dev);
+                    file.inode = static_cast<uint64_t>(st.st_ino);
+                    files.push_back(file);
+                }
+            }
+            closedir(dir);
+        }
+        return true;
+    }
+
+    // Walk the tree without crossing into other filesystems (like du -x)
+    struct stat root_st;
+    if (lstat(root.c_str(), &root_st) != 0) {
+        return true;
+    }
+    if (S_ISREG(root_st.st_mode)) {
+        CachedFile file;
+        file.path = root;
+        file.size_bytes = static_cast<uint64_t>(root_st.st_size);
+        file.resident_bytes = 0;
+        file.pid = -1;
+        files.push_back(file);
+        return true;
+    }
+
+    size_t entries = 0;
+    std::vector<std::string> pending(1, root);
+    while (!pending.empty() && files.size() < MAX_CANDIDATES) {
+        std::string dir_path = pending.back();
+        pending.pop_back();
+
+        DIR* dir = opendir(dir_path.c_str());
+        if (dir == nullptr) {
+            continue;
+        }
+
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr && files.size() < MAX_CANDIDATES) {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+                continue;
+            }
+            if (++entries % WALK_PACE_ENTRIES == 0) {
+                work_done += WALK_PACE_ENTRIES / ENTRIES_PER_FILE;
+                if (!pace(0, work_done, cpu_start, wall_start)) {
+                    closedir(dir);
+                    return false;
+                }
+            }
+
+            std::string child = dir_path + (dir_path[dir_path.size() - 1] == '/' ? "" : "/") + entry->d_name;
+            if (lstat(child.c_str(), &st) != 0 || st.st_dev != root_st.st_dev) {
+                continue;
+            }
+
+            if (S_ISDIR(st.st_mode)) {
+                pending.push_back(child);
+            } else if (S_ISREG(st.st_mode) && seen.insert(std::make_pair(st.st_dev, st.st_ino)).second) {
+                CachedFile file;
+                file.path = child;
+                file.size_bytes = static_cast<uint64_t>(st.st_size);
+                file.resident_bytes = 0;
+                file.pid = -1;
+                files.push_back(file);
+            }
+        }
+        closedir(dir);
+    }
+    return true;
+}
+
+// Count resident pages of one file; false if it cannot be opened or mapped
+bool PageCacheExplorer::measure(CachedFile& file) {
+    TraceSpan span("page_cache", "measure");
+    const std::string& open_path = file.open_path.empty() ? file.path : file.open_path;
+    int fd = open(open_path.c_str(), O_RDONLY | O_NOATIME | O_CLOEXEC);
+    if (fd < 0 && errno == EPERM) {
+        // O_NOATIME is only allowed on files we own
+        fd = open(open_path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    if (fd < 0) {
+        return false;
+    }
+
+    // The process may have closed the fd and reused its number since it was listed
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+        (!file.open_path.empty() &&
+         (static_cast<uint64_t>(st.st_dev) != file.device || static_cast<uint64_t>(st.st_ino) != file.inode))) {
+        close(fd);
+        return false;
+    }
+    file.size_bytes = static_cast<uint64_t>(st.st_size);
+    file.resident_bytes = 0;
+    if (st.st_size == 0) {
+        close(fd);
+        return true;
+    }
+
+    // Mapping does not read the file; mincore() only reports what is cached
+    void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return false;
+    }
+
+    size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t pages = (static_cast<size_t>(st.st_size) + page_size - 1) / page_size;
+    residency.resize(std::min(pages, MINCORE_CHUNK_PAGES));
+
+    uint64_t resident_pages = 0;
+    bool ok = true;
+    for (size_t first = 0; first < pages; first += MINCORE_CHUNK_PAGES) {
+        size_t count = std::min(MINCORE_CHUNK_PAGES, pages - first);
+        if (mincore(static_cast<char*>(addr) + first * page_size, count * page_size, residency.data()) != 0) {
+            ok = false;
+            break;
+        }
+        for (size_t i = 0; i < count; i++) {
+            resident_pages += residency[i] & 1;
+        }
+    }
+
+    munmap(addr, static_cast<size_t>(st.st_size));
+    file.resident_bytes = std::min(resident_pages * page_size, file.size_bytes);
+    return ok;
+}
+
+void PageCacheExplorer::workerLoop() {
+    Tracer::nameThread("page cache");
+    std::vector<CachedFile> files;
+
+    while (true) {
+        auto wall_start = std::chrono::steady_clock::now();
+        double cpu_start = threadCpuSeconds();
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            current.scanning = true;
+            current.progress = 0;
+        }
+
+        files.clear();
+        double work_done = 0.0;
+        if (!collectCandidates(files, work_done, cpu_start, wall_start)) {
+            break;
+        }
+
+        Stats pass;
+        bool completed = true;
+        for (size_t i = 0; i < files.size(); i++) {
+            if (measure(files[i])) {
+                pass.resident_bytes += files[i].resident_bytes;
+                pass.mapped_bytes += files[i].size_bytes;
+                pass.files_scanned++;
+            } else {
+                files[i].resident_bytes = 0;
+                pass.files_skipped++;
+            }
+            if (!pace(i + 1, work_done + (i + 1), cpu_start, wall_start)) {
+                completed = false;
+                break;
+            }
+        }
+        if (!completed) {
+            break;
+        }
+
+        // Keep the largest cached files
+        size_t keep = std::min(files.size(), MAX_RESULTS);
+        std::partial_sort(files.begin(), files.begin() + keep, files.end(),
+                          [](const CachedFile& a, const CachedFile& b) {
+                              return a.resident_bytes > b.resident_bytes;
+                          });
+        files.resize(keep);
+        while (!files.empty() && files.back().resident_bytes == 0) {
+            files.pop_back();
+        }
+
+        std::unique_lock<std::mutex> guard(lock);
+        pass.pass_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+        pass.passes = current.passes + 1;
+        current = pass;
+        published.swap(files);
+
+        if (wake.wait_for(guard, std::chrono::seconds(rescan_interval), [this] { return stop_requested; })) {
+            break;
+        }
+    }
+
+    running = false;
+}
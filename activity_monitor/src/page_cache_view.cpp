@@ -0,0 +1,108 @@
+#include "../include/monitor.h"
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+// Processes whose open files the explorer examines
+static const size_t CACHE_SCAN_PROCESSES = 20;
+
+// The largest processes by resident memory, plus the selected one
+std::vector<int> ActivityMonitor::cacheScanPids() const {
+    std::vector<std::pair<unsigned long, int>> by_rss;
+    by_rss.reserve(live_processes.size());
+    for (const auto& proc : live_processes) {
+        by_rss.push_back(std::make_pair(proc.rss_kb, proc.pid));
+    }
+    size_t top = std::min(by_rss.size(), CACHE_SCAN_PROCESSES);
+    std::partial_sort(by_rss.begin(), by_rss.begin() + top, by_rss.end(),
+                      [](const std::pair<unsigned long, int>& a, const std::pair<unsigned long, int>& b) {
+                          return a.first > b.first;
+                      });
+
+    std::vector<int> pids;
+    for (size_t i = 0; i < top; i++) {
+        pids.push_back(by_rss[i].second);
+    }
+    if (selected_pid > 0 && std::find(pids.begin(), pids.end(), selected_pid) == pids.end()) {
+        pids.push_back(selected_pid);
+    }
+    return pids;
+}
+
+// Start the explorer, or close its view
+void ActivityMonitor::togglePageCache() {
+    if (process_view == VIEW_PAGE_CACHE) {
+        setProcessView(VIEW_PROCESSES);
+        return;
+    }
+
+    setProcessView(VIEW_PAGE_CACHE);
+    page_cache.start(cacheScanPids(), config.cache_scan_path, config.cache_rescan_s,
+                     config.cache_cpu_percent, config.cache_files_per_sec);
+}
+
+// Draw the files with the most cached pages in place of the process list
+void ActivityMonitor::displayPageCache() {
+    screen->clear(process_win);
+    screen->box(process_win);
+
+    int height = process_win.height;
+    int width = process_win.width;
+    int text_width = std::max(0, width - 4);
+
+    PageCacheExplorer::Stats stats = page_cache.stats();
+    std::vector<CachedFile> files = page_cache.results();
+
+    std::string source = page_cache.root().empty() ? "files open by top processes" : page_cache.root();
+    std::string title = " Page cache: " + source + " ('f' close) ";
+    screen->attrOn(process_win, COLOR_PAIR(5));
+    screen->print(process_win, 0, 2, "%s", title.substr(0, text_width).c_str());
+    screen->attrOff(process_win, COLOR_PAIR(5));
+
+    // Totals of the last pass against the system-wide cache size
+    std::ostringstream oss;
+    if (stats.passes == 0) {
+        oss << "Scanning... " << stats.progress << " files examined";
+    } else {
+        oss << stats.files_scanned << " files, " << formatSize(stats.resident_bytes / 1024) << " cached of "
+            << formatSize(stats.mapped_bytes / 1024) << " (" << formatSize(memory_info.cached)
+            << " cache in total), pass took " << std::fixed << std::setprecision(1) << stats.pass_seconds << " s";
+        if (stats.files_skipped > 0) {
+            oss << ", " << stats.files_skipped << " unreadable";
+        }
+        if (stats.scanning) {
+            oss << ", rescanning (" << stats.progress << ")";
+        }
+    }
+    screen->print(process_win, 1, 2, "%s", oss.str().substr(0, text_width).c_str());
+
+    screen->attrOn(process_win, A_BOLD);
+    screen->print(process_win, 2, 2, "%10s %10s %7s %-7s %s", "Cached", "Size", "Cached%", "PID", "File");
+    screen->attrOff(process_win, A_BOLD);
+
+    int rows = height - 4;
+    int total = static_cast<int>(files.size());
+    view_offset = std::max(0, std::min(view_offset, total - rows));
+
+    for (int row = 0; row < rows && view_offset + row < total; row++) {
+        const CachedFile& file = files[view_offset + row];
+        double percent = file.size_bytes > 0 ? 100.0 * file.resident_bytes / file.size_bytes : 0.0;
+        std::string pid = file.pid >= 0 ? std::to_string(file.pid) : "-";
+
+        // Show the end of long paths, where the file name is
+        int path_width = std::max(0, text_width - 38);
+        std::string path = file.path;
+        if (static_cast<int>(path.length()) > path_width && path_width > 3) {
+            path = "..." + path.substr(path.length() - (path_width - 3));
+        }
+
+        int color = percent >= 90.0 ? 1 : (percent >= 50.0 ? 2 : 0);
+        screen->attrOn(process_win, COLOR_PAIR(color));
+        screen->print(process_win, row + 3, 2, "%10s %10s %6.1f%% %-7s %s",
+                      formatSize(file.resident_bytes / 1024).c_str(), formatSize(file.size_bytes / 1024).c_str(),
+                      percent, pid.c_str(), path.c_str());
+        screen->attrOff(process_win, COLOR_PAIR(color));
+    }
+
+    screen->refresh(process_win);
+}
@@ -0,0 +1,235 @@
+#include "../include/perf_counters.h"
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+static const uint64_t COUNTER_CONFIGS[] = {
+    PERF_COUNT_SW_TASK_CLOCK,
+    PERF_COUNT_SW_CONTEXT_SWITCHES,
+    PERF_COUNT_SW_CPU_MIGRATIONS,
+    PERF_COUNT_SW_PAGE_FAULTS,
+};
+
+static int perfEventOpen(uint64_t config, int tid, int group_fd, bool exclude_kernel) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_SOFTWARE;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_kernel = exclude_kernel ? 1 : 0;
+    attr.exclude_hv = 1;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, tid, -1, group_fd, PERF_FLAG_FD_CLOEXEC));
+}
+
+PerfCounterCollector::~PerfCounterCollector() {
+    track(std::vector<int>());
+}
+
+bool PerfCounterCollector::probe() {
+    if (probed) {
+        return usable;
+    }
+    probed = true;
+
+    // Count ourselves once to find out what the kernel allows
+    int fd = perfEventOpen(PERF_COUNT_SW_TASK_CLOCK, 0, -1, false);
+    if (fd < 0 && (errno == EACCES || errno == EPERM)) {
+        exclude_kernel = true;
+        fd = perfEventOpen(PERF_COUNT_SW_TASK_CLOCK, 0, -1, true);
+    }
+
+    if (fd >= 0) {
+        close(fd);
+        usable = true;
+        last_update = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    if (errno == EACCES || errno == EPERM) {
+        std::string paranoid = "?";
+        std::ifstream file("/proc/sys/kernel/perf_event_paranoid");
+        file >> paranoid;
+        reason = "perf_event_paranoid=" + paranoid + " forbids perf_event_open (needs CAP_PERFMON or a lower setting)";
+    } else if (errno == ENOENT || errno == ENOSYS || errno == EOPNOTSUPP) {
+        reason = "this kernel has no perf events";
+    } else {
+        reason = std::string("perf_event_open failed: ") + strerror(errno);
+    }
+    return false;
+}
+
+// Open the four counters of one thread as a group led by task-clock
+bool PerfCounterCollector::openGroup(int tid, ThreadGroup& group) {
+    group.tid = tid;
+    group.seen = true;
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        group.fds[i] = -1;
+        group.last[i] = 0;
+    }
+
+    for (int i = 0; i < COUNTER_COUNT; i++) {
+        group.fds[i] = perfEventOpen(COUNTER_CONFIGS[i], tid, i == 0 ? -1 : group.fds[0], exclude_kernel);
+        if (group.fds[i] < 0) {
+            // Thread exited or belongs to someone we may not trace
+            closeGroup(group);
+            return false;
+        }
+    }
+
+    group_count++;
+    return true;
+}
+
+void PerfCounterCollector::closeGroup(ThreadGroup& group) {
+    bool was_open = group.fds[0] >= 0 && group.fds[COUNTER_COUNT - 1] >= 0;
+    for (int i = COUNTER_COUNT - 1; i >= 0; i--) {
+        if (group.fds[i] >= 0) {
+            close(group.fds[i]);
+            group.fds[i] = -1;
+        }
+    }
+    if (was_open) {
+        group_count--;
+    }
+}
+
+// Open groups for new threads and close those of threads that exited
+void PerfCounterCollector::refreshThreads(int pid, TrackedProcess& proc) {
+    for (auto& group : proc.threads) {
+        group.seen = false;
+    }
+
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/task", pid);
+    size_t total = 0;
+    DIR* dir = opendir(path);
+    if (dir != nullptr) {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            int tid = atoi(entry->d_name);
+            if (tid <= 0) {
+                continue;
+            }
+            total++;
+
+            bool known = false;
+            for (auto& group : proc.threads) {
+                if (group.tid == tid) {
+                    group.seen = true;
+                    known = true;
+                    break;
+                }
+            }
+
+            ThreadGroup group;
+            if (!known && group_count < MAX_GROUPS && openGroup(tid, group)) {
+                proc.threads.push_back(group);
+            }
+        }
+        closedir(dir);
+    }
+
+    for (size_t i = 0; i < proc.threads.size();) {
+        if (!proc.threads[i].seen) {
+            closeGroup(proc.threads[i]);
+            proc.threads[i] = proc.threads.back();
+            proc.threads.pop_back();
+        } else {
+            i++;
+        }
+    }
+
+    proc.current.threads_total = total;
+    proc.current.threads_counted = proc.threads.size();
+}
+
+void PerfCounterCollector::track(const std::vector<int>& pids) {
+    // Close processes that are no longer wanted
+    for (auto it = tracked.begin(); it != tracked.end();) {
+        bool wanted = false;
+        for (int pid : pids) {
+            if (pid == it->first) {
+                wanted = true;
+                break;
+            }
+        }
+        if (!wanted) {
+            for (auto& group : it->second.threads) {
+                closeGroup(group);
+            }
+            it = tracked.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (!usable) {
+        return;
+    }
+
+    // Start counting new ones right away so the next update covers a full interval
+    for (int pid : pids) {
+        if (tracked.find(pid) == tracked.end()) {
+            refreshThreads(pid, tracked[pid]);
+        }
+    }
+}
+
+void PerfCounterCollector::update() {
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - last_update).count();
+    last_update = now;
+
+    // nr, time_enabled, time_running, one value per counter
+    uint64_t buf[3 + COUNTER_COUNT];
+
+    for (auto& entry : tracked) {
+        TrackedProcess& proc = entry.second;
+        uint64_t delta[COUNTER_COUNT] = {0, 0, 0, 0};
+
+        for (auto& group : proc.threads) {
+            ssize_t n = read(group.fds[0], buf, sizeof(buf));
+            if (n < static_cast<ssize_t>(sizeof(buf)) || buf[0] != COUNTER_COUNT) {
+                continue;
+            }
+
+            // Software counters are never multiplexed, but scale just in case
+            uint64_t enabled = buf[1];
+            uint64_t running = buf[2];
+            for (int i = 0; i < COUNTER_COUNT; i++) {
+                uint64_t value = buf[3 + i];
+                if (running > 0 && running < enabled) {
+                    value = static_cast<uint64_t>(static_cast<double>(value) * enabled / running);
+                }
+                delta[i] += value >= group.last[i] ? value - group.last[i] : 0;
+                group.last[i] = value;
+            }
+        }
+
+        PerfSample& sample = proc.current;
+        sample.valid = elapsed > 0 && !proc.threads.empty();
+        if (sample.valid) {
+            sample.cpu_percent = 100.0 * delta[COUNTER_TASK_CLOCK] / 1e9 / elapsed;
+            sample.context_switches = delta[COUNTER_CONTEXT_SWITCHES] / elapsed;
+            sample.cpu_migrations = delta[COUNTER_CPU_MIGRATIONS] / elapsed;
+            sample.page_faults = delta[COUNTER_PAGE_FAULTS] / elapsed;
+        }
+
+        refreshThreads(entry.first, proc);
+    }
+}
+
+const PerfSample* PerfCounterCollector::sample(int pid) const {
+    auto it = tracked.find(pid);
+    if (it == tracked.end() || !it->second.current.valid) {
+        return nullptr;
+    }
+    return &it->second.current;
+}
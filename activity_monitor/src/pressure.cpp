@@ -0,0 +1,189 @@
+#include "../include/pressure.h"
+#include <algorithm>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+// Smallest divisor of each signal, so an idle system does not magnify noise
+static const float CPU_FLOOR = 5.0f;                   // % of one core
+static const float RSS_GROWTH_FLOOR = 1024.0f;         // KB/s
+static const float IO_FLOOR = 1024.0f * 1024.0f;       // Bytes/s
+static const float FAULTS_FLOOR = 10.0f;               // Per second
+static const float RUN_DELAY_FLOOR = 5.0f;             // % of the interval
+
+bool parsePressureWeights(const std::string& spec, PressureWeights& weights, std::string& error) {
+    std::istringstream iss(spec);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) {
+            error = "expected NAME=WEIGHT, got '" + item + "'";
+            return false;
+        }
+        std::string name = item.substr(0, eq);
+        const char* text = item.c_str() + eq + 1;
+        char* end = nullptr;
+        float value = strtof(text, &end);
+        if (end == text || *end != '\0' || value < 0.0f) {
+            error = "invalid weight in '" + item + "'";
+            return false;
+        }
+
+        if (name == "cpu") {
+            weights.cpu = value;
+        } else if (name == "rss") {
+            weights.rss_growth = value;
+        } else if (name == "io") {
+            weights.io = value;
+        } else if (name == "faults") {
+            weights.faults = value;
+        } else if (name == "runq") {
+            weights.run_delay = value;
+        } else {
+            error = "unknown signal '" + name + "' (cpu, rss, io, faults or runq)";
+            return false;
+        }
+    }
+    if (weights.cpu + weights.rss_growth + weights.io + weights.faults + weights.run_delay <= 0.0f) {
+        error = "all weights are zero";
+        return false;
+    }
+    return true;
+}
+
+// score = sum of scale[k] * column k, over whole blocks; restrict lets the
+// compiler keep each block in vector registers without alias checks
+static void weightedSum(const float* __restrict cpu, const float* __restrict rss_growth,
+                        const float* __restrict io, const float* __restrict faults,
+                        const float* __restrict run_delay, const float scale[5],
+                        float* __restrict score, size_t padded) {
+    const float k_cpu = scale[0];
+    const float k_rss = scale[1];
+    const float k_io = scale[2];
+    const float k_faults = scale[3];
+    const float k_delay = scale[4];
+    for (size_t block = 0; block < padded; block += PressureScorer::BLOCK) {
+        for (size_t j = 0; j < PressureScorer::BLOCK; j++) {
+            score[block + j] = k_cpu * cpu[block + j] + k_rss * rss_growth[block + j] + k_io * io[block + j] +
+                               k_faults * faults[block + j] + k_delay * run_delay[block + j];
+        }
+    }
+}
+
+void PressureScorer::update(std::vector<Process>& processes) {
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = have_previous ? std::chrono::duration<double>(now - last_update).count() : 0.0;
+    static const double ticks_per_second = static_cast<double>(sysconf(_SC_CLK_TCK));
+
+    size_t count = processes.size();
+    size_t padded = (count + BLOCK - 1) / BLOCK * BLOCK;
+    cpu.assign(padded, 0.0f);
+    rss_growth.assign(padded, 0.0f);
+    io.assign(padded, 0.0f);
+    faults.assign(padded, 0.0f);
+    run_delay.assign(padded, 0.0f);
+    score.assign(padded, 0.0f);
+
+    // Gather: rates against the previous refresh, and the column maxima
+    float max_cpu = CPU_FLOOR;
+    float max_rss = RSS_GROWTH_FLOOR;
+    float max_io = IO_FLOOR;
+    float max_faults = FAULTS_FLOOR;
+    float max_delay = RUN_DELAY_FLOOR;
+    current.clear();
+    current.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        const Process& proc = processes[i];
+        Previous values;
+        values.start_time = proc.start_time;
+        values.cpu_ticks = proc.cpu_ticks;
+        values.rss_kb = proc.rss_kb;
+        values.io_bytes = proc.io_read_bytes + proc.io_write_bytes;
+        values.major_faults = proc.major_faults;
+        values.run_delay_ns = proc.run_delay_ns;
+        values.row = i;
+
+        // New processes and reused PIDs have nothing to compare with yet
+        auto it = previous.find(proc.pid);
+        if (elapsed > 0.0 && it != previous.end() && it->second.start_time == proc.start_time) {
+            const Previous& before = it->second;
+            auto rate = [elapsed](unsigned long long value, unsigned long long last) {
+                return value > last ? static_cast<float>((value - last) / elapsed) : 0.0f;
+            };
+            cpu[i] = static_cast<float>(rate(values.cpu_ticks, before.cpu_ticks) * 100.0 / ticks_per_second);
+            rss_growth[i] = rate(values.rss_kb, before.rss_kb);
+            io[i] = rate(values.io_bytes, before.io_bytes);
+            faults[i] = rate(values.major_faults, before.major_faults);
+            run_delay[i] = rate(values.run_delay_ns, before.run_delay_ns) / 1e7f;
+            max_cpu = std::max(max_cpu, cpu[i]);
+            max_rss = std::max(max_rss, rss_growth[i]);
+            max_io = std::max(max_io, io[i]);
+            max_faults = std::max(max_faults, faults[i]);
+            max_delay = std::max(max_delay, run_delay[i]);
+        }
+        current[proc.pid] = values;
+    }
+    previous.swap(current);
+    last_update = now;
+    have_previous = true;
+
+    // Score: one pass over the columns
+    scale[0] = weights.cpu / max_cpu;
+    scale[1] = weights.rss_growth / max_rss;
+    scale[2] = weights.io / max_io;
+    scale[3] = weights.faults / max_faults;
+    scale[4] = weights.run_delay / max_delay;
+    weightedSum(cpu.data(), rss_growth.data(), io.data(), faults.data(), run_delay.data(), scale,
+                score.data(), padded);
+
+    for (size_t i = 0; i < count; i++) {
+        processes[i].pressure = score[i];
+    }
+}
+
+std::string PressureScorer::describe(int pid) const {
+    auto it = previous.find(pid);
+    if (it == previous.end()) {
+        return "not scored yet";
+    }
+    size_t row = it->second.row;
+
+    // Order the signals by their part of the score
+    struct Part {
+        float points;
+        std::string text;
+    };
+    std::vector<Part> parts;
+    char text[64];
+    if (cpu[row] > 0.0f) {
+        snprintf(text, sizeof(text), "CPU %.0f%%", cpu[row]);
+        parts.push_back(Part{scale[0] * cpu[row], text});
+    }
+    if (rss_growth[row] > 0.0f) {
+        snprintf(text, sizeof(text), "RSS +%.1f MB/s", rss_growth[row] / 1024.0f);
+        parts.push_back(Part{scale[1] * rss_growth[row], text});
+    }
+    if (io[row] > 0.0f) {
+        snprintf(text, sizeof(text), "I/O %.1f MB/s", io[row] / (1024.0f * 1024.0f));
+        parts.push_back(Part{scale[2] * io[row], text});
+    }
+    if (faults[row] > 0.0f) {
+        snprintf(text, sizeof(text), "%.0f major faults/s", faults[row]);
+        parts.push_back(Part{scale[3] * faults[row], text});
+    }
+    if (run_delay[row] > 0.0f) {
+        snprintf(text, sizeof(text), "run queue %.0f%%", run_delay[row]);
+        parts.push_back(Part{scale[4] * run_delay[row], text});
+    }
+    if (parts.empty()) {
+        return "idle";
+    }
+    std::sort(parts.begin(), parts.end(), [](const Part& a, const Part& b) { return a.points > b.points; });
+
+    std::string result;
+    for (const Part& part : parts) {
+        result += (result.empty() ? "" : ", ") + part.text;
+    }
+    return result;
+}
@@ -0,0 +1,135 @@
+#include "../include/monitor.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <unistd.h>
+
+// Most matches kept for the view; the search stops once it has these
+static const size_t HISTORY_MATCH_LIMIT = 1000;
+
+// Open the process history search with an empty query, or close it
+void ActivityMonitor::toggleProcessHistory() {
+    if (process_view == VIEW_PROCESS_HISTORY) {
+        setProcessView(VIEW_PROCESSES);
+        return;
+    }
+    setProcessView(VIEW_PROCESS_HISTORY);
+    history_query.clear();
+    history_searched.clear();
+    history_matches.clear();
+    history_searched_records = 0;
+}
+
+// Printable keys edit the query; false for keys left to the global handler
+bool ActivityMonitor::handleProcessHistoryKey(int ch) {
+    switch (ch) {
+        case 27:  // ESC key
+        case '\n':
+        case KEY_ENTER:
+            setProcessView(VIEW_PROCESSES);
+            return true;
+        case KEY_BACKSPACE:
+        case 127:
+        case '\b':
+            if (!history_query.empty()) {
+                history_query.pop_back();
+                view_offset = 0;
+            }
+            return true;
+        default:
+            if (ch >= 32 && ch < 127) {
+                history_query += static_cast<char>(ch);
+                view_offset = 0;
+                return true;
+            }
+            return false;
+    }
+}
+
+static std::string formatClock(int64_t t) {
+    time_t value = static_cast<time_t>(t);
+    struct tm local;
+    localtime_r(&value, &local);
+    char text[32];
+    strftime(text, sizeof(text), "%m-%d %H:%M:%S", &local);
+    return text;
+}
+
+// Draw the newest processes whose command line matches the query
+void ActivityMonitor::displayProcessHistory() {
+    screen->clear(process_win);
+    screen->box(process_win);
+
+    int height = process_win.height;
+    int width = process_win.width;
+    int text_width = std::max(0, width - 4);
+
+    if (!process_log.isOpen()) {
+        screen->attrOn(process_win, COLOR_PAIR(5));
+        screen->print(process_win, 0, 2, "%s", std::string(" Process History (Esc close) ").substr(0, text_width).c_str());
+        screen->attrOff(process_win, COLOR_PAIR(5));
+        screen->print(process_win, 2, 2, "%s",
+                      std::string("Process log is off; start with --process-log=FILE").substr(0, text_width).c_str());
+        screen->refresh(process_win);
+        return;
+    }
+
+    // Search again when the query changes or processes have exited since
+    if (history_query != history_searched || process_log.recordCount() != history_searched_records) {
+        auto start = std::chrono::steady_clock::now();
+        history_matches = history_query.empty() ? std::vector<size_t>()
+                                                : process_log.search(history_query, HISTORY_MATCH_LIMIT);
+        history_search_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        history_searched = history_query;
+        history_searched_records = process_log.recordCount();
+    }
+
+    char title[160];
+    snprintf(title, sizeof(title), " Process History: %d%s of %d processes match (%.2f ms, Esc close) ",
+             static_cast<int>(history_matches.size()), history_matches.size() >= HISTORY_MATCH_LIMIT ? "+" : "",
+             static_cast<int>(process_log.recordCount()), history_search_ms);
+    screen->attrOn(process_win, COLOR_PAIR(5));
+    screen->print(process_win, 0, 2, "%s", std::string(title).substr(0, text_width).c_str());
+    screen->attrOff(process_win, COLOR_PAIR(5));
+
+    std::string prompt = "Search: " + history_query + "_";
+    screen->print(process_win, 1, 2, "%s", prompt.substr(0, text_width).c_str());
+
+    // Appending stopped; what was loaded and seen so far can still be searched
+    if (!process_log.error().empty()) {
+        std::string notice = "Log not written: " + process_log.error();
+        int col = 2 + static_cast<int>(prompt.size()) + 2;
+        if (col < width - 2) {
+            screen->attrOn(process_win, COLOR_PAIR(3));
+            screen->print(process_win, 1, col, "%s", notice.substr(0, width - 2 - col).c_str());
+            screen->attrOff(process_win, COLOR_PAIR(3));
+        }
+    }
+
+    screen->attrOn(process_win, A_BOLD);
+    screen->print(process_win, 2, 2, "%-14s %-15s %7s %9s %10s  %s", "Started", "Exited", "PID", "CPU", "Peak RSS",
+                  "Command");
+    screen->attrOff(process_win, A_BOLD);
+
+    int rows = height - 4;
+    int total = static_cast<int>(history_matches.size());
+    view_offset = std::max(0, std::min(view_offset, total - rows));
+    double ticks = static_cast<double>(sysconf(_SC_CLK_TCK));
+
+    for (int row = 0; row < rows && view_offset + row < total; row++) {
+        size_t index = history_matches[view_offset + row];
+        const ProcessLog::Record& rec = process_log.record(index);
+
+        // Processes that were still running when a session ended are marked
+        bool running = (rec.flags & ProcessLog::FLAG_RUNNING) != 0;
+        char line[96];
+        snprintf(line, sizeof(line), "%-14s %-14s%c %7d %8.1fs %10s  ", formatClock(rec.started_at).c_str(),
+                 formatClock(rec.last_seen).c_str(), running ? '*' : ' ', rec.pid, rec.cpu_ticks / ticks,
+                 formatSize(rec.peak_rss_kb).c_str());
+        std::string text = line + process_log.printableCommandLine(index);
+        screen->print(process_win, row + 3, 2, "%s", text.substr(0, text_width).c_str());
+    }
+
+    screen->refresh(process_win);
+}
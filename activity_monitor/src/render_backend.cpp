@@ -0,0 +1,421 @@
+#include "../include/render_backend.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cerrno>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/uio.h>
+
+// Attributes the ANSI backend knows how to express
+static const attr_t ANSI_ATTR_MASK = A_COLOR | A_BOLD | A_REVERSE | A_UNDERLINE | A_DIM;
+
+// Forces an SGR before the first character of a frame
+static const uint32_t UNKNOWN_ATTR = 0xFFFFFFFFu;
+
+// Map box-drawing code points to the DEC line-drawing set (1 byte instead of 3)
+static char lineDrawingChar(uint32_t ch) {
+    switch (ch) {
+        case 0x2500: return 'q';  // ─
+        case 0x2502: return 'x';  // │
+        case 0x250C: return 'l';  // ┌
+        case 0x2510: return 'k';  // ┐
+        case 0x2514: return 'm';  // └
+        case 0x2518: return 'j';  // ┘
+        default: return 0;
+    }
+}
+
+// Longest text a single print() call can produce
+static const size_t PRINT_BUFFER_SIZE = 1024;
+
+// ---------------------------------------------------------------- ncurses
+
+void CursesRenderer::definePair(short pair, short fg, short bg) {
+    init_pair(pair, fg, bg);
+}
+
+void CursesRenderer::createPanel(Panel& p, int height, int width, int y, int x) {
+    p.win = newwin(height, width, y, x);
+    p.y = y;
+    p.x = x;
+    p.height = height;
+    p.width = width;
+    p.attrs = 0;
+    p.bkgd = 0;
+    p.open = true;
+}
+
+void CursesRenderer::destroyPanel(Panel& p) {
+    if (p.win != nullptr) {
+        delwin(p.win);
+        p.win = nullptr;
+    }
+    p.open = false;
+}
+
+void CursesRenderer::clear(Panel& p) {
+    // werase rather than wclear: wclear forces a full repaint of the window
+    werase(p.win);
+}
+
+void CursesRenderer::box(Panel& p) {
+    ::box(p.win, 0, 0);
+}
+
+void CursesRenderer::background(Panel& p, attr_t attrs) {
+    p.bkgd = attrs;
+    wbkgd(p.win, attrs);
+}
+
+void CursesRenderer::print(Panel& p, int row, int col, const char* fmt, ...) {
+    if (wmove(p.win, row, col) == ERR) {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    vw_printw(p.win, fmt, args);
+    va_end(args);
+}
+
+void CursesRenderer::putChar(Panel& p, int row, int col, char ch) {
+    mvwaddch(p.win, row, col, static_cast<unsigned char>(ch));
+}
+
+void CursesRenderer::refresh(Panel& p) {
+    wnoutrefresh(p.win);
+}
+
+void CursesRenderer::present() {
+    doupdate();
+    frames++;
+}
+
+void CursesRenderer::invalidate() {
+    clearok(curscr, TRUE);
+}
+
+void CursesRenderer::resize(int rows, int cols) {
+    // ncurses tracks the terminal size itself
+    (void)rows;
+    (void)cols;
+}
+
+// ---------------------------------------------------------------- ANSI
+
+AnsiRenderer::AnsiRenderer(int fd) : fd(fd) {
+    for (int i = 0; i < 256; i++) {
+        pair_fg[i] = -1;
+        pair_bg[i] = -1;
+    }
+}
+
+void AnsiRenderer::definePair(short pair, short fg, short bg) {
+    if (pair > 0 && pair < 256) {
+        pair_fg[pair] = fg;
+        pair_bg[pair] = bg;
+    }
+}
+
+void AnsiRenderer::resize(int new_rows, int new_cols) {
+    rows = std::max(new_rows, 0);
+    cols = std::max(new_cols, 0);
+    Cell blank = {' ', 0};
+    frame.assign(static_cast<size_t>(rows) * cols, blank);
+    invalidate();
+
+    // Worst case every cell needs a move, an SGR change and a 4-byte character
+    out.reserve(static_cast<size_t>(rows) * cols * 24 + 64);
+}
+
+void AnsiRenderer::invalidate() {
+    // The next frame starts with a screen clear, after which every cell is a
+    // plain blank and blanks need not be sent
+    Cell blank = {' ', 0};
+    previous.assign(static_cast<size_t>(rows) * cols, blank);
+    clear_pending = true;
+}
+
+void AnsiRenderer::createPanel(Panel& p, int height, int width, int y, int x) {
+    p.win = nullptr;
+    p.y = y;
+    p.x = x;
+    p.height = height;
+    p.width = width;
+    p.attrs = 0;
+    p.bkgd = 0;
+    p.open = true;
+}
+
+void AnsiRenderer::destroyPanel(Panel& p) {
+    p.open = false;
+}
+
+// Combine drawing and background attributes the way ncurses does
+uint32_t AnsiRenderer::effectiveAttr(const Panel& p, attr_t attrs) const {
+    attr_t color = (attrs & A_COLOR) ? (attrs & A_COLOR) : (p.bkgd & A_COLOR);
+    return static_cast<uint32_t>(((attrs | p.bkgd) & ~A_COLOR & ANSI_ATTR_MASK) | color);
+}
+
+void AnsiRenderer::setCell(int row, int col, uint32_t ch, uint32_t attr) {
+    if (row < 0 || col < 0 || row >= rows || col >= cols) {
+        return;
+    }
+    Cell& cell = frame[static_cast<size_t>(row) * cols + col];
+    cell.ch = ch;
+    cell.attr = attr;
+}
+
+void AnsiRenderer::clear(Panel& p) {
+    uint32_t attr = effectiveAttr(p, 0);
+    for (int r = 0; r < p.height; r++) {
+        for (int c = 0; c < p.width; c++) {
+            setCell(p.y + r, p.x + c, ' ', attr);
+        }
+    }
+}
+
+void AnsiRenderer::box(Panel& p) {
+    uint32_t attr = effectiveAttr(p, 0);
+    int bottom = p.height - 1;
+    int right = p.width - 1;
+    for (int c = 1; c < right; c++) {
+        setCell(p.y, p.x + c, 0x2500, attr);           // ─
+        setCell(p.y + bottom, p.x + c, 0x2500, attr);
+    }
+    for (int r = 1; r < bottom; r++) {
+        setCell(p.y + r, p.x, 0x2502, attr);           // │
+        setCell(p.y + r, p.x + right, 0x2502, attr);
+    }
+    setCell(p.y, p.x, 0x250C, attr);                   // ┌
+    setCell(p.y, p.x + right, 0x2510, attr);           // ┐
+    setCell(p.y + bottom, p.x, 0x2514, attr);          // └
+    setCell(p.y + bottom, p.x + right, 0x2518, attr);  // ┘
+}
+
+// Like wbkgd on a freshly cleared panel: repaint it in the background attributes
+void AnsiRenderer::background(Panel& p, attr_t attrs) {
+    p.bkgd = attrs;
+    clear(p);
+}
+
+// Decode UTF-8 text into cells, clipped to the panel
+void AnsiRenderer::putText(Panel& p, int row, int col, const char* text) {
+    if (row < 0 || row >= p.height) {
+        return;
+    }
+
+    uint32_t attr = effectiveAttr(p, p.attrs);
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(text);
+    while (*s != '\0' && col < p.width) {
+        uint32_t ch = *s++;
+        int extra = 0;
+        if (ch >= 0xF0) { ch &= 0x07; extra = 3; }
+        else if (ch >= 0xE0) { ch &= 0x0F; extra = 2; }
+        else if (ch >= 0xC0) { ch &= 0x1F; extra = 1; }
+        for (; extra > 0 && (*s & 0xC0) == 0x80; extra--) {
+            ch = (ch << 6) | (*s++ & 0x3F);
+        }
+
+        if (col >= 0) {
+            setCell(p.y + row, p.x + col, ch, attr);
+        }
+        col++;
+    }
+}
+
+void AnsiRenderer::print(Panel& p, int row, int col, const char* fmt, ...) {
+    char buf[PRINT_BUFFER_SIZE];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    putText(p, row, col, buf);
+}
+
+void AnsiRenderer::putChar(Panel& p, int row, int col, char ch) {
+    char buf[2] = {ch, '\0'};
+    putText(p, row, col, buf);
+}
+
+void AnsiRenderer::refresh(Panel& p) {
+    // Everything goes out together in present()
+    (void)p;
+}
+
+// Select graphic rendition for a cell attribute, resetting first
+void AnsiRenderer::appendSgr(uint32_t attr) {
+    out += "\x1b[0";
+    if (attr & A_BOLD) out += ";1";
+    if (attr & A_DIM) out += ";2";
+    if (attr & A_UNDERLINE) out += ";4";
+    if (attr & A_REVERSE) out += ";7";
+
+    short pair = static_cast<short>(PAIR_NUMBER(attr));
+    if (pair > 0 && pair < 256) {
+        char buf[16];
+        if (pair_fg[pair] >= 0 && pair_fg[pair] < 8) {
+            snprintf(buf, sizeof(buf), ";%d", 30 + pair_fg[pair]);
+            out += buf;
+        }
+        if (pair_bg[pair] >= 0 && pair_bg[pair] < 8) {
+            snprintf(buf, sizeof(buf), ";%d", 40 + pair_bg[pair]);
+            out += buf;
+        }
+    }
+    out += 'm';
+}
+
+// Move the cursor using the shortest sequence we know
+void AnsiRenderer::appendMove(int row, int col, int cur_row, int cur_col) {
+    char buf[32];
+    if (row == cur_row && col > cur_col) {
+        int n = col - cur_col;
+        snprintf(buf, sizeof(buf), n == 1 ? "\x1b[C" : "\x1b[%dC", n);
+    } else if (col == 0 && cur_row >= 0 && row == cur_row + 1) {
+        snprintf(buf, sizeof(buf), "\r\n");
+    } else if (col == 0) {
+        snprintf(buf, sizeof(buf), "\x1b[%dH", row + 1);
+    } else {
+        snprintf(buf, sizeof(buf), "\x1b[%d;%dH", row + 1, col + 1);
+    }
+    out += buf;
+}
+
+void AnsiRenderer::appendChar(uint32_t ch) {
+    char line = lineDrawingChar(ch);
+    if (line != 0) {
+        if (!line_drawing) {
+            out += "\x1b(0";
+            line_drawing = true;
+        }
+        out += line;
+        return;
+    }
+    if (line_drawing) {
+        out += "\x1b(B";
+        line_drawing = false;
+    }
+
+    if (ch < 0x80) {
+        out += static_cast<char>(ch);
+    } else if (ch < 0x800) {
+        out += static_cast<char>(0xC0 | (ch >> 6));
+        out += static_cast<char>(0x80 | (ch & 0x3F));
+    } else if (ch < 0x10000) {
+        out += static_cast<char>(0xE0 | (ch >> 12));
+        out += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (ch & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (ch >> 18));
+        out += static_cast<char>(0x80 | ((ch >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (ch & 0x3F));
+    }
+}
+
+// Diff the composed frame against the terminal contents and send the changes
+void AnsiRenderer::present() {
+    out.clear();
+
+    int cur_row = -1, cur_col = -1;
+    uint32_t cur_attr = UNKNOWN_ATTR;
+
+    if (clear_pending) {
+        out += "\x1b[0m\x1b[2J";
+        cur_attr = 0;
+        clear_pending = false;
+    }
+
+    for (int r = 0; r < rows; r++) {
+        const Cell* row_cells = &frame[static_cast<size_t>(r) * cols];
+        const Cell* row_prev = &previous[static_cast<size_t>(r) * cols];
+
+        for (int c = 0; c < cols; c++) {
+            const Cell& cell = row_cells[c];
+            if (cell == row_prev[c]) {
+                continue;
+            }
+
+            if (r != cur_row || c != cur_col) {
+                // Rewriting a short run of unchanged plain cells is cheaper than a cursor move
+                bool rewrite = (r == cur_row && c > cur_col && c - cur_col <= 3);
+                for (int k = cur_col; rewrite && k < c; k++) {
+                    rewrite = row_cells[k].attr == cur_attr && row_cells[k].ch < 0x80;
+                }
+                if (rewrite) {
+                    for (int k = cur_col; k < c; k++) {
+                        appendChar(row_cells[k].ch);
+                    }
+                } else {
+                    appendMove(r, c, cur_row, cur_col);
+                }
+            }
+
+            if (cell.attr != cur_attr) {
+                appendSgr(cell.attr);
+                cur_attr = cell.attr;
+            }
+            appendChar(cell.ch);
+
+            cur_row = r;
+            cur_col = c + 1;
+            // Writing the last column leaves the cursor in a pending-wrap state
+            if (cur_col >= cols) {
+                cur_row = -1;
+            }
+        }
+    }
+
+    if (line_drawing) {
+        out += "\x1b(B";
+        line_drawing = false;
+    }
+
+    previous = frame;
+    frames++;
+
+    if (!out.empty()) {
+        writeFrame();
+    }
+}
+
+// Send the frame in one writev, wrapped in synchronized-update markers
+// (terminals that do not know them ignore them)
+void AnsiRenderer::writeFrame() {
+    static const char begin[] = "\x1b[?2026h\x1b[?25l";
+    static const char end[] = "\x1b[0m\x1b[?2026l";
+
+    struct iovec iov[3];
+    iov[0].iov_base = const_cast<char*>(begin);
+    iov[0].iov_len = sizeof(begin) - 1;
+    iov[1].iov_base = &out[0];
+    iov[1].iov_len = out.size();
+    iov[2].iov_base = const_cast<char*>(end);
+    iov[2].iov_len = sizeof(end) - 1;
+
+    struct iovec* vec = iov;
+    int count = 3;
+    while (count > 0) {
+        ssize_t n = writev(fd, vec, count);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // Terminal gone; the render controller notices via TIOCOUTQ
+            invalidate();
+            return;
+        }
+        bytes += static_cast<unsigned long long>(n);
+
+        // Partial write: skip what was sent and retry the rest
+        while (count > 0 && static_cast<size_t>(n) >= vec->iov_len) {
+            n -= vec->iov_len;
+            vec++;
+            count--;
+        }
+        if (count > 0) {
+            vec->iov_base = static_cast<char*>(vec->iov_base) + n;
+            vec->iov_len -= n;
+        }
+    }
+}
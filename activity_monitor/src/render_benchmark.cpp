@@ -0,0 +1,122 @@
+#include "../include/monitor.h"
+#include "../include/thread_cpu.h"
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+#include <thread>
+#include <algorithm>
+
+// Screen size used for both backends
+static const int BENCH_ROWS = 50;
+static const int BENCH_COLS = 160;
+
+// Frames between data changes, matching the default 1000 ms refresh at 20 fps
+static const int FRAMES_PER_SNAPSHOT = 20;
+
+// Bytes a backend has written to its sink so far
+static unsigned long long sinkBytes(FILE* sink) {
+    fflush(sink);
+    off_t pos = lseek(fileno(sink), 0, SEEK_CUR);
+    return pos > 0 ? static_cast<unsigned long long>(pos) : 0;
+}
+
+// Render the same recorded snapshots through each backend into a sink and
+// report output bytes and CPU time per frame
+void ActivityMonitor::runRenderBenchmark(int frames) {
+    // Record the snapshots up front so both backends draw identical frames
+    config.system_notifications = false;
+    int snapshots = frames / FRAMES_PER_SNAPSHOT + 1;
+    history.setCapacity(std::max(snapshots, config.history_size));
+    for (int i = 0; i < snapshots; i++) {
+        collectData();
+        if (i + 1 < snapshots) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+    uint64_t first_seq = history.oldestSeq();
+
+    terminal_height = BENCH_ROWS;
+    terminal_width = BENCH_COLS;
+    setenv("LINES", std::to_string(BENCH_ROWS).c_str(), 1);
+    setenv("COLUMNS", std::to_string(BENCH_COLS).c_str(), 1);
+
+    const char* term = getenv("TERM");
+    if (term == nullptr || *term == '\0' || std::string(term) == "dumb") {
+        term = "xterm-256color";
+    }
+
+    std::cout << "Render benchmark: " << frames << " frames at " << BENCH_COLS << "x" << BENCH_ROWS
+              << ", data changes every " << FRAMES_PER_SNAPSHOT << " frames\n\n"
+              << std::left << std::setw(10) << "Backend"
+              << std::right << std::setw(14) << "first frame B" << std::setw(14) << "bytes/frame"
+              << std::setw(16) << "CPU us/frame" << "\n";
+
+    const char* backends[] = {"ncurses", "ansi"};
+    for (const char* backend : backends) {
+        // ncurses still needs a SCREEN for both: it owns input and colors in the
+        // real UI. Each backend writes into a temporary file we measure.
+        FILE* out = tmpfile();
+        FILE* in = fopen("/dev/null", "r");
+        SCREEN* bench_screen = (out && in) ? newterm(term, out, in) : nullptr;
+        if (bench_screen == nullptr) {
+            std::cerr << "Error: cannot initialize terminal '" << term << "' for benchmark" << std::endl;
+            if (out) fclose(out);
+            if (in) fclose(in);
+            return;
+        }
+        set_term(bench_screen);
+        start_color();
+
+        unsigned long long setup_bytes = sinkBytes(out);
+        if (std::string(backend) == "ansi") {
+            screen.reset(new AnsiRenderer(fileno(out)));
+        } else {
+            screen.reset(new CursesRenderer());
+        }
+        setupColors();
+        initializeWindows();
+
+        unsigned long long first_frame_bytes = 0;
+        double cpu_us = 0.0;
+        for (int i = 0; i < frames; i++) {
+            if (i % FRAMES_PER_SNAPSHOT == 0) {
+                paused = true;
+                loadHistoryView(first_seq + i / FRAMES_PER_SNAPSHOT);
+            }
+            double start = threadCpuSeconds();
+
+            displayCPUInfo();
+            displayMemoryInfo();
+            displayDiskInfo();
+            displayProcessInfo();
+            displayAlert();
+            screen->present();
+            fflush(out);
+
+            cpu_us += (threadCpuSeconds() - start) * 1e6;
+            if (i == 0) {
+                first_frame_bytes = sinkBytes(out) - setup_bytes;
+            }
+        }
+
+        unsigned long long total_bytes = sinkBytes(out) - setup_bytes;
+        std::cout << std::left << std::setw(10) << backend << std::right
+                  << std::setw(14) << first_frame_bytes
+                  << std::setw(14) << std::fixed << std::setprecision(1)
+                  << static_cast<double>(total_bytes - first_frame_bytes) / std::max(frames - 1, 1)
+                  << std::setw(16) << cpu_us / frames << "\n";
+
+        destroyWindows();
+        screen.reset();
+        endwin();
+        delscreen(bench_screen);
+        fclose(out);
+        fclose(in);
+    }
+
+    paused = false;
+    std::cout << std::endl;
+}
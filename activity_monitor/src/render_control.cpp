@@ -0,0 +1,257 @@
+#include "../include/monitor.h"
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <cstdio>
+#include <cerrno>
+#include <cstdlib>
+#include <algorithm>
+
+// Frame interval bounds: 20 fps when the link keeps up, down to one frame every 2 s
+static const int MIN_FRAME_INTERVAL_MS = 50;
+static const int MAX_FRAME_INTERVAL_MS = 2000;
+
+// A frame whose writes block longer than this means the tty is not draining
+static const long SLOW_FRAME_US = 20000;
+
+// How often to ask tmux whether anyone is attached, and how long to wait for the answer
+static const int TMUX_CHECK_INTERVAL_S = 5;
+static const int TMUX_CHECK_TIMEOUT_MS = 2000;
+
+// Set from signal handlers, consumed by updateRenderState()
+static volatile sig_atomic_t tstp_pending = 0;
+static volatile sig_atomic_t cont_pending = 0;
+static volatile sig_atomic_t hangup_pending = 0;
+
+static void handleTstp(int) { tstp_pending = 1; }
+static void handleCont(int) { cont_pending = 1; }
+static void handleHangup(int) { hangup_pending = 1; }
+
+// Replace ncurses' SIGTSTP handling so we control what happens on suspend
+void ActivityMonitor::installTerminalSignalHandlers() {
+    struct sigaction sa;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+
+    sa.sa_handler = handleTstp;
+    sigaction(SIGTSTP, &sa, nullptr);
+    sa.sa_handler = handleCont;
+    sigaction(SIGCONT, &sa, nullptr);
+    sa.sa_handler = handleHangup;
+    sigaction(SIGHUP, &sa, nullptr);
+
+    // Never get stopped for touching the tty from the background
+    signal(SIGTTOU, SIG_IGN);
+}
+
+// True if we are the foreground job of our controlling terminal
+static bool isForeground() {
+    pid_t fg = tcgetpgrp(STDOUT_FILENO);
+    return fg != -1 && fg == getpgrp();
+}
+
+// Ask tmux whether the session owning our pane has any client attached. The
+// answer is collected by pollTmuxCheck(), so the loop never waits for tmux.
+void ActivityMonitor::startTmuxCheck() {
+    const char* pane = getenv("TMUX_PANE");
+    if (getenv("TMUX") == nullptr || pane == nullptr || tmux_check_pid >= 0) {
+        return;
+    }
+
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+        return;
+    }
+    // Built before fork(): the child of a threaded process may only exec
+    char* const argv[] = {const_cast<char*>("tmux"), const_cast<char*>("display-message"), const_cast<char*>("-p"),
+                          const_cast<char*>("-t"), const_cast<char*>(pane), const_cast<char*>("#{session_attached}"),
+                          nullptr};
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(fds[1], STDOUT_FILENO);
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDERR_FILENO);
+        }
+        execvp("tmux", argv);
+        _exit(127);
+    }
+    close(fds[1]);
+    if (pid < 0) {
+        close(fds[0]);
+        return;
+    }
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    tmux_check_pid = pid;
+    tmux_check_fd = fds[0];
+    tmux_check_started = std::chrono::high_resolution_clock::now();
+}
+
+// True once the running check has answered; tmux_detached then holds the answer.
+// A check that fails or takes too long leaves the previous state.
+bool ActivityMonitor::pollTmuxCheck() {
+    if (tmux_check_pid < 0) {
+        return false;
+    }
+
+    int status = 0;
+    pid_t done = waitpid(tmux_check_pid, &status, WNOHANG);
+    if (done == 0) {
+        auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - tmux_check_started).count();
+        if (waited >= TMUX_CHECK_TIMEOUT_MS) {
+            debugLog("tmux did not answer within " + std::to_string(TMUX_CHECK_TIMEOUT_MS) + " ms");
+            cancelTmuxCheck();
+        }
+        return false;
+    }
+
+    // The answer is a few bytes, so it is all in the pipe once tmux has exited
+    char buf[16] = {0};
+    ssize_t len = done > 0 ? read(tmux_check_fd, buf, sizeof(buf) - 1) : -1;
+    bool answered = done > 0 && WIFEXITED(status) && WEXITSTATUS(status) == 0 && len > 0;
+    if (answered) {
+        tmux_detached = atoi(buf) == 0;
+    }
+    close(tmux_check_fd);
+    tmux_check_fd = -1;
+    tmux_check_pid = -1;
+    return answered;
+}
+
+void ActivityMonitor::cancelTmuxCheck() {
+    if (tmux_check_pid < 0) {
+        return;
+    }
+    kill(tmux_check_pid, SIGKILL);
+    waitpid(tmux_check_pid, nullptr, 0);
+    close(tmux_check_fd);
+    tmux_check_fd = -1;
+    tmux_check_pid = -1;
+}
+
+// Decide whether we may draw and read input this iteration
+bool ActivityMonitor::updateRenderState() {
+    if (hangup_pending) {
+        hangup_pending = 0;
+        if (!terminal_lost) {
+            terminal_lost = true;
+            debugLog("Terminal hung up; rendering stopped, collection continues");
+        }
+    }
+    if (terminal_lost) {
+        return false;
+    }
+
+    if (tstp_pending) {
+        tstp_pending = 0;
+
+        // Restore the terminal and really stop; after 'bg' we keep collecting
+        endwin();
+        signal(SIGTSTP, SIG_DFL);
+        raise(SIGTSTP);
+
+        // Continued: put our handler back and re-check below
+        installTerminalSignalHandlers();
+        render_suspended = true;
+        cont_pending = 1;
+    }
+
+    auto now = std::chrono::high_resolution_clock::now();
+    bool tmux_answered = pollTmuxCheck();
+    bool periodic = std::chrono::duration_cast<std::chrono::seconds>(now - last_tmux_check).count() >=
+                    TMUX_CHECK_INTERVAL_S;
+    if (periodic) {
+        last_tmux_check = now;
+    }
+
+    if (cont_pending || render_suspended || periodic || tmux_answered) {
+        cont_pending = 0;
+
+        // tmux answers on a later iteration; until then the last answer holds
+        bool reachable = isatty(STDOUT_FILENO) && isForeground();
+        if (reachable && periodic) {
+            startTmuxCheck();
+        }
+        reachable = reachable && !tmux_detached;
+
+        if (reachable && render_suspended) {
+            // Back in front of someone: redraw everything from scratch
+            render_suspended = false;
+            reset_prog_mode();
+            terminal_height = 0;
+            terminal_width = 0;
+            clearok(curscr, TRUE);
+            refresh();
+            screen->invalidate();
+            frame_interval_ms = MIN_FRAME_INTERVAL_MS;
+            debugLog("Rendering resumed");
+        } else if (!reachable && !render_suspended) {
+            render_suspended = true;
+            debugLog("Terminal not visible; rendering suspended, collection continues");
+        }
+    }
+
+    return !render_suspended;
+}
+
+// True when the throttled frame interval (and the CPU budget's) has elapsed
+// and the tty has drained the previous frame
+bool ActivityMonitor::frameDue() {
+    auto now = std::chrono::high_resolution_clock::now();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_frame);
+    if (elapsed.count() < std::max(frame_interval_ms, overhead.settings().frame_ms)) {
+        return false;
+    }
+
+    // Bytes still waiting to be sent by the tty (network for ssh, pty for tmux)
+    int queued = 0;
+    if (ioctl(STDOUT_FILENO, TIOCOUTQ, &queued) != 0) {
+        if (errno == EIO) {
+            terminal_lost = true;
+            debugLog("Terminal unreachable; rendering stopped, collection continues");
+            return false;
+        }
+        queued = 0;
+    }
+    tty_queued_bytes = queued;
+
+    // The previous frame is still in flight: skip this one rather than pile up
+    if (queued > 0) {
+        adjustFrameInterval(true, 0);
+        last_frame = now;
+        return false;
+    }
+
+    return true;
+}
+
+// Measure how long a frame's writes took and adapt the frame rate
+void ActivityMonitor::recordFrame(std::chrono::time_point<std::chrono::high_resolution_clock> frame_start) {
+    auto now = std::chrono::high_resolution_clock::now();
+    long frame_us = std::chrono::duration_cast<std::chrono::microseconds>(now - frame_start).count();
+    last_frame = now;
+
+    // Writes block once the tty buffer is full, so a slow frame means a slow link
+    adjustFrameInterval(frame_us > SLOW_FRAME_US, frame_us);
+    Tracer::counter("frame interval ms", frame_interval_ms);
+    Tracer::counter("tty queued bytes", tty_queued_bytes);
+}
+
+// Back off multiplicatively while output piles up, recover additively
+void ActivityMonitor::adjustFrameInterval(bool congested, long frame_us) {
+    int old_interval = frame_interval_ms;
+    if (congested) {
+        frame_interval_ms = std::min(MAX_FRAME_INTERVAL_MS, frame_interval_ms * 2);
+    } else {
+        frame_interval_ms = std::max(MIN_FRAME_INTERVAL_MS, frame_interval_ms - 25);
+    }
+
+    if (config.debug_mode && frame_interval_ms != old_interval) {
+        debugLog("Frame interval " + std::to_string(old_interval) + " -> " + std::to_string(frame_interval_ms) +
+                 " ms (frame " + std::to_string(frame_us) + " us, tty queue " + std::to_string(tty_queued_bytes) + " bytes)");
+    }
+}
@@ -0,0 +1,116 @@
+#include "../include/snapshot_diff.h"
+#include <algorithm>
+#include <cmath>
+
+// Keep the 'top_n' largest entries of 'all' by 'key', largest first
+template <typename Key>
+static std::vector<ProcessDelta> topMovers(std::vector<ProcessDelta>& all, size_t top_n, Key key) {
+    size_t n = std::min(top_n, all.size());
+    std::partial_sort(all.begin(), all.begin() + n, all.end(),
+        [&key](const ProcessDelta& a, const ProcessDelta& b) {
+            return key(a) > key(b);
+        });
+
+    std::vector<ProcessDelta> result(all.begin(), all.begin() + n);
+    // Drop entries that did not actually move
+    while (!result.empty() && key(result.back()) <= 0) {
+        result.pop_back();
+    }
+    return result;
+}
+
+SnapshotDiff diffSnapshots(const Snapshot& before, const Snapshot& after, size_t top_n) {
+    SnapshotDiff diff;
+    diff.from_time = before.taken_at;
+    diff.to_time = after.taken_at;
+    diff.total_cpu_delta = after.cpu.total_usage - before.cpu.total_usage;
+    diff.mem_used_delta_kb = static_cast<long long>(after.memory.used) - static_cast<long long>(before.memory.used);
+    diff.swap_used_delta_kb = static_cast<long long>(after.memory.swap_used) - static_cast<long long>(before.memory.swap_used);
+
+    // Merge-join the PID-sorted process tables
+    std::vector<ProcessDelta> matched;
+    matched.reserve(std::min(before.processes.size(), after.processes.size()));
+
+    size_t i = 0, j = 0;
+    while (i < before.processes.size() || j < after.processes.size()) {
+        if (j == after.processes.size() ||
+            (i < before.processes.size() && before.processes[i].pid < after.processes[j].pid)) {
+            diff.exited.push_back(before.processes[i++]);
+        } else if (i == before.processes.size() || after.processes[j].pid < before.processes[i].pid) {
+            diff.started.push_back(after.processes[j++]);
+        } else {
+            const Process& a = before.processes[i++];
+            const Process& b = after.processes[j++];
+
+            // Same PID, different start time: the PID was reused
+            if (a.start_time != b.start_time) {
+                diff.exited.push_back(a);
+                diff.started.push_back(b);
+                continue;
+            }
+
+            ProcessDelta delta;
+            delta.pid = b.pid;
+            delta.name = b.name;
+            delta.cpu_before = a.cpu_percent;
+            delta.cpu_after = b.cpu_percent;
+            delta.rss_delta_kb = static_cast<long>(b.rss_kb) - static_cast<long>(a.rss_kb);
+
+            unsigned long long io_before = a.io_read_bytes + a.io_write_bytes;
+            unsigned long long io_after = b.io_read_bytes + b.io_write_bytes;
+            delta.io_delta_bytes = (io_after > io_before) ? static_cast<long long>(io_after - io_before) : 0;
+
+            matched.push_back(delta);
+        }
+    }
+
+    diff.cpu_movers = topMovers(matched, top_n, [](const ProcessDelta& d) {
+        return std::fabs(d.cpu_after - d.cpu_before);
+    });
+    diff.rss_movers = topMovers(matched, top_n, [](const ProcessDelta& d) {
+        return std::labs(d.rss_delta_kb);
+    });
+    diff.io_movers = topMovers(matched, top_n, [](const ProcessDelta& d) {
+        return d.io_delta_bytes;
+    });
+
+    // Per-core changes (core count only differs across CPU hotplug)
+    size_t cores = std::min(before.cpu.core_usage.size(), after.cpu.core_usage.size());
+    diff.core_deltas.resize(cores);
+    for (size_t c = 0; c < cores; c++) {
+        diff.core_deltas[c] = after.cpu.core_usage[c] - before.cpu.core_usage[c];
+    }
+
+    // Merge-join the mounts by mount point
+    std::vector<const DiskInfo*> disks_before, disks_after;
+    for (const auto& disk : before.disks) disks_before.push_back(&disk);
+    for (const auto& disk : after.disks) disks_after.push_back(&disk);
+    auto by_mount = [](const DiskInfo* a, const DiskInfo* b) { return a->mount_point < b->mount_point; };
+    std::sort(disks_before.begin(), disks_before.end(), by_mount);
+    std::sort(disks_after.begin(), disks_after.end(), by_mount);
+
+    i = 0;
+    j = 0;
+    while (i < disks_before.size() || j < disks_after.size()) {
+        if (j == disks_after.size() ||
+            (i < disks_before.size() && by_mount(disks_before[i], disks_after[j]))) {
+            diff.mounts_removed.push_back(disks_before[i++]->mount_point);
+        } else if (i == disks_before.size() || by_mount(disks_after[j], disks_before[i])) {
+            diff.mounts_added.push_back(disks_after[j++]->mount_point);
+        } else {
+            const DiskInfo* a = disks_before[i++];
+            const DiskInfo* b = disks_after[j++];
+
+            DiskDelta delta;
+            delta.mount_point = b->mount_point;
+            delta.percent_before = a->percent_used;
+            delta.percent_after = b->percent_used;
+            delta.io_ops_delta = static_cast<long long>(b->io_operations) - static_cast<long long>(a->io_operations);
+            delta.latency_before_ms = a->read_latency_ms;
+            delta.latency_after_ms = b->read_latency_ms;
+            diff.disk_changes.push_back(delta);
+        }
+    }
+
+    return diff;
+}
@@ -0,0 +1,385 @@
+#include "../include/stress.h"
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+
+// Duty-cycle period of the CPU workers
+static const long CPU_PERIOD_NS = 100 * 1000000L;
+
+// I/O workers move data in chunks of this size
+static const size_t IO_CHUNK = 64 * 1024;
+
+// Bytes written before the writer starts over at offset 0, and size of the reader's file
+static const off_t WRITE_WRAP_BYTES = 256L * 1024 * 1024;
+static const off_t READ_FILE_BYTES = 64L * 1024 * 1024;
+
+static const double MB = 1024.0 * 1024.0;
+
+static int64_t nowNs(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+// Sleep until 'start' + 'offset_ns' on the monotonic clock, so rates do not drift
+static void sleepUntil(int64_t start, int64_t offset_ns) {
+    int64_t deadline = start + offset_ns;
+    struct timespec ts;
+    ts.tv_sec = deadline / 1000000000LL;
+    ts.tv_nsec = deadline % 1000000000LL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
+
+StressGenerator::~StressGenerator() {
+    stop();
+    if (counters != nullptr) {
+        munmap(counters, MAX_LOADS * sizeof(std::atomic<uint64_t>));
+    }
+}
+
+// "A" or "A-B"
+static bool parseCores(const std::string& text, int& first, int& last) {
+    char* end = nullptr;
+    first = static_cast<int>(strtol(text.c_str(), &end, 10));
+    if (end == text.c_str()) {
+        return false;
+    }
+    last = first;
+    if (*end == '-') {
+        const char* rest = end + 1;
+        last = static_cast<int>(strtol(rest, &end, 10));
+        if (end == rest) {
+            return false;
+        }
+    }
+    return *end == '\0' && first >= 0 && last >= first;
+}
+
+bool StressGenerator::parse(const std::string& spec, std::vector<StressLoad>& loads, std::string& error) {
+    long cores = sysconf(_SC_NPROCESSORS_CONF);
+    std::stringstream items(spec);
+    std::string item;
+
+    while (std::getline(items, item, ',')) {
+        size_t equals = item.find('=');
+        if (equals == std::string::npos) {
+            error = "expected KIND=VALUE in '" + item + "'";
+            return false;
+        }
+        std::string kind = item.substr(0, equals);
+        std::string value = item.substr(equals + 1);
+        std::string option;
+        size_t at = value.find('@');
+        if (at != std::string::npos) {
+            option = value.substr(at + 1);
+            value = value.substr(0, at);
+        }
+
+        char* end = nullptr;
+        double amount = strtod(value.c_str(), &end);
+        if (end == value.c_str() || *end != '\0' || !(amount > 0)) {
+            error = "'" + item + "' needs a positive number";
+            return false;
+        }
+
+        StressLoad load;
+        load.amount = amount;
+        if (kind == "cpu") {
+            int first = 0;
+            int last = 0;
+            if (amount > 100.0) {
+                error = "CPU load is a percentage of one core (1-100)";
+                return false;
+            }
+            if (!option.empty() && !parseCores(option, first, last)) {
+                error = "bad core list '" + option + "' (use N or N-M)";
+                return false;
+            }
+            if (last >= cores) {
+                error = "core " + std::to_string(last) + " does not exist";
+                return false;
+            }
+            load.type = STRESS_CPU;
+            for (int core = first; core <= last; core++) {
+                load.core = core;
+                loads.push_back(load);
+            }
+            continue;
+        } else if (kind == "mem") {
+            load.type = STRESS_MEMORY;
+            load.rate = 64.0;
+            if (!option.empty()) {
+                load.rate = strtod(option.c_str(), &end);
+                if (end == option.c_str() || *end != '\0' || !(load.rate > 0)) {
+                    error = "bad allocation rate '" + option + "' (MB/s)";
+                    return false;
+                }
+            }
+        } else if (kind == "fork") {
+            load.type = STRESS_FORK;
+        } else if (kind == "write") {
+            load.type = STRESS_WRITE;
+        } else if (kind == "read") {
+            load.type = STRESS_READ;
+        } else {
+            error = "unknown load '" + kind + "' (cpu, mem, fork, write, read)";
+            return false;
+        }
+        if (!option.empty() && load.type != STRESS_MEMORY) {
+            error = "'" + kind + "' takes no @ option";
+            return false;
+        }
+        loads.push_back(load);
+    }
+
+    if (loads.empty()) {
+        error = "no loads given";
+        return false;
+    }
+    if (loads.size() > MAX_LOADS) {
+        error = "at most " + std::to_string(MAX_LOADS) + " loads";
+        return false;
+    }
+    return true;
+}
+
+std::string StressGenerator::describe(const StressLoad& load) {
+    char text[64];
+    switch (load.type) {
+        case STRESS_CPU:
+            snprintf(text, sizeof(text), "cpu %.0f%% on core %d", load.amount, load.core);
+            break;
+        case STRESS_MEMORY:
+            snprintf(text, sizeof(text), "mem %.0f MB at %.0f MB/s", load.amount, load.rate);
+            break;
+        case STRESS_FORK:
+            snprintf(text, sizeof(text), "fork %.0f/s", load.amount);
+            break;
+        case STRESS_WRITE:
+            snprintf(text, sizeof(text), "write %.1f MB/s", load.amount);
+            break;
+        case STRESS_READ:
+            snprintf(text, sizeof(text), "read %.1f MB/s", load.amount);
+            break;
+    }
+    return text;
+}
+
+void StressGenerator::start(const std::vector<StressLoad>& loads, int duration_seconds) {
+    stop();
+
+    if (counters == nullptr) {
+        void* shared = mmap(nullptr, MAX_LOADS * sizeof(std::atomic<uint64_t>), PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (shared == MAP_FAILED) {
+            throw std::runtime_error("Failed to map stress counters");
+        }
+        counters = static_cast<std::atomic<uint64_t>*>(shared);
+    }
+    for (size_t i = 0; i < MAX_LOADS; i++) {
+        new (&counters[i]) std::atomic<uint64_t>(0);
+    }
+
+    workers = loads;
+    duration = duration_seconds;
+    started = std::chrono::steady_clock::now();
+    running = true;
+
+    for (size_t i = 0; i < workers.size(); i++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            stop();
+            throw std::runtime_error(std::string("Failed to fork stress worker: ") + strerror(errno));
+        }
+        if (pid == 0) {
+            runWorker(workers[i], &counters[i]);
+            _exit(0);
+        }
+        workers[i].pid = pid;
+    }
+}
+
+void StressGenerator::stop() {
+    if (!running) {
+        return;
+    }
+    for (auto& load : workers) {
+        if (load.pid > 0) {
+            kill(load.pid, SIGKILL);
+            waitpid(load.pid, nullptr, 0);
+            load.pid = -1;
+        }
+    }
+    stopped = std::chrono::steady_clock::now();
+    running = false;
+}
+
+bool StressGenerator::checkDuration() {
+    if (running && duration > 0 && elapsedSeconds() >= duration) {
+        stop();
+    }
+    return running;
+}
+
+uint64_t StressGenerator::progress(size_t i) const {
+    return counters != nullptr && i < workers.size() ? counters[i].load() : 0;
+}
+
+double StressGenerator::elapsedSeconds() const {
+    auto end = running ? std::chrono::steady_clock::now() : stopped;
+    return std::chrono::duration<double>(end - started).count();
+}
+
+// In the forked child: name the process, die with the monitor, run the load
+void StressGenerator::runWorker(const StressLoad& load, std::atomic<uint64_t>* counter) {
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    signal(SIGINT, SIG_IGN);
+    signal(SIGWINCH, SIG_IGN);
+
+    static const char* NAMES[] = {"stress-cpu", "stress-mem", "stress-fork", "stress-write", "stress-read"};
+    prctl(PR_SET_NAME, NAMES[load.type]);
+
+    switch (load.type) {
+        case STRESS_CPU:
+            cpuWorker(load, counter);
+            break;
+        case STRESS_MEMORY:
+            memoryWorker(load, counter);
+            break;
+        case STRESS_FORK:
+            forkWorker(load, counter);
+            break;
+        case STRESS_WRITE:
+        case STRESS_READ:
+            ioWorker(load, counter);
+            break;
+    }
+}
+
+// Spin for 'amount' percent of each period, sleep for the rest; publishes CPU ns used
+void StressGenerator::cpuWorker(const StressLoad& load, std::atomic<uint64_t>* counter) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(load.core, &set);
+    sched_setaffinity(0, sizeof(set), &set);
+
+    int64_t busy_ns = static_cast<int64_t>(CPU_PERIOD_NS * load.amount / 100.0);
+    int64_t start = nowNs(CLOCK_MONOTONIC);
+    int64_t cpu_start = nowNs(CLOCK_PROCESS_CPUTIME_ID);
+    for (int64_t period = 0;; period++) {
+        int64_t period_start = start + period * CPU_PERIOD_NS;
+        while (nowNs(CLOCK_MONOTONIC) - period_start < busy_ns) {
+        }
+        *counter = static_cast<uint64_t>(nowNs(CLOCK_PROCESS_CPUTIME_ID) - cpu_start);
+        sleepUntil(start, (period + 1) * CPU_PERIOD_NS);
+    }
+}
+
+// Touch 'amount' MB at 'rate' MB/s, then hold it; publishes bytes touched
+void StressGenerator::memoryWorker(const StressLoad& load, std::atomic<uint64_t>* counter) {
+    size_t total = static_cast<size_t>(load.amount * MB);
+    char* memory = static_cast<char*>(mmap(nullptr, total, PROT_READ | PROT_WRITE,
+                                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (memory == MAP_FAILED) {
+        return;
+    }
+
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t touched = 0;
+    int64_t start = nowNs(CLOCK_MONOTONIC);
+    for (int64_t tick = 1; touched < total; tick++) {
+        // 10 ms steps
+        sleepUntil(start, tick * 10000000LL);
+        size_t target = std::min(total, static_cast<size_t>(load.rate * MB * tick / 100.0));
+        for (; touched < target; touched += page) {
+            memory[touched] = 1;
+        }
+        *counter = std::min(touched, total);
+    }
+
+    while (true) {
+        pause();
+    }
+}
+
+// Fork children that exit at once, at an exact rate; publishes forks done
+void StressGenerator::forkWorker(const StressLoad& load, std::atomic<uint64_t>* counter) {
+    double interval_ns = 1e9 / load.amount;
+    int64_t start = nowNs(CLOCK_MONOTONIC);
+    for (uint64_t done = 0;; done++) {
+        sleepUntil(start, static_cast<int64_t>(done * interval_ns));
+        pid_t child = fork();
+        if (child == 0) {
+            _exit(0);
+        }
+        if (child > 0) {
+            waitpid(child, nullptr, 0);
+            *counter = done + 1;
+        }
+    }
+}
+
+// Write (with fdatasync) or read (uncached) a scratch file at 'amount' MB/s; publishes bytes moved
+void StressGenerator::ioWorker(const StressLoad& load, std::atomic<uint64_t>* counter) {
+    const char* tmp = getenv("TMPDIR");
+    std::string path = std::string(tmp != nullptr && *tmp != '\0' ? tmp : "/tmp") +
+                       "/activity_monitor_stress_" + std::to_string(getpid());
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return;
+    }
+    // Nothing to clean up if we are killed
+    unlink(path.c_str());
+
+    std::vector<char> chunk(IO_CHUNK, 'x');
+    if (load.type == STRESS_READ) {
+        // Real data, so that reads go to the device
+        for (off_t offset = 0; offset < READ_FILE_BYTES; offset += IO_CHUNK) {
+            if (pwrite(fd, chunk.data(), IO_CHUNK, offset) != static_cast<ssize_t>(IO_CHUNK)) {
+                return;
+            }
+        }
+        fdatasync(fd);
+    }
+
+    double chunk_ns = 1e9 * IO_CHUNK / (load.amount * MB);
+    off_t wrap = load.type == STRESS_READ ? READ_FILE_BYTES : WRITE_WRAP_BYTES;
+    int64_t start = nowNs(CLOCK_MONOTONIC);
+    for (uint64_t done = 0;; done++) {
+        sleepUntil(start, static_cast<int64_t>(done * chunk_ns));
+        off_t offset = static_cast<off_t>((done * IO_CHUNK) % wrap);
+
+        ssize_t n;
+        if (load.type == STRESS_READ) {
+            if (offset == 0) {
+                posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            }
+            n = pread(fd, chunk.data(), IO_CHUNK, offset);
+        } else {
+            n = pwrite(fd, chunk.data(), IO_CHUNK, offset);
+            // Flush every megabyte so the device sees a steady rate
+            if ((offset + IO_CHUNK) % (1024 * 1024) == 0) {
+                fdatasync(fd);
+            }
+        }
+        if (n <= 0) {
+            return;
+        }
+        *counter += static_cast<uint64_t>(n);
+    }
+}
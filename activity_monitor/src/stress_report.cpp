@@ -0,0 +1,154 @@
+#include "../include/monitor.h"
+#include <iostream>
+#include <algorithm>
+#include <thread>
+#include <cstdio>
+
+static const double MB = 1024.0 * 1024.0;
+
+// Compare each load's ground truth with what the collectors saw this interval
+void ActivityMonitor::updateStressReadings() {
+    TraceSpan span("collect", "updateStressReadings");
+    if (!stress.active()) {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    double dt = std::chrono::duration<double>(now - stress_last_sample).count();
+    stress_last_sample = now;
+
+    // PIDs that appeared since the last refresh (short-lived forks are mostly missed)
+    std::vector<int> pids;
+    pids.reserve(live_processes.size());
+    for (const auto& proc : live_processes) {
+        pids.push_back(proc.pid);
+    }
+    std::sort(pids.begin(), pids.end());
+    size_t new_pids = 0;
+    for (int pid : pids) {
+        if (!std::binary_search(stress_prev_pids.begin(), stress_prev_pids.end(), pid)) {
+            new_pids++;
+        }
+    }
+    bool have_previous = !stress_prev_pids.empty();
+    stress_prev_pids.swap(pids);
+
+    const std::vector<StressLoad>& loads = stress.loads();
+    stress_readings.resize(loads.size());
+    for (size_t i = 0; i < loads.size(); i++) {
+        const StressLoad& load = loads[i];
+        StressReading& reading = stress_readings[i];
+        uint64_t progress = stress.progress(i);
+
+        const Process* worker = nullptr;
+        for (const auto& proc : live_processes) {
+            if (proc.pid == load.pid) {
+                worker = &proc;
+                break;
+            }
+        }
+        unsigned long long io = 0;
+        if (worker != nullptr) {
+            io = load.type == STRESS_READ ? worker->io_read_bytes : worker->io_write_bytes;
+        }
+
+        if (!reading.primed || dt <= 0) {
+            reading.last_progress = progress;
+            reading.last_io = io;
+            reading.primed = true;
+            continue;
+        }
+
+        double delta = static_cast<double>(progress - reading.last_progress);
+        switch (load.type) {
+            case STRESS_CPU:
+                reading.injected = 100.0 * delta / 1e9 / dt;
+                reading.measured = load.core < static_cast<int>(cpu_info.core_usage.size())
+                                       ? cpu_info.core_usage[load.core] : 0.0;
+                reading.measured_process = worker != nullptr ? worker->cpu_percent : 0.0;
+                break;
+            case STRESS_MEMORY:
+                reading.injected = progress / MB;
+                reading.measured = worker != nullptr ? worker->rss_kb / 1024.0 : 0.0;
+                break;
+            case STRESS_FORK:
+                reading.injected = delta / dt;
+                reading.measured = have_previous ? new_pids / dt : 0.0;
+                break;
+            case STRESS_WRITE:
+            case STRESS_READ:
+                reading.injected = delta / MB / dt;
+                reading.measured = io >= reading.last_io ? (io - reading.last_io) / MB / dt : 0.0;
+                break;
+        }
+        reading.last_progress = progress;
+        reading.last_io = io;
+
+        reading.sum_injected += reading.injected;
+        reading.sum_measured += reading.measured;
+        reading.sum_process += reading.measured_process;
+        reading.samples++;
+    }
+
+    // Past --stress-duration the workers stop; the monitor keeps running
+    stress.checkDuration();
+}
+
+// "cpu 50% on core 1      injected   50.0 %    monitor   49.8 % ..."
+std::string ActivityMonitor::stressReadingLine(size_t i, bool average) const {
+    const StressLoad& load = stress.loads()[i];
+    const StressReading& reading = stress_readings[i];
+    double samples = std::max(1, reading.samples);
+    double injected = average ? reading.sum_injected / samples : reading.injected;
+    double measured = average ? reading.sum_measured / samples : reading.measured;
+    double process = average ? reading.sum_process / samples : reading.measured_process;
+
+    static const char* UNITS[] = {"%", "MB", "/s", "MB/s", "MB/s"};
+    static const char* SOURCES[] = {"core usage", "worker RSS", "new PIDs seen", "worker I/O", "worker I/O"};
+    char line[160];
+    int len = snprintf(line, sizeof(line), "%-26s injected %8.1f %-4s  monitor %8.1f %-4s (%s)",
+                       StressGenerator::describe(load).c_str(), injected, UNITS[load.type], measured,
+                       UNITS[load.type], SOURCES[load.type]);
+    if (load.type == STRESS_CPU && len > 0 && len < static_cast<int>(sizeof(line))) {
+        snprintf(line + len, sizeof(line) - len, ", process CPU%% %.1f", process);
+    }
+    return line;
+}
+
+// Averages over the whole run, for printing after the monitor exits
+std::string ActivityMonitor::stressSummary() const {
+    if (stress.loads().empty()) {
+        return "";
+    }
+
+    std::string summary = "Stress run of " + std::to_string(static_cast<int>(stress.elapsedSeconds())) +
+                          " s, averages per refresh:\n";
+    for (size_t i = 0; i < stress.loads().size() && i < stress_readings.size(); i++) {
+        summary += "  " + stressReadingLine(i, true) + "\n";
+    }
+    return summary;
+}
+
+// Headless --stress-report: print both sides every refresh until the duration ends
+void ActivityMonitor::runStressReport() {
+    collectData();
+
+    while (running && stress.active()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(config.refresh_rate_ms));
+        collectData();
+
+        char header[96];
+        snprintf(header, sizeof(header), "[%6.1f s] CPU %.1f%%, memory %.1f%%%s",
+                 stress.elapsedSeconds(), cpu_info.total_usage, memory_info.percent_used,
+                 warning_state ? ", CPU alert" : (pre_warning_state ? ", CPU pre-warning" : ""));
+        std::cout << header << "\n";
+        for (size_t i = 0; i < stress_readings.size(); i++) {
+            if (stress_readings[i].samples > 0) {
+                std::cout << "  " << stressReadingLine(i, false) << "\n";
+            }
+        }
+        std::cout << std::flush;
+    }
+
+    std::cout << stressSummary() << std::flush;
+}
@@ -4,39 +4,14 @@
 #include <iomanip>
 #include <chrono>
 
-// Send a system notification using notify-send (part of libnotify-bin)
+// Send a system notification through the desktop notifier
 void ActivityMonitor::sendSystemNotification(const std::string& title, const std::string& message, bool critical) {
-    // Use notify-send command which is available on most Ubuntu systems
-    std::string urgency = critical ? "critical" : "normal";
-    std::string icon = critical ? "dialog-warning" : "dialog-information";
-    
-    // Escape special characters in title and message for shell command
-    auto escapeShell = [](const std::string& s) {
-        std::string result = s;
-        size_t pos = 0;
-        while ((pos = result.find("\"", pos)) != std::string::npos) {
-            result.replace(pos, 1, "\\\"");
-            pos += 2;
-        }
-        return result;
-    };
-    
-    std::string escaped_title = escapeShell(title);
-    std::string escaped_message = escapeShell(message);
-    
-    // Build the command
-    std::string cmd = "notify-send -u " + urgency + " -i " + icon + 
-                      " \"" + escaped_title + "\" \"" + escaped_message + "\"";
-    
-    // Execute the command
-    int ret = system(cmd.c_str());
-    
-    // Ignore return value as we don't want to break the application if notification fails
-    (void)ret;
+    sendDesktopNotification(title, message, critical);
 }
 
 // Check CPU usage and send system notifications if necessary
 void ActivityMonitor::checkAndSendNotifications() {
+    TraceSpan span("alerts", "checkAndSendNotifications");
     if (!config.system_notifications) {
         return;  // System notifications are disabled
     }
@@ -46,11 +21,8 @@ void ActivityMonitor::checkAndSendNotifications() {
     bool should_warn = cpu_info.total_usage > config.cpu_threshold;
     bool should_pre_warn = !should_warn && cpu_info.total_usage > pre_warning_threshold;
     
-    // Get highest CPU process if available
-    Process* top_process = nullptr;
-    if (!processes.empty()) {
-        top_process = &processes[0];
-    }
+    // The process 'k' would offer to kill, if anything is scored yet
+    const Process* top_process = highestPressureProcess();
     
     // Get current time for notification throttling
     auto now = std::chrono::high_resolution_clock::now();
@@ -68,7 +40,7 @@ void ActivityMonitor::checkAndSendNotifications() {
             
             std::ostringstream msg_oss;
             if (top_process != nullptr) {
-                msg_oss << "Highest CPU process: " << top_process->pid << " (" 
+                msg_oss << "Top pressure process: " << top_process->pid << " (" 
                         << top_process->name << ") using " << std::fixed 
                         << std::setprecision(1) << top_process->cpu_percent << "% CPU\n\n"
                         << "Press 'k' in the activity monitor to terminate this process.";
@@ -89,7 +61,7 @@ void ActivityMonitor::checkAndSendNotifications() {
             msg_oss << "CPU utilization is approaching threshold!\n";
             
             if (top_process != nullptr) {
-                msg_oss << "Highest CPU process: " << top_process->pid << " (" 
+                msg_oss << "Top pressure process: " << top_process->pid << " (" 
                         << top_process->name << ") using " << std::fixed 
                         << std::setprecision(1) << top_process->cpu_percent << "% CPU";
             }
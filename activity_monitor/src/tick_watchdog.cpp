@@ -0,0 +1,89 @@
+#include "../include/tick_watchdog.h"
+#include <algorithm>
+#include <cstdio>
+
+TickPlan TickWatchdog::plan() {
+    unsigned long long tick = totals.ticks;
+    int scan_every = degradation >= 3 ? 4 : (degradation >= 2 ? 2 : 1);
+
+    current = TickPlan();
+    current.process_detail = degradation < 1;
+    current.scan_processes = tick % scan_every == 0;
+    current.record_history = degradation < 4 || tick % 2 == 0;
+    return current;
+}
+
+bool TickWatchdog::record(double ms) {
+    totals.ticks++;
+    totals.last_ms = ms;
+    totals.worst_ms = std::max(totals.worst_ms, ms);
+    totals.average_ms = totals.ticks == 1 ? ms : totals.average_ms + 0.1 * (ms - totals.average_ms);
+    if (degradation > 0) {
+        totals.degraded_ticks++;
+    }
+
+    int before = degradation;
+    if (ms > budget_ms) {
+        totals.overruns++;
+        consecutive_overruns++;
+        calm = 0;
+        if (degradation < MAX_LEVEL && (consecutive_overruns >= 2 || ms > 2.0 * budget_ms)) {
+            // A restore that did not hold: wait longer before the next one
+            if (restored_at != 0 && totals.ticks - restored_at <= static_cast<unsigned long long>(calm_needed)) {
+                calm_needed = std::min(calm_needed * 2, MAX_CALM);
+            }
+            changeLevel(degradation + 1);
+            totals.degradations++;
+            totals.worst_level = std::max(totals.worst_level, degradation);
+        }
+    } else {
+        consecutive_overruns = 0;
+
+        // Refreshes that skipped the process scan say nothing about its cost
+        if (ms >= budget_ms / 2.0) {
+            calm = 0;
+        } else if (current.scan_processes) {
+            calm++;
+        }
+
+        if (calm >= calm_needed) {
+            if (degradation > 0) {
+                changeLevel(degradation - 1);
+                restored_at = totals.ticks;
+            } else if (calm_needed > MIN_CALM) {
+                // A clean run at full fidelity earns back the patience
+                calm_needed /= 2;
+            }
+            calm = 0;
+        }
+    }
+    return degradation != before;
+}
+
+void TickWatchdog::changeLevel(int level) {
+    degradation = level;
+    consecutive_overruns = 0;
+    calm = 0;
+}
+
+const char* TickWatchdog::levelName(int level) {
+    switch (level) {
+        case 0: return "full fidelity";
+        case 1: return "no per-process I/O, run queue, perf or delays";
+        case 2: return "processes every 2nd refresh";
+        case 3: return "processes every 4th refresh";
+        default: return "history every 2nd refresh";
+    }
+}
+
+std::string TickWatchdog::summary() const {
+    char text[96];
+    if (totals.worst_ms < 1000.0) {
+        snprintf(text, sizeof(text), "%llu overruns in %llu refreshes, worst %.0f ms",
+                 totals.overruns, totals.ticks, totals.worst_ms);
+    } else {
+        snprintf(text, sizeof(text), "%llu overruns in %llu refreshes, worst %.2f s",
+                 totals.overruns, totals.ticks, totals.worst_ms / 1000.0);
+    }
+    return text;
+}
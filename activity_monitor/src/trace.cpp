@@ -0,0 +1,255 @@
+#include "../include/trace.h"
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+// Events per thread ring; a full ring drops new events until the next flush
+static const size_t RING_SIZE = 8192;
+
+// Room kept for the closing bracket when the size limit is reached
+static const size_t CLOSING_RESERVE = 16;
+
+struct TraceEvent {
+    const char* category;
+    const char* name;
+    int64_t ts_ns;
+    int64_t dur_ns;
+    double value;
+    char phase;      // 'X' span, 'C' counter, 'i' instant
+};
+
+// Written by its thread, read by the flusher
+struct ThreadBuffer {
+    TraceEvent events[RING_SIZE];
+    std::atomic<uint64_t> head{0};            // Next slot the owner writes
+    std::atomic<uint64_t> tail{0};            // Next slot the flusher reads
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<const char*> thread_name{nullptr};
+    std::atomic<bool> exited{false};          // Owner gone; reusable once drained
+    int tid = 0;
+    bool name_written = false;                // Flusher only
+};
+
+// Everything below is shared by all threads; 'lock' guards the buffer list
+// and the file, never the recording path
+static std::mutex lock;
+static std::condition_variable wake;
+static std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+static FILE* out = nullptr;
+static size_t bytes_written = 0;
+static size_t byte_limit = 0;
+static int64_t origin_ns = 0;
+static int trace_pid = 0;
+static uint64_t dropped_reported = 0;
+static bool flusher_stop = false;
+static std::thread flusher;
+
+std::atomic<bool> Tracer::recording{false};
+
+// Marks the thread's buffer reusable when the thread exits
+struct ThreadSlot {
+    ThreadBuffer* buffer = nullptr;
+    ~ThreadSlot() {
+        if (buffer != nullptr) {
+            buffer->exited = true;
+        }
+    }
+};
+static thread_local ThreadSlot slot;
+
+static ThreadBuffer* threadBuffer() {
+    if (slot.buffer != nullptr) {
+        return slot.buffer;
+    }
+
+    // First event of this thread: take a drained buffer of an exited thread, or a new one
+    std::lock_guard<std::mutex> guard(lock);
+    ThreadBuffer* buffer = nullptr;
+    for (auto& candidate : buffers) {
+        if (candidate->exited.load() && candidate->head.load() == candidate->tail.load()) {
+            buffer = candidate.get();
+            break;
+        }
+    }
+    if (buffer == nullptr) {
+        buffers.emplace_back(new ThreadBuffer());
+        buffer = buffers.back().get();
+    }
+    buffer->tid = static_cast<int>(syscall(SYS_gettid));
+    buffer->thread_name = nullptr;
+    buffer->name_written = false;
+    buffer->exited = false;
+    slot.buffer = buffer;
+    return buffer;
+}
+
+static void record(const TraceEvent& event) {
+    ThreadBuffer* buffer = threadBuffer();
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    if (head - buffer->tail.load(std::memory_order_acquire) >= RING_SIZE) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[head % RING_SIZE] = event;
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+// Append one JSON line; false (and recording off) once the limit is reached
+static bool emit(const char* text, int len) {
+    if (len <= 0) {
+        return true;
+    }
+    if (bytes_written + len + 2 + CLOSING_RESERVE > byte_limit) {
+        Tracer::recording = false;
+        return false;
+    }
+    fputs(bytes_written > 2 ? ",\n" : "\n", out);
+    fwrite(text, 1, static_cast<size_t>(len), out);
+    bytes_written += static_cast<size_t>(len) + 2;
+    return true;
+}
+
+static double micros(int64_t ns) {
+    return (ns - origin_ns) / 1000.0;
+}
+
+// Write out everything recorded so far; called with the lock held
+static void drain() {
+    char text[512];
+    uint64_t dropped = 0;
+
+    for (auto& buffer : buffers) {
+        dropped += buffer->dropped.load();
+        const char* thread_name = buffer->thread_name.load();
+        if (thread_name != nullptr && !buffer->name_written) {
+            buffer->name_written = true;
+            emit(text, snprintf(text, sizeof(text),
+                                "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                                trace_pid, buffer->tid, thread_name));
+        }
+
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        for (uint64_t i = buffer->tail.load(); i < head; i++) {
+            const TraceEvent& event = buffer->events[i % RING_SIZE];
+            int len = 0;
+            switch (event.phase) {
+                case 'X':
+                    len = snprintf(text, sizeof(text),
+                                   "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d}",
+                                   event.name, event.category, micros(event.ts_ns), event.dur_ns / 1000.0,
+                                   trace_pid, buffer->tid);
+                    break;
+                case 'C':
+                    len = snprintf(text, sizeof(text),
+                                   "{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{\"value\":%.6g}}",
+                                   event.name, micros(event.ts_ns), trace_pid, buffer->tid, event.value);
+                    break;
+                default:
+                    len = snprintf(text, sizeof(text),
+                                   "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d}",
+                                   event.name, event.category, micros(event.ts_ns), trace_pid, buffer->tid);
+                    break;
+            }
+            if (Tracer::enabled()) {
+                emit(text, len);
+            }
+        }
+        buffer->tail.store(head, std::memory_order_release);
+    }
+
+    // Lost events show up as a counter track
+    if (dropped != dropped_reported && Tracer::enabled()) {
+        dropped_reported = dropped;
+        emit(text, snprintf(text, sizeof(text),
+                            "{\"name\":\"trace dropped events\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%d,\"args\":{\"value\":%llu}}",
+                            micros(Tracer::now()), trace_pid, static_cast<unsigned long long>(dropped)));
+    }
+    fflush(out);
+}
+
+static void flusherLoop() {
+    Tracer::nameThread("trace flusher");
+    std::unique_lock<std::mutex> guard(lock);
+    while (!flusher_stop) {
+        wake.wait_for(guard, std::chrono::milliseconds(500), [] { return flusher_stop; });
+        drain();
+    }
+}
+
+int64_t Tracer::now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+bool Tracer::start(const std::string& path, size_t max_bytes) {
+    out = fopen(path.c_str(), "w");
+    if (out == nullptr) {
+        return false;
+    }
+    fputs("[", out);
+    bytes_written = 1;
+    byte_limit = max_bytes;
+    origin_ns = now();
+    trace_pid = getpid();
+
+    recording = true;
+    nameThread("main");
+    flusher_stop = false;
+    flusher = std::thread(flusherLoop);
+    return true;
+}
+
+void Tracer::stop() {
+    if (out == nullptr) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        flusher_stop = true;
+    }
+    wake.notify_all();
+    flusher.join();
+
+    std::lock_guard<std::mutex> guard(lock);
+    drain();
+    recording = false;
+    fputs("\n]\n", out);
+    fclose(out);
+    out = nullptr;
+}
+
+void Tracer::complete(const char* category, const char* name, int64_t start_ns, int64_t end_ns) {
+    TraceEvent event = {category, name, start_ns, end_ns - start_ns, 0.0, 'X'};
+    record(event);
+}
+
+void Tracer::counter(const char* name, double value) {
+    if (!enabled()) {
+        return;
+    }
+    TraceEvent event = {"", name, now(), 0, value, 'C'};
+    record(event);
+}
+
+void Tracer::instant(const char* category, const char* name) {
+    if (!enabled()) {
+        return;
+    }
+    TraceEvent event = {category, name, now(), 0, 0.0, 'i'};
+    record(event);
+}
+
+void Tracer::nameThread(const char* name) {
+    if (!enabled()) {
+        return;
+    }
+    threadBuffer()->thread_name = name;
+}
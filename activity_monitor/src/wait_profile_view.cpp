@@ -0,0 +1,97 @@
+#include "../include/monitor.h"
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+// Start profiling the selected process, or close the profile view
+void ActivityMonitor::toggleWaitProfile() {
+    if (process_view == VIEW_WAIT_PROFILE) {
+        setProcessView(VIEW_PROCESSES);
+        return;
+    }
+
+    int index = selectedIndex();
+    if (index < 0) {
+        return;
+    }
+
+    const Process& proc = processes[index];
+    selected_pid = proc.pid;
+    if (!wait_profiler.start(proc.pid, proc.name, config.profile_hz, config.profile_budget)) {
+        debugLog("Wait profiler: cannot read tasks of PID " + std::to_string(proc.pid));
+        return;
+    }
+
+    setProcessView(VIEW_WAIT_PROFILE);
+}
+
+// Draw the blocking-point histogram in place of the process list
+void ActivityMonitor::displayWaitProfile() {
+    screen->clear(process_win);
+    screen->box(process_win);
+
+    int height = process_win.height;
+    int width = process_win.width;
+
+    WaitProfiler::Stats stats = wait_profiler.stats();
+    std::vector<BlockingPoint> points = wait_profiler.histogram();
+
+    std::ostringstream oss;
+    oss << " Wait profile: " << wait_profiler.pid() << " " << wait_profiler.name().substr(0, 20)
+        << " @ " << config.profile_hz << " Hz, " << stats.samples << " samples, "
+        << std::fixed << std::setprecision(1) << stats.overhead_percent << "% CPU ('w' close) ";
+    screen->attrOn(process_win, COLOR_PAIR(5));
+    screen->print(process_win, 0, 2, "%s", oss.str().substr(0, std::max(0, width - 4)).c_str());
+    screen->attrOff(process_win, COLOR_PAIR(5));
+
+    // Sampling coverage and anything lost
+    oss.str("");
+    oss << stats.threads << " threads, " << stats.threads_per_round << " read per round";
+    if (stats.overflow > 0) {
+        oss << ", " << stats.overflow << " samples overflowed";
+    }
+    if (stats.process_gone) {
+        oss << " - process exited";
+    }
+    screen->attrOn(process_win, stats.process_gone ? COLOR_PAIR(3) : 0);
+    screen->print(process_win, 1, 2, "%s", oss.str().substr(0, std::max(0, width - 4)).c_str());
+    screen->attrOff(process_win, stats.process_gone ? COLOR_PAIR(3) : 0);
+
+    screen->attrOn(process_win, A_BOLD);
+    screen->print(process_win, 2, 2, "%7s %6s %-2s %-16s %-28s %s",
+                  "Count", "%", "St", "Syscall", "Kernel function", "Target");
+    screen->attrOff(process_win, A_BOLD);
+
+    int rows = height - 4;
+    view_offset = std::max(0, std::min(view_offset, static_cast<int>(points.size()) - rows));
+
+    for (int row = 0; row < rows && view_offset + row < static_cast<int>(points.size()); row++) {
+        const BlockingPoint& point = points[view_offset + row];
+        double percent = stats.thread_samples > 0 ? 100.0 * point.count / stats.thread_samples : 0.0;
+
+        // -1: not in a syscall, -2: could not read it
+        std::string syscall;
+        if (point.syscall_nr == -1) {
+            syscall = point.state == 'R' ? "(running)" : "(user)";
+        } else if (point.syscall_nr == -2) {
+            syscall = "?";
+        } else {
+            syscall = WaitProfiler::syscallName(point.syscall_nr);
+            if (syscall.empty()) {
+                syscall = "#" + std::to_string(point.syscall_nr);
+            }
+        }
+
+        // Uninterruptible sleep is what usually hurts
+        int color = point.state == 'D' ? 3 : (point.state == 'R' ? 1 : 0);
+        char line[256];
+        snprintf(line, sizeof(line), "%7lu %5.1f%% %-2c %-16.16s %-28.28s %s",
+                 point.count, percent, point.state, syscall.c_str(), point.wchan, point.target);
+
+        screen->attrOn(process_win, COLOR_PAIR(color));
+        screen->print(process_win, row + 3, 2, "%s", std::string(line).substr(0, std::max(0, width - 4)).c_str());
+        screen->attrOff(process_win, COLOR_PAIR(color));
+    }
+
+    screen->refresh(process_win);
+}
@@ -0,0 +1,327 @@
+#include "../include/wait_profiler.h"
+#include "../include/trace.h"
+#include "../include/thread_cpu.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+// Rescan the thread list every this many sampling rounds
+static const int TASK_RESCAN_ROUNDS = 50;
+
+// Syscalls worth naming, and whether their first argument is a file descriptor
+struct SyscallInfo {
+    long nr;
+    const char* name;
+    bool fd_arg;
+};
+
+static const SyscallInfo SYSCALLS[] = {
+    {SYS_read, "read", true},
+    {SYS_write, "write", true},
+    {SYS_pread64, "pread64", true},
+    {SYS_pwrite64, "pwrite64", true},
+    {SYS_readv, "readv", true},
+    {SYS_writev, "writev", true},
+    {SYS_fsync, "fsync", true},
+    {SYS_fdatasync, "fdatasync", true},
+    {SYS_ioctl, "ioctl", true},
+    {SYS_fcntl, "fcntl", true},
+    {SYS_flock, "flock", true},
+    {SYS_getdents64, "getdents64", true},
+    {SYS_recvfrom, "recvfrom", true},
+    {SYS_sendto, "sendto", true},
+    {SYS_recvmsg, "recvmsg", true},
+    {SYS_sendmsg, "sendmsg", true},
+    {SYS_accept, "accept", true},
+    {SYS_accept4, "accept4", true},
+    {SYS_connect, "connect", true},
+    {SYS_sendfile, "sendfile", false},
+    {SYS_epoll_pwait, "epoll_pwait", true},
+    {SYS_ppoll, "ppoll", false},
+    {SYS_pselect6, "pselect6", false},
+    {SYS_futex, "futex", false},
+    {SYS_nanosleep, "nanosleep", false},
+    {SYS_clock_nanosleep, "clock_nanosleep", false},
+    {SYS_wait4, "wait4", false},
+    {SYS_waitid, "waitid", false},
+    {SYS_openat, "openat", false},
+    {SYS_msync, "msync", false},
+    {SYS_io_getevents, "io_getevents", false},
+#ifdef SYS_io_uring_enter
+    {SYS_io_uring_enter, "io_uring_enter", true},
+#endif
+#ifdef SYS_epoll_pwait2
+    {SYS_epoll_pwait2, "epoll_pwait2", true},
+#endif
+#ifdef SYS_epoll_wait
+    {SYS_epoll_wait, "epoll_wait", true},
+#endif
+#ifdef SYS_poll
+    {SYS_poll, "poll", false},
+#endif
+#ifdef SYS_select
+    {SYS_select, "select", false},
+#endif
+#ifdef SYS_pause
+    {SYS_pause, "pause", false},
+#endif
+#ifdef SYS_open
+    {SYS_open, "open", false},
+#endif
+};
+
+static const SyscallInfo* findSyscall(int nr) {
+    for (const auto& info : SYSCALLS) {
+        if (info.nr == nr) {
+            return &info;
+        }
+    }
+    return nullptr;
+}
+
+const char* WaitProfiler::syscallName(int nr) {
+    const SyscallInfo* info = findSyscall(nr);
+    return info ? info->name : "";
+}
+
+// Read a small /proc file into 'buf' without allocating; returns bytes read or -1
+static ssize_t readSmallFile(const char* path, char* buf, size_t size) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    ssize_t n = read(fd, buf, size - 1);
+    close(fd);
+    buf[n > 0 ? n : 0] = '\0';
+    return n;
+}
+
+WaitProfiler::~WaitProfiler() {
+    stop();
+}
+
+bool WaitProfiler::start(int pid, const std::string& name, int sample_hz, int budget) {
+    stop();
+
+    target_pid = pid;
+    target_name = name;
+    sample_hz = std::max(1, std::min(sample_hz, 1000));
+    interval_us = 1000000 / sample_hz;
+    per_round = static_cast<size_t>(std::max(1, budget / sample_hz));
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        memset(points, 0, sizeof(points));
+        current = Stats();
+        current.threads_per_round = per_round;
+    }
+    tid_count = 0;
+    next_tid = 0;
+
+    if (!scanTasks()) {
+        return false;
+    }
+
+    stop_requested = false;
+    running = true;
+    worker = std::thread(&WaitProfiler::workerLoop, this);
+    return true;
+}
+
+void WaitProfiler::stop() {
+    stop_requested = true;
+    if (worker.joinable()) {
+        worker.join();
+    }
+    running = false;
+}
+
+// Refresh the list of thread IDs; false if the process is gone
+bool WaitProfiler::scanTasks() {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/task", target_pid);
+    DIR* dir = opendir(path);
+    if (dir == nullptr) {
+        return false;
+    }
+
+    tid_count = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr && tid_count < MAX_THREADS) {
+        int tid = atoi(entry->d_name);
+        if (tid > 0) {
+            tids[tid_count++] = tid;
+        }
+    }
+    closedir(dir);
+
+    if (next_tid >= tid_count) {
+        next_tid = 0;
+    }
+    return tid_count > 0;
+}
+
+// Read one thread's state, wait channel and current syscall
+void WaitProfiler::sampleThread(int tid, BlockingPoint& sample) const {
+    char path[96];
+    char buf[512];
+
+    sample.state = '?';
+    sample.syscall_nr = -2;
+    sample.wchan[0] = '\0';
+    sample.target[0] = '\0';
+    sample.count = 1;
+
+    // State is the first field after the parenthesised name
+    snprintf(path, sizeof(path), "/proc/%d/task/%d/stat", target_pid, tid);
+    if (readSmallFile(path, buf, sizeof(buf)) > 0) {
+        const char* paren = strrchr(buf, ')');
+        if (paren != nullptr && paren[1] == ' ' && paren[2] != '\0') {
+            sample.state = paren[2];
+        }
+    }
+
+    snprintf(path, sizeof(path), "/proc/%d/task/%d/wchan", target_pid, tid);
+    if (readSmallFile(path, sample.wchan, sizeof(sample.wchan)) <= 0 || strcmp(sample.wchan, "0") == 0) {
+        sample.wchan[0] = '\0';
+    }
+
+    // "nr arg1 ... sp pc", "-1 sp pc" outside a syscall, or "running"
+    snprintf(path, sizeof(path), "/proc/%d/task/%d/syscall", target_pid, tid);
+    if (readSmallFile(path, buf, sizeof(buf)) <= 0) {
+        return;
+    }
+    if (strncmp(buf, "running", 7) == 0) {
+        sample.syscall_nr = -1;
+        return;
+    }
+
+    char* cursor = buf;
+    sample.syscall_nr = static_cast<int>(strtol(cursor, &cursor, 10));
+
+    const SyscallInfo* info = findSyscall(sample.syscall_nr);
+    if (info == nullptr || !info->fd_arg) {
+        return;
+    }
+
+    // Resolve the fd argument to what it points at
+    long fd = strtol(cursor, nullptr, 16);
+    snprintf(path, sizeof(path), "/proc/%d/fd/%ld", target_pid, fd);
+    ssize_t len = readlink(path, sample.target, sizeof(sample.target) - 1);
+    if (len < 0) {
+        snprintf(sample.target, sizeof(sample.target), "fd %ld", fd);
+    } else {
+        sample.target[len] = '\0';
+    }
+}
+
+// Add a sample to its bucket (open addressing, linear probing)
+void WaitProfiler::record(const BlockingPoint& sample) {
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](const char* data, size_t len) {
+        for (size_t i = 0; i < len && data[i] != '\0'; i++) {
+            hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+        }
+    };
+    mix(&sample.state, 1);
+    mix(reinterpret_cast<const char*>(&sample.syscall_nr), sizeof(sample.syscall_nr));
+    mix(sample.wchan, sizeof(sample.wchan));
+    mix(sample.target, sizeof(sample.target));
+
+    for (size_t probe = 0; probe < MAX_POINTS; probe++) {
+        BlockingPoint& point = points[(hash + probe) & (MAX_POINTS - 1)];
+        if (point.count == 0) {
+            point = sample;
+            return;
+        }
+        if (point.state == sample.state && point.syscall_nr == sample.syscall_nr &&
+            strcmp(point.wchan, sample.wchan) == 0 && strcmp(point.target, sample.target) == 0) {
+            point.count++;
+            return;
+        }
+    }
+    current.overflow++;
+}
+
+void WaitProfiler::workerLoop() {
+    Tracer::nameThread("wait profiler");
+    auto wall_start = std::chrono::steady_clock::now();
+    auto next = wall_start;
+    double cpu_start = threadCpuSeconds();
+    unsigned long round = 0;
+    BlockingPoint samples[64];
+
+    while (!stop_requested) {
+        if (round > 0 && round % TASK_RESCAN_ROUNDS == 0 && !scanTasks()) {
+            std::lock_guard<std::mutex> guard(lock);
+            current.process_gone = true;
+            break;
+        }
+
+        // Read up to the per-round budget, continuing round-robin next time
+        TraceSpan span("wait_profiler", "round");
+        size_t to_read = std::min(per_round, tid_count);
+        size_t done = 0;
+        while (done < to_read) {
+            size_t batch = std::min(to_read - done, sizeof(samples) / sizeof(samples[0]));
+            for (size_t i = 0; i < batch; i++) {
+                sampleThread(tids[next_tid], samples[i]);
+                next_tid = (next_tid + 1) % tid_count;
+            }
+
+            std::lock_guard<std::mutex> guard(lock);
+            for (size_t i = 0; i < batch; i++) {
+                record(samples[i]);
+            }
+            done += batch;
+        }
+        round++;
+
+        auto now = std::chrono::steady_clock::now();
+        double wall = std::chrono::duration<double>(now - wall_start).count();
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            current.samples = round;
+            current.thread_samples += done;
+            current.threads = tid_count;
+            current.overhead_percent = wall > 0 ? 100.0 * (threadCpuSeconds() - cpu_start) / wall : 0.0;
+        }
+
+        // Keep a fixed cadence; if we fell behind, do not try to catch up
+        next += std::chrono::microseconds(interval_us);
+        if (next < now) {
+            next = now;
+        }
+        std::this_thread::sleep_until(next);
+    }
+
+    running = false;
+}
+
+std::vector<BlockingPoint> WaitProfiler::histogram() const {
+    std::vector<BlockingPoint> result;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        for (const auto& point : points) {
+            if (point.count > 0) {
+                result.push_back(point);
+            }
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const BlockingPoint& a, const BlockingPoint& b) {
+        return a.count > b.count;
+    });
+    return result;
+}
+
+WaitProfiler::Stats WaitProfiler::stats() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return current;
+}
@@ -0,0 +1,391 @@
+#include "../include/watch_list.h"
+#include "../include/trace.h"
+#include "../include/thread_cpu.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Limits are checked against the average of this many milliseconds of samples
+static const int LIMIT_WINDOW_MS = 1000;
+
+// An alert clears once the average drops below this share of the limit
+static const float CLEAR_FRACTION = 0.9f;
+
+// Undelivered alerts kept when the UI does not collect them
+static const size_t MAX_PENDING_ALERTS = 64;
+
+static int64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+// Fields of /proc/[pid]/stat we need, parsed after the command name
+struct StatFields {
+    char state;
+    unsigned long long ticks;      // utime + stime
+    int threads;
+    unsigned long long start_time;
+};
+
+static bool parseStat(const char* buf, StatFields& fields) {
+    // The command name may contain spaces and parentheses; skip to the last ')'
+    const char* p = strrchr(buf, ')');
+    if (p == nullptr || p[1] == '\0') {
+        return false;
+    }
+    p += 2;
+    fields.state = *p;
+
+    // Field 3 is the state; utime and stime are 14 and 15, threads 20, start time 22
+    char* end = nullptr;
+    for (int field = 4; field <= 22; field++) {
+        p = strchr(p, ' ');
+        if (p == nullptr) {
+            return false;
+        }
+        p++;
+        if (field == 14) {
+            fields.ticks = strtoull(p, &end, 10);
+        } else if (field == 15) {
+            fields.ticks += strtoull(p, &end, 10);
+        } else if (field == 20) {
+            fields.threads = atoi(p);
+        } else if (field == 22) {
+            fields.start_time = strtoull(p, &end, 10);
+        }
+    }
+    return true;
+}
+
+// Re-read an open /proc file from the start
+static ssize_t rereadFd(int fd, char* buf, size_t size) {
+    ssize_t len = pread(fd, buf, size - 1, 0);
+    if (len <= 0) {
+        return -1;
+    }
+    buf[len] = '\0';
+    return len;
+}
+
+bool WatchSampler::parse(const std::string& spec, std::vector<WatchRule>& rules, std::string& error) {
+    std::stringstream items(spec);
+    std::string item;
+
+    while (std::getline(items, item, ',')) {
+        std::stringstream parts(item);
+        std::string part;
+        WatchRule rule;
+        bool first = true;
+
+        while (std::getline(parts, part, ':')) {
+            if (first) {
+                first = false;
+                if (part.empty()) {
+                    error = "empty process name in '" + item + "'";
+                    return false;
+                }
+                char* end = nullptr;
+                long pid = strtol(part.c_str(), &end, 10);
+                if (*end == '\0' && pid > 0) {
+                    rule.pid = static_cast<int>(pid);
+                } else {
+                    rule.name = part;
+                }
+                continue;
+            }
+
+            size_t equals = part.find('=');
+            std::string key = part.substr(0, equals);
+            std::string value = equals == std::string::npos ? "" : part.substr(equals + 1);
+            char* end = nullptr;
+            double limit = strtod(value.c_str(), &end);
+            if (value.empty() || *end != '\0' || !(limit > 0)) {
+                error = "'" + part + "' needs a positive number";
+                return false;
+            }
+            if (key == "cpu") {
+                rule.cpu_limit = static_cast<float>(limit);
+            } else if (key == "rss") {
+                rule.rss_limit_mb = static_cast<unsigned long>(limit);
+            } else {
+                error = "unknown limit '" + key + "' (use cpu=PCT or rss=MB)";
+                return false;
+            }
+        }
+        if (first) {
+            error = "empty entry in watch list";
+            return false;
+        }
+        rules.push_back(rule);
+    }
+
+    if (rules.empty()) {
+        error = "empty watch list";
+        return false;
+    }
+    return true;
+}
+
+WatchSampler::~WatchSampler() {
+    stop();
+    for (auto& slot : slots) {
+        closeSlot(*slot);
+    }
+}
+
+void WatchSampler::start(int interval_ms) {
+    if (running) {
+        return;
+    }
+    interval = interval_ms;
+    stop_requested = false;
+    running = true;
+    worker = std::thread(&WatchSampler::workerLoop, this);
+}
+
+void WatchSampler::stop() {
+    stop_requested = true;
+    if (worker.joinable()) {
+        worker.join();
+    }
+    running = false;
+}
+
+bool WatchSampler::openSlot(Slot& slot) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/stat", slot.target.pid);
+    slot.stat_fd = open(path, O_RDONLY | O_CLOEXEC);
+    snprintf(path, sizeof(path), "/proc/%d/statm", slot.target.pid);
+    slot.statm_fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (slot.stat_fd < 0 || slot.statm_fd < 0) {
+        closeSlot(slot);
+        return false;
+    }
+
+    char buf[1024];
+    StatFields fields;
+    if (rereadFd(slot.stat_fd, buf, sizeof(buf)) < 0 || !parseStat(buf, fields)) {
+        closeSlot(slot);
+        return false;
+    }
+    slot.start_time = fields.start_time;
+    slot.last_ticks = fields.ticks;
+    slot.last_ns = monotonicNs();
+    slot.state = fields.state;
+    slot.threads = fields.threads;
+    return true;
+}
+
+void WatchSampler::closeSlot(Slot& slot) {
+    if (slot.stat_fd >= 0) {
+        close(slot.stat_fd);
+        slot.stat_fd = -1;
+    }
+    if (slot.statm_fd >= 0) {
+        close(slot.statm_fd);
+        slot.statm_fd = -1;
+    }
+}
+
+void WatchSampler::setTargets(const std::vector<WatchTarget>& targets) {
+    std::lock_guard<std::mutex> guard(lock);
+
+    std::vector<std::unique_ptr<Slot>> kept;
+    for (const auto& target : targets) {
+        if (kept.size() >= MAX_WATCHED) {
+            break;
+        }
+
+        // Keep the history of a process we already sample; a dead one whose
+        // PID is listed again was reused and starts over
+        std::unique_ptr<Slot> slot;
+        for (auto& existing : slots) {
+            if (existing && existing->alive && existing->target.pid == target.pid) {
+                slot = std::move(existing);
+                break;
+            }
+        }
+        if (slot) {
+            slot->target = target;
+        } else {
+            slot.reset(new Slot());
+            slot->target = target;
+            if (!openSlot(*slot)) {
+                continue;
+            }
+        }
+        kept.push_back(std::move(slot));
+    }
+
+    for (auto& slot : slots) {
+        if (slot) {
+            closeSlot(*slot);
+        }
+    }
+    slots.swap(kept);
+}
+
+// One sample of one process; called with the lock held
+void WatchSampler::sample(Slot& slot, int64_t now_ns) {
+    if (!slot.alive) {
+        return;
+    }
+
+    // A process that exited leaves its stat fd reading ESRCH
+    char buf[1024];
+    StatFields fields;
+    if (rereadFd(slot.stat_fd, buf, sizeof(buf)) < 0 || !parseStat(buf, fields) ||
+        fields.start_time != slot.start_time) {
+        slot.alive = false;
+        slot.state = 'X';
+        closeSlot(slot);
+        return;
+    }
+
+    unsigned long rss_pages = 0;
+    if (rereadFd(slot.statm_fd, buf, sizeof(buf)) > 0) {
+        sscanf(buf, "%*s %lu", &rss_pages);
+    }
+
+    static const long ticks_per_second = sysconf(_SC_CLK_TCK);
+    static const long page_kb = sysconf(_SC_PAGESIZE) / 1024;
+    double seconds = (now_ns - slot.last_ns) / 1e9;
+
+    WatchSample& entry = slot.ring[slot.next];
+    entry.cpu_percent = seconds > 0
+        ? static_cast<float>(100.0 * (fields.ticks - slot.last_ticks) / ticks_per_second / seconds) : 0.0f;
+    entry.rss_kb = rss_pages * page_kb;
+    slot.next = (slot.next + 1) % HISTORY;
+    if (slot.count < HISTORY) {
+        slot.count++;
+    }
+
+    slot.last_ticks = fields.ticks;
+    slot.last_ns = now_ns;
+    slot.state = fields.state;
+    slot.threads = fields.threads;
+    checkLimits(slot);
+}
+
+// Raise or clear the process's alert on its last second; called with the lock held
+void WatchSampler::checkLimits(Slot& slot) {
+    const WatchTarget& target = slot.target;
+    if (target.cpu_limit <= 0 && target.rss_limit_mb == 0) {
+        return;
+    }
+
+    size_t window = std::max(1, LIMIT_WINDOW_MS / interval);
+    if (slot.count < window) {
+        return;
+    }
+    double cpu = 0;
+    unsigned long rss_kb = 0;
+    for (size_t i = 0; i < window; i++) {
+        const WatchSample& entry = slot.ring[(slot.next + HISTORY - 1 - i) % HISTORY];
+        cpu += entry.cpu_percent;
+        rss_kb = std::max(rss_kb, entry.rss_kb);
+    }
+    cpu /= window;
+    double rss_mb = rss_kb / 1024.0;
+
+    bool cpu_over = target.cpu_limit > 0 && cpu > target.cpu_limit;
+    bool rss_over = target.rss_limit_mb > 0 && rss_mb > target.rss_limit_mb;
+    bool cpu_clear = target.cpu_limit <= 0 || cpu < target.cpu_limit * CLEAR_FRACTION;
+    bool rss_clear = target.rss_limit_mb == 0 || rss_mb < target.rss_limit_mb * CLEAR_FRACTION;
+
+    char message[128];
+    if (!slot.alerting && (cpu_over || rss_over)) {
+        int len = 0;
+        if (cpu_over) {
+            len = snprintf(message, sizeof(message), "CPU %.1f%% over %.0f%% for 1 s", cpu, target.cpu_limit);
+        }
+        if (rss_over) {
+            snprintf(message + len, sizeof(message) - len, "%sRSS %.0f MB over %lu MB",
+                     cpu_over ? ", " : "", rss_mb, target.rss_limit_mb);
+        }
+        slot.alerting = true;
+    } else if (slot.alerting && cpu_clear && rss_clear) {
+        snprintf(message, sizeof(message), "back under limits (CPU %.1f%%, RSS %.0f MB)", cpu, rss_mb);
+        slot.alerting = false;
+    } else {
+        return;
+    }
+
+    if (alerts.size() >= MAX_PENDING_ALERTS) {
+        alerts.pop_front();
+    }
+    alerts.push_back(WatchAlert{target.pid, target.name, message, slot.alerting});
+}
+
+void WatchSampler::workerLoop() {
+    Tracer::nameThread("watch sampler");
+    double cpu_start = threadCpuSeconds();
+    int64_t started = monotonicNs();
+
+    // Absolute deadlines so the cadence does not drift by the sampling cost
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (!stop_requested) {
+        next.tv_nsec += static_cast<long>(interval) * 1000000L;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr);
+
+        {
+            TraceSpan span("watch", "sample");
+            int64_t now = monotonicNs();
+            std::lock_guard<std::mutex> guard(lock);
+            for (auto& slot : slots) {
+                sample(*slot, now);
+            }
+        }
+
+        double elapsed = (monotonicNs() - started) / 1e9;
+        if (elapsed > 0) {
+            overhead = 100.0 * (threadCpuSeconds() - cpu_start) / elapsed;
+        }
+    }
+
+    running = false;
+}
+
+std::vector<WatchedProcess> WatchSampler::snapshot() const {
+    std::lock_guard<std::mutex> guard(lock);
+
+    std::vector<WatchedProcess> result;
+    result.reserve(slots.size());
+    for (const auto& slot : slots) {
+        WatchedProcess proc;
+        proc.target = slot->target;
+        proc.alive = slot->alive;
+        proc.state = slot->state;
+        proc.threads = slot->threads;
+        proc.alerting = slot->alerting;
+        proc.samples.reserve(slot->count);
+        for (size_t i = 0; i < slot->count; i++) {
+            proc.samples.push_back(slot->ring[(slot->next + HISTORY - slot->count + i) % HISTORY]);
+        }
+        result.push_back(proc);
+    }
+    return result;
+}
+
+std::vector<WatchAlert> WatchSampler::takeAlerts() {
+    std::lock_guard<std::mutex> guard(lock);
+    std::vector<WatchAlert> result(alerts.begin(), alerts.end());
+    alerts.clear();
+    return result;
+}
+
+double WatchSampler::overheadPercent() const {
+    return overhead.load();
+}
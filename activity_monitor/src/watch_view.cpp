@@ -0,0 +1,214 @@
+#include "../include/monitor.h"
+#include <algorithm>
+#include <cstdio>
+
+// Sparkline levels, lowest to highest
+static const char SPARK_LEVELS[] = " .:-=+*#%@";
+static const int SPARK_LEVEL_COUNT = sizeof(SPARK_LEVELS) - 1;
+
+// Rows per watched process: summary, CPU graph, RSS graph
+static const int WATCH_BLOCK_ROWS = 3;
+
+// Match the watch rules and pins against the live process list
+void ActivityMonitor::updateWatchTargets() {
+    TraceSpan span("collect", "updateWatchTargets");
+    std::vector<WatchTarget> targets;
+    auto add = [&targets](const Process& proc, float cpu_limit, unsigned long rss_limit_mb, bool pinned) {
+        for (const auto& target : targets) {
+            if (target.pid == proc.pid) {
+                return;
+            }
+        }
+        targets.push_back(WatchTarget{proc.pid, proc.name, cpu_limit, rss_limit_mb, pinned});
+    };
+
+    // Rules first, so their limits win over a pin of the same process
+    for (const auto& rule : config.watch_rules) {
+        for (const auto& proc : live_processes) {
+            if (proc.pid == rule.pid || (!rule.name.empty() && proc.name == rule.name)) {
+                add(proc, rule.cpu_limit, rule.rss_limit_mb, false);
+            }
+        }
+    }
+
+    // Pins of processes that exited are dropped
+    std::vector<int> alive_pins;
+    for (int pid : watch_pinned) {
+        for (const auto& proc : live_processes) {
+            if (proc.pid == pid) {
+                add(proc, 0.0f, 0, true);
+                alive_pins.push_back(pid);
+                break;
+            }
+        }
+    }
+    watch_pinned.swap(alive_pins);
+
+    if (targets.empty()) {
+        watch.stop();
+    }
+    watch.setTargets(targets);
+    if (!targets.empty() && !watch.active()) {
+        watch.start(config.watch_interval_ms);
+    }
+
+    watch_pids.clear();
+    for (const auto& target : targets) {
+        watch_pids.push_back(target.pid);
+    }
+    std::sort(watch_pids.begin(), watch_pids.end());
+}
+
+bool ActivityMonitor::isWatched(int pid) const {
+    return std::binary_search(watch_pids.begin(), watch_pids.end(), pid);
+}
+
+// Pin or unpin the selected process
+void ActivityMonitor::toggleWatchPin() {
+    int index = selectedIndex();
+    if (index < 0) {
+        return;
+    }
+
+    int pid = processes[index].pid;
+    auto pin = std::find(watch_pinned.begin(), watch_pinned.end(), pid);
+    if (pin != watch_pinned.end()) {
+        watch_pinned.erase(pin);
+    } else if (watch_pinned.size() < WatchSampler::MAX_WATCHED) {
+        watch_pinned.push_back(pid);
+    }
+
+    // While paused the list is a snapshot; the pin applies at the next live refresh
+    if (!paused) {
+        updateWatchTargets();
+    }
+}
+
+// Report limit crossings of watched processes as they happen
+void ActivityMonitor::pollWatchAlerts() {
+    if (!watch.active()) {
+        return;
+    }
+
+    for (const auto& alert : watch.takeAlerts()) {
+        std::string who = alert.name + " (" + std::to_string(alert.pid) + ")";
+        debugLog("Watch: " + who + " " + alert.message);
+        if (alert.raised) {
+            triggerFlightRecorder("Watched process " + who + ": " + alert.message, alert.pid);
+        }
+        if (config.system_notifications) {
+            sendSystemNotification("Watch: " + who, alert.message, alert.raised);
+        }
+    }
+}
+
+// Show or hide the watch list graphs
+void ActivityMonitor::toggleWatchView() {
+    setProcessView(process_view == VIEW_WATCH ? VIEW_PROCESSES : VIEW_WATCH);
+}
+
+// Squeeze samples into 'width' columns, taking the largest value of each column
+static std::string sparkline(const std::vector<double>& values, double low, double high, int width) {
+    std::string line;
+    if (values.empty() || width <= 0) {
+        return line;
+    }
+
+    size_t per_column = (values.size() + width - 1) / width;
+    for (size_t start = 0; start < values.size(); start += per_column) {
+        double value = *std::max_element(values.begin() + start,
+                                         values.begin() + std::min(values.size(), start + per_column));
+        int level = 0;
+        if (high > low) {
+            level = static_cast<int>((value - low) / (high - low) * (SPARK_LEVEL_COUNT - 1) + 0.5);
+        }
+        line += SPARK_LEVELS[std::max(0, std::min(SPARK_LEVEL_COUNT - 1, level))];
+    }
+    return line;
+}
+
+// Draw each watched process with its recent CPU and RSS history
+void ActivityMonitor::displayWatchList() {
+    screen->clear(process_win);
+    screen->box(process_win);
+
+    int height = process_win.height;
+    int width = process_win.width;
+    int text_width = std::max(0, width - 4);
+
+    std::vector<WatchedProcess> watched = watch.snapshot();
+
+    char title[160];
+    snprintf(title, sizeof(title), " Watch list: %d processes every %d ms, graphs of the last %.0f s, sampler CPU %.2f%% ('*' pin, 'g' close) ",
+             static_cast<int>(watched.size()), config.watch_interval_ms,
+             WatchSampler::HISTORY * config.watch_interval_ms / 1000.0, watch.overheadPercent());
+    screen->attrOn(process_win, COLOR_PAIR(5));
+    screen->print(process_win, 0, 2, "%s", std::string(title).substr(0, text_width).c_str());
+    screen->attrOff(process_win, COLOR_PAIR(5));
+
+    if (watched.empty()) {
+        screen->print(process_win, 1, 2, "%s",
+                      std::string("Nothing watched: press '*' on a process in the list, or start with --watch=NAME")
+                          .substr(0, text_width).c_str());
+        screen->refresh(process_win);
+        return;
+    }
+
+    int blocks = std::max(1, (height - 2) / WATCH_BLOCK_ROWS);
+    int total = static_cast<int>(watched.size());
+    view_offset = std::max(0, std::min(view_offset, total - blocks));
+
+    // Graphs span the whole history kept per process (HISTORY samples)
+    int graph_width = std::max(0, text_width - 22);
+
+    for (int block = 0; block < blocks && view_offset + block < total; block++) {
+        const WatchedProcess& proc = watched[view_offset + block];
+        int row = 1 + block * WATCH_BLOCK_ROWS;
+
+        std::vector<double> cpu;
+        std::vector<double> rss;
+        for (const auto& sample : proc.samples) {
+            cpu.push_back(sample.cpu_percent);
+            rss.push_back(sample.rss_kb);
+        }
+        double cpu_now = cpu.empty() ? 0.0 : cpu.back();
+        double cpu_peak = cpu.empty() ? 0.0 : *std::max_element(cpu.begin(), cpu.end());
+        unsigned long rss_now = proc.samples.empty() ? 0 : proc.samples.back().rss_kb;
+
+        char limits[64] = "";
+        if (proc.target.cpu_limit > 0 || proc.target.rss_limit_mb > 0) {
+            int len = snprintf(limits, sizeof(limits), "  limit");
+            if (proc.target.cpu_limit > 0) {
+                len += snprintf(limits + len, sizeof(limits) - len, " cpu>%.0f%%", proc.target.cpu_limit);
+            }
+            if (proc.target.rss_limit_mb > 0) {
+                snprintf(limits + len, sizeof(limits) - len, " rss>%luMB", proc.target.rss_limit_mb);
+            }
+        }
+
+        char summary[256];
+        snprintf(summary, sizeof(summary), "%s%-16.16s %-7d %c thr %-4d CPU %6.1f%% peak %6.1f%%  RSS %s%s%s",
+                 proc.target.pinned ? "*" : " ", proc.target.name.c_str(), proc.target.pid, proc.state,
+                 proc.threads, cpu_now, cpu_peak, formatSize(rss_now).c_str(), limits,
+                 !proc.alive ? "  (exited)" : (proc.alerting ? "  OVER LIMIT" : ""));
+
+        attr_t attrs = proc.alerting ? (COLOR_PAIR(3) | A_BOLD) : (proc.alive ? A_BOLD : COLOR_PAIR(2));
+        screen->attrOn(process_win, attrs);
+        screen->print(process_win, row, 2, "%s", std::string(summary).substr(0, text_width).c_str());
+        screen->attrOff(process_win, attrs);
+
+        if (row + 2 >= height - 1) {
+            break;
+        }
+
+        // CPU from zero to one core (or the peak above it), RSS over its own range
+        double rss_low = rss.empty() ? 0.0 : *std::min_element(rss.begin(), rss.end());
+        double rss_high = rss.empty() ? 0.0 : *std::max_element(rss.begin(), rss.end());
+        screen->print(process_win, row + 1, 2, "  CPU %5.0f%% max |%s",
+                      std::max(100.0, cpu_peak), sparkline(cpu, 0.0, std::max(100.0, cpu_peak), graph_width).c_str());
+        screen->print(process_win, row + 2, 2, "  RSS %9s |%s", formatSize(static_cast<unsigned long>(rss_high)).c_str(),
+                      sparkline(rss, rss_low, rss_high, graph_width).c_str());
+    }
+
+    screen->refresh(process_win);
+}
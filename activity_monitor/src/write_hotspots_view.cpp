@@ -0,0 +1,102 @@
+#include "../include/monitor.h"
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+// Rows given to the process table; the rest of the panel lists files
+static const int WRITER_ROWS = 6;
+
+// Start tracking writes on the configured filesystem, or close the view
+void ActivityMonitor::toggleWriteHotspots() {
+    if (process_view == VIEW_WRITE_HOTSPOTS) {
+        setProcessView(VIEW_PROCESSES);
+        return;
+    }
+
+    // On failure the view stays open to show why
+    setProcessView(VIEW_WRITE_HOTSPOTS);
+    if (!write_tracker.start(config.write_track_path)) {
+        debugLog("Write tracker: " + write_tracker.error());
+    }
+}
+
+// Draw the top writing processes and the most modified files
+void ActivityMonitor::displayWriteHotspots() {
+    screen->clear(process_win);
+    screen->box(process_win);
+
+    int height = process_win.height;
+    int width = process_win.width;
+    int text_width = std::max(0, width - 4);
+
+    std::string title = " Write hotspots: " + write_tracker.path() + " ('h' close) ";
+    screen->attrOn(process_win, COLOR_PAIR(5));
+    screen->print(process_win, 0, 2, "%s", title.substr(0, text_width).c_str());
+    screen->attrOff(process_win, COLOR_PAIR(5));
+
+    if (!write_tracker.active()) {
+        screen->attrOn(process_win, COLOR_PAIR(3));
+        screen->print(process_win, 1, 2, "%s", ("Unavailable: " + write_tracker.error()).substr(0, text_width).c_str());
+        screen->attrOff(process_win, COLOR_PAIR(3));
+        screen->refresh(process_win);
+        return;
+    }
+
+    WriteTracker::Stats stats = write_tracker.stats();
+    std::vector<WriteHotspot> writers;
+    std::vector<WriteHotspot> files;
+    write_tracker.results(writers, files);
+
+    std::ostringstream oss;
+    oss << stats.events << " events in " << std::fixed << std::setprecision(0) << stats.seconds << " s ("
+        << (stats.filesystem_mark ? "filesystem" : "mount only") << "), tracker CPU "
+        << std::setprecision(1) << (stats.seconds > 0 ? 100.0 * stats.cpu_seconds / stats.seconds : 0.0) << "%";
+    if (stats.overflows > 0) {
+        oss << ", queue overflowed " << stats.overflows << "x";
+    }
+    int color = stats.overflows > 0 ? 2 : 0;
+    screen->attrOn(process_win, COLOR_PAIR(color));
+    screen->print(process_win, 1, 2, "%s", oss.str().substr(0, text_width).c_str());
+    screen->attrOff(process_win, COLOR_PAIR(color));
+
+    // Writers: a short fixed table
+    screen->attrOn(process_win, A_BOLD);
+    screen->print(process_win, 2, 2, "%9s %7s %7s %-7s %s", "Events", "+-Err", "Closes", "PID", "Process");
+    screen->attrOff(process_win, A_BOLD);
+
+    int writer_rows = std::min(WRITER_ROWS, std::max(0, (height - 6) / 3));
+    for (int row = 0; row < writer_rows && row < static_cast<int>(writers.size()); row++) {
+        const WriteHotspot& writer = writers[row];
+        screen->print(process_win, row + 3, 2, "%9llu %7llu %7llu %-7d %s",
+                      static_cast<unsigned long long>(writer.events), static_cast<unsigned long long>(writer.error),
+                      static_cast<unsigned long long>(writer.close_writes), writer.pid,
+                      writer.name.substr(0, std::max(0, text_width - 42)).c_str());
+    }
+
+    // Files: the rest of the panel, scrollable
+    int file_header = writer_rows + 4;
+    screen->attrOn(process_win, A_BOLD);
+    screen->print(process_win, file_header, 2, "%9s %7s %7s %-7s %s", "Events", "+-Err", "Closes", "Writer", "File");
+    screen->attrOff(process_win, A_BOLD);
+
+    int rows = height - file_header - 2;
+    int total = static_cast<int>(files.size());
+    view_offset = std::max(0, std::min(view_offset, total - rows));
+
+    for (int row = 0; row < rows && view_offset + row < total; row++) {
+        const WriteHotspot& file = files[view_offset + row];
+
+        // Show the end of long paths, where the file name is
+        int path_width = std::max(0, text_width - 34);
+        std::string path = file.name;
+        if (static_cast<int>(path.length()) > path_width && path_width > 3) {
+            path = "..." + path.substr(path.length() - (path_width - 3));
+        }
+
+        screen->print(process_win, file_header + 1 + row, 2, "%9llu %7llu %7llu %-7d %s",
+                      static_cast<unsigned long long>(file.events), static_cast<unsigned long long>(file.error),
+                      static_cast<unsigned long long>(file.close_writes), file.pid, path.c_str());
+    }
+
+    screen->refresh(process_win);
+}
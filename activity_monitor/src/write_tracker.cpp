@@ -0,0 +1,235 @@
+#include "../include/write_tracker.h"
+#include "../include/trace.h"
+#include "../include/thread_cpu.h"
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/fanotify.h>
+
+// Counts halve this often so the tables show current writers
+static const int DECAY_SECONDS = 30;
+
+// Bytes read from the fanotify queue at once
+static const size_t EVENT_BUFFER_SIZE = 64 * 1024;
+
+WriteTracker::WriteTracker() : writers(TABLE_SIZE), files(TABLE_SIZE) {}
+
+WriteTracker::~WriteTracker() {
+    stop();
+}
+
+bool WriteTracker::start(const std::string& path) {
+    stop();
+    watch_path = path;
+    last_error.clear();
+
+    // A bounded kernel queue: if we fall behind, events are dropped and counted
+    fan_fd = fanotify_init(FAN_CLASS_NOTIF | FAN_CLOEXEC | FAN_NONBLOCK, O_RDONLY | O_CLOEXEC | O_LARGEFILE);
+    if (fan_fd < 0) {
+        if (errno == EPERM) {
+            last_error = "fanotify needs CAP_SYS_ADMIN (run as root)";
+        } else if (errno == ENOSYS) {
+            last_error = "kernel built without fanotify";
+        } else {
+            last_error = std::string("fanotify_init: ") + strerror(errno);
+        }
+        return false;
+    }
+
+    uint64_t mask = FAN_MODIFY | FAN_CLOSE_WRITE;
+    bool filesystem_mark = true;
+    int rc = -1;
+#ifdef FAN_MARK_FILESYSTEM
+    rc = fanotify_mark(fan_fd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, mask, AT_FDCWD, path.c_str());
+#else
+    errno = EINVAL;
+#endif
+    if (rc != 0 && errno == EINVAL) {
+        // Filesystem marks need Linux 4.20; watch the mount instead
+        filesystem_mark = false;
+        rc = fanotify_mark(fan_fd, FAN_MARK_ADD | FAN_MARK_MOUNT, mask, AT_FDCWD, path.c_str());
+    }
+    if (rc != 0) {
+        last_error = "fanotify_mark " + path + ": " + strerror(errno);
+        close(fan_fd);
+        fan_fd = -1;
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        writers.clear();
+        files.clear();
+        current = Stats();
+        current.filesystem_mark = filesystem_mark;
+    }
+
+    stop_requested = false;
+    running = true;
+    worker = std::thread(&WriteTracker::workerLoop, this);
+    return true;
+}
+
+void WriteTracker::stop() {
+    stop_requested = true;
+    if (worker.joinable()) {
+        worker.join();
+    }
+    if (fan_fd >= 0) {
+        close(fan_fd);
+        fan_fd = -1;
+    }
+    running = false;
+}
+
+// Read a process name into 'comm'; empty if the process is gone
+static void readComm(int pid, char* comm, size_t size) {
+    char comm_path[32];
+    snprintf(comm_path, sizeof(comm_path), "/proc/%d/comm", pid);
+    comm[0] = '\0';
+    int fd = open(comm_path, O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        ssize_t len = read(fd, comm, size - 1);
+        comm[len > 0 ? len : 0] = '\0';
+        char* newline = strchr(comm, '\n');
+        if (newline != nullptr) {
+            *newline = '\0';
+        }
+        close(fd);
+    }
+}
+
+// Add one event to both tables; called with the lock held. 'comm' names a
+// writer that enters the table.
+void WriteTracker::record(int pid, const char* comm, const char* path, bool close_write) {
+    bool inserted;
+    SpaceSaving<int, WriterInfo>::Counter& writer = writers.add(pid, inserted);
+    if (inserted) {
+        snprintf(writer.info.comm, sizeof(writer.info.comm), "%s", comm);
+    }
+    if (close_write) {
+        writer.info.close_writes++;
+    }
+
+    if (path != nullptr) {
+        SpaceSaving<std::string, FileInfo>::Counter& file = files.add(path, inserted);
+        file.info.pid = pid;
+        if (close_write) {
+            file.info.close_writes++;
+        }
+    }
+}
+
+void WriteTracker::workerLoop() {
+    Tracer::nameThread("write tracker");
+    static thread_local std::vector<char> buffer(EVENT_BUFFER_SIZE);
+    auto started = std::chrono::steady_clock::now();
+    auto last_decay = started;
+    double cpu_start = threadCpuSeconds();
+    int self = getpid();
+    char link[32];
+    char target[4096];
+
+    while (!stop_requested) {
+        struct pollfd pfd = {fan_fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, 250);
+
+        while (ready > 0 && !stop_requested) {
+            ssize_t n = read(fan_fd, buffer.data(), buffer.size());
+            if (n <= 0) {
+                break;
+            }
+            TraceSpan span("write_tracker", "batch");
+
+            const struct fanotify_event_metadata* event =
+                reinterpret_cast<const struct fanotify_event_metadata*>(buffer.data());
+            for (; FAN_EVENT_OK(event, n); event = FAN_EVENT_NEXT(event, n)) {
+                if (event->mask & FAN_Q_OVERFLOW) {
+                    std::lock_guard<std::mutex> guard(lock);
+                    current.overflows++;
+                    continue;
+                }
+                if (event->fd < 0) {
+                    continue;
+                }
+
+                const char* path = nullptr;
+                if (event->pid != self) {
+                    snprintf(link, sizeof(link), "/proc/self/fd/%d", event->fd);
+                    ssize_t len = readlink(link, target, sizeof(target) - 1);
+                    if (len > 0) {
+                        target[len] = '\0';
+                        path = target;
+                    }
+                }
+                close(event->fd);
+                if (event->pid == self) {
+                    continue;  // Our own debug log
+                }
+
+                // Name a new writer before taking the lock, so the UI thread never waits
+                // on /proc. Only this thread changes the tables, so the check holds.
+                char comm[16] = "";
+                if (!writers.contains(event->pid)) {
+                    readComm(event->pid, comm, sizeof(comm));
+                }
+
+                // The kernel merges queued MODIFY events, so one event may stand for many writes
+                std::lock_guard<std::mutex> guard(lock);
+                current.events++;
+                if (path == nullptr) {
+                    current.unresolved++;
+                }
+                record(event->pid, comm, path, (event->mask & FAN_CLOSE_WRITE) != 0);
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> guard(lock);
+        if (now - last_decay >= std::chrono::seconds(DECAY_SECONDS)) {
+            writers.decay();
+            files.decay();
+            last_decay = now;
+        }
+        current.cpu_seconds = threadCpuSeconds() - cpu_start;
+        current.seconds = std::chrono::duration<double>(now - started).count();
+    }
+
+    running = false;
+}
+
+void WriteTracker::results(std::vector<WriteHotspot>& writer_rows, std::vector<WriteHotspot>& file_rows) const {
+    std::lock_guard<std::mutex> guard(lock);
+
+    writer_rows.clear();
+    for (const auto& counter : writers.top()) {
+        WriteHotspot row;
+        row.name = counter.info.comm;
+        row.pid = counter.key;
+        row.events = counter.count;
+        row.error = counter.error;
+        row.close_writes = counter.info.close_writes;
+        writer_rows.push_back(row);
+    }
+
+    file_rows.clear();
+    for (const auto& counter : files.top()) {
+        WriteHotspot row;
+        row.name = counter.key;
+        row.pid = counter.info.pid;
+        row.events = counter.count;
+        row.error = counter.error;
+        row.close_writes = counter.info.close_writes;
+        file_rows.push_back(row);
+    }
+}
+
+WriteTracker::Stats WriteTracker::stats() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return current;
+}